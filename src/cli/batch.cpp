@@ -0,0 +1,230 @@
+#include "batch.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+static const char BATCH_MAGIC[8] = {'M', 'O', 'S', 'K', 'W', 'L', '0', '1'};
+
+struct BatchRecord {
+    uint8_t op;
+    uint8_t reserved[3];
+    int32_t args[4];
+};
+static_assert(sizeof(BatchRecord) == 20, "batch records must stay 20 bytes");
+
+// --- BatchReader ---
+
+static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static bool wordIs(const char* word, size_t length, const char* literal) {
+    return std::strlen(literal) == length && std::memcmp(word, literal, length) == 0;
+}
+
+// Reads the next whitespace-separated word of [p, end).
+static size_t nextWord(const char*& p, const char* end, const char*& word) {
+    while (p < end && isBlank(*p)) ++p;
+    word = p;
+    while (p < end && !isBlank(*p)) ++p;
+    return static_cast<size_t>(p - word);
+}
+
+// Parses up to `count` integers; stops at the first word that is not one, like
+// extracting from an istringstream.
+static void parseInts(const char*& p, const char* end, int32_t* out, int count) {
+    for (int i = 0; i < count; ++i) {
+        while (p < end && isBlank(*p)) ++p;
+        const char* q = p;
+        bool negative = (q < end && (*q == '-' || *q == '+')) ? (*q++ == '-') : false;
+        if (q == end || *q < '0' || *q > '9') return;
+        long long value = 0;
+        while (q < end && *q >= '0' && *q <= '9') value = value * 10 + (*q++ - '0');
+        out[i] = static_cast<int32_t>(negative ? -value : value);
+        p = q;
+    }
+}
+
+BatchReader::BatchReader(const char* data, size_t size)
+    : pos(data), end(data + size), binary(false), line_number(0) {
+    if (size >= sizeof(BATCH_MAGIC) && std::memcmp(data, BATCH_MAGIC, sizeof(BATCH_MAGIC)) == 0) {
+        binary = true;
+        pos += sizeof(BATCH_MAGIC);
+    }
+}
+
+bool BatchReader::next(BatchCommand& command) {
+    return binary ? nextBinary(command) : nextText(command);
+}
+
+bool BatchReader::nextText(BatchCommand& command) {
+    while (pos < end) {
+        const char* newline = static_cast<const char*>(std::memchr(pos, '\n', static_cast<size_t>(end - pos)));
+        const char* line_end = newline != nullptr ? newline : end;
+        const char* p = pos;
+        pos = newline != nullptr ? newline + 1 : end;
+        line_number++;
+
+        while (p < line_end && isBlank(*p)) ++p;
+        const char* e = line_end;
+        while (e > p && isBlank(e[-1])) --e;
+        if (p == e || *p == '#') continue;
+
+        command = BatchCommand();
+        command.text = p;
+        command.length = static_cast<size_t>(e - p);
+        const char* word;
+        size_t length = nextWord(p, e, word);
+        if (wordIs(word, length, "create")) {
+            command.op = BatchOp::CREATE;
+            parseInts(p, e, command.args, 4);
+        } else if (wordIs(word, length, "access")) {
+            command.op = BatchOp::ACCESS;
+            parseInts(p, e, command.args, 2);
+            const char* type;
+            size_t type_length = nextWord(p, e, type);
+            AccessType access = AccessType::READ;
+            if (wordIs(type, type_length, "WRITE")) access = AccessType::WRITE;
+            if (wordIs(type, type_length, "EXECUTE")) access = AccessType::EXECUTE;
+            command.args[2] = static_cast<int32_t>(access);
+        } else if (wordIs(word, length, "lock") || wordIs(word, length, "unlock")) {
+            // Only the shared mutex has a compact form; named ones stay text.
+            const char* name;
+            parseInts(p, e, command.args, 1);
+            if (nextWord(p, e, name) == 0) {
+                command.op = wordIs(word, length, "lock") ? BatchOp::LOCK : BatchOp::UNLOCK;
+            }
+        } else if (wordIs(word, length, "run")) {
+            command.op = BatchOp::RUN;
+            command.args[0] = -1;
+            parseInts(p, e, command.args, 1);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool BatchReader::nextBinary(BatchCommand& command) {
+    if (pos == end) return false;
+    line_number++;
+    if (static_cast<size_t>(end - pos) < sizeof(BatchRecord)) {
+        failure = "truncated record " + std::to_string(line_number);
+        return false;
+    }
+    BatchRecord record;
+    std::memcpy(&record, pos, sizeof(record));
+    pos += sizeof(record);
+    if (record.op > static_cast<uint8_t>(BatchOp::COMMAND)) {
+        failure = "unknown operation in record " + std::to_string(line_number);
+        return false;
+    }
+
+    command = BatchCommand();
+    command.op = static_cast<BatchOp>(record.op);
+    std::memcpy(command.args, record.args, sizeof(command.args));
+    if (command.op == BatchOp::COMMAND) {
+        size_t length = static_cast<size_t>(record.args[0] < 0 ? 0 : record.args[0]);
+        size_t padded = (length + 3) & ~static_cast<size_t>(3);
+        if (static_cast<size_t>(end - pos) < padded) {
+            failure = "truncated command text in record " + std::to_string(line_number);
+            return false;
+        }
+        command.text = pos;
+        command.length = length;
+        pos += padded;
+    }
+    return true;
+}
+
+// --- Conversion and execution ---
+
+bool compileBatchFile(const std::string& text_path, const std::string& binary_path, std::string* error) {
+    MappedFile input;
+    if (!input.open(text_path, error)) return false;
+    BatchReader reader(input.data(), input.size());
+    if (reader.isBinary()) {
+        if (error) *error = text_path + " is already a binary batch file";
+        return false;
+    }
+    FILE* output = std::fopen(binary_path.c_str(), "wb");
+    if (output == nullptr) {
+        if (error) *error = "cannot create " + binary_path;
+        return false;
+    }
+
+    std::fwrite(BATCH_MAGIC, sizeof(BATCH_MAGIC), 1, output);
+    static const char padding[4] = {0, 0, 0, 0};
+    BatchCommand command;
+    while (reader.next(command)) {
+        BatchRecord record = {};
+        record.op = static_cast<uint8_t>(command.op);
+        std::memcpy(record.args, command.args, sizeof(record.args));
+        if (command.op == BatchOp::COMMAND) record.args[0] = static_cast<int32_t>(command.length);
+        std::fwrite(&record, sizeof(record), 1, output);
+        if (command.op == BatchOp::COMMAND) {
+            std::fwrite(command.text, 1, command.length, output);
+            std::fwrite(padding, 1, ((command.length + 3) & ~static_cast<size_t>(3)) - command.length, output);
+        }
+    }
+    bool ok = std::fclose(output) == 0;
+    if (!ok && error) *error = "cannot write " + binary_path;
+    return ok;
+}
+
+bool runBatch(const std::string& path, SystemConfig config, BatchSummary& summary, std::string* error) {
+    MappedFile input;
+    if (!input.open(path, error)) return false;
+
+    std::ostringstream discarded;
+    discarded.setstate(std::ios::badbit); // drop all output without buffering it
+    config.out = &discarded;
+    config.log_sink = &nullSink();
+
+    auto start = std::chrono::steady_clock::now();
+    System system(config);
+    BatchReader reader(input.data(), input.size());
+    BatchCommand command;
+    summary = BatchSummary();
+    summary.binary = reader.isBinary();
+    summary.bytes = input.size();
+    while (reader.next(command)) {
+        summary.commands++;
+        if (!system.execute(command)) break;   // 'exit'
+    }
+    if (!reader.error().empty()) {
+        if (error) *error = path + ": " + reader.error();
+        return false;
+    }
+    BatchCommand finish;
+    finish.op = BatchOp::RUN;
+    finish.args[0] = -1;
+    system.execute(finish);
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    summary.report = system.getReport();
+    return true;
+}
+
+void printBatchReport(std::ostream& os, const BatchSummary& summary) {
+    const SystemReport& r = summary.report;
+    double seconds = summary.seconds > 0 ? summary.seconds : 1e-9;
+    os << "--- Batch Report ---\n";
+    os << "Input:            " << summary.bytes << " bytes (" << (summary.binary ? "binary" : "text") << "), "
+       << summary.commands << " commands\n";
+    os << "Host time:        " << std::fixed << std::setprecision(3) << summary.seconds << " s ("
+       << std::setprecision(0) << summary.commands / seconds << " commands/s)\n";
+    os << "Processes:        " << r.processes << " created, " << r.finished << " finished\n";
+    os << "Simulated time:   " << r.system_time << "\n";
+    os << "Context switches: " << r.context_switches << "\n";
+    os << "Page faults:      " << r.page_faults << "\n";
+    os << "TLB:              " << r.tlb_hits << " hits, " << r.tlb_misses << " misses\n";
+    os << std::setprecision(2);
+    os << "Turnaround:       avg " << r.avg_turnaround << ", p95 " << r.p95_turnaround
+       << ", p99 " << r.p99_turnaround << "\n";
+    os << "Waiting:          avg " << r.avg_waiting << "\n";
+    os << "Response:         p99 " << r.p99_response << "\n";
+    if (r.instructions > 0) os << "Instructions:     " << r.instructions << "\n";
+    os.unsetf(std::ios::floatfield);
+    os << std::setprecision(6);
+}
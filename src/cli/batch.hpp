@@ -0,0 +1,76 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "cli/system.hpp"
+#include "core/mapped_file.hpp"
+
+// Commands a batch file can hold. The frequent ones are decoded straight into
+// integers; anything else is kept as text and goes through runCLICommand.
+enum class BatchOp : uint8_t {
+    CREATE,     // burst, priority, io_time, io_freq
+    ACCESS,     // pid, vpn, AccessType
+    LOCK,       // pid (the 'shared' mutex)
+    UNLOCK,     // pid (the 'shared' mutex)
+    RUN,        // steps (-1: until every process completes)
+    COMMAND     // any other CLI command line, in `text`
+};
+
+struct BatchCommand {
+    BatchOp op = BatchOp::COMMAND;
+    int32_t args[4] = {0, 0, 0, 0};
+    const char* text = nullptr;     // points into the batch file; not NUL-terminated
+    size_t length = 0;
+};
+
+// Binary batch files start with the 8 bytes "MOSKWL01", followed by 20-byte
+// records {op, 3 reserved bytes, 4 x int32 args}. COMMAND records keep the text
+// length in args[0] and are followed by the text, padded to a multiple of 4 bytes.
+//
+// Decodes one command at a time from a text or binary batch file (detected from
+// the header) without copying or allocating. Text files hold one CLI command per
+// line; blank lines and lines starting with '#' are skipped.
+class BatchReader {
+public:
+    BatchReader(const char* data, size_t size);
+
+    bool isBinary() const { return binary; }
+    // Fills `command` with the next command; false at the end of the input or on
+    // a malformed binary record (see error()).
+    bool next(BatchCommand& command);
+    const std::string& error() const { return failure; }
+    long long line() const { return line_number; }
+
+private:
+    const char* pos;
+    const char* end;
+    bool binary;
+    long long line_number;
+    std::string failure;
+
+    bool nextText(BatchCommand& command);
+    bool nextBinary(BatchCommand& command);
+};
+
+// Convert a text batch file to the binary form.
+bool compileBatchFile(const std::string& text_path, const std::string& binary_path, std::string* error = nullptr);
+
+struct BatchSummary {
+    bool binary = false;
+    size_t bytes = 0;
+    long long commands = 0;
+    double seconds = 0.0;
+    SystemReport report;
+};
+
+// Executes every command of the file on a fresh System whose console and log
+// output are discarded, then runs the scheduler until every process completes.
+bool runBatch(const std::string& path, SystemConfig config, BatchSummary& summary, std::string* error = nullptr);
+
+void printBatchReport(std::ostream& os, const BatchSummary& summary);
+
+#endif
@@ -0,0 +1,97 @@
+#include "sweep.hpp"
+#include <atomic>
+#include <thread>
+#include <iomanip>
+#include <sstream>
+
+std::vector<SystemConfig> expandGrid(const SweepGrid& grid) {
+    std::vector<SystemConfig> configs;
+    for (SchedulingPolicy policy : grid.policies)
+    for (int quantum : grid.quanta)
+    for (int frames : grid.frame_counts)
+    for (ReplacementPolicy replacement : grid.replacements)
+    for (int cpus : grid.cpu_counts) {
+        SystemConfig config;
+        config.policy = policy;
+        config.time_quantum = quantum;
+        config.page_size = grid.page_size;
+        config.memory_size = frames * grid.page_size;
+        config.replacement = replacement;
+        config.cpus = cpus;
+        config.mode = grid.mode;
+        configs.push_back(config);
+    }
+    return configs;
+}
+
+static SystemReport runOne(const std::vector<std::string>& workload, SystemConfig config) {
+    std::ostringstream discarded;
+    discarded.setstate(std::ios::badbit); // drop all output without buffering it
+    config.out = &discarded;
+    config.log_sink = &nullSink();        // and skip formatting log messages at all
+
+    System system(config);
+    bool ran = false;
+    for (const std::string& line : workload) {
+        std::istringstream iss(line);
+        std::string command;
+        iss >> command;
+        ran = ran || command == "run";
+        if (!system.runCLICommand(line)) break;
+    }
+    if (!ran) system.runCLICommand("run");
+    return system.getReport();
+}
+
+std::vector<SweepResult> runSweep(const std::vector<std::string>& workload,
+                                  const std::vector<SystemConfig>& configs,
+                                  unsigned threads) {
+    std::vector<SweepResult> results(configs.size());
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    if (threads > configs.size()) threads = static_cast<unsigned>(configs.size());
+
+    // Workers pull the next configuration index until the grid is exhausted.
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < configs.size(); i = next++) {
+            results[i].config = configs[i];
+            results[i].report = runOne(workload, configs[i]);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) pool.emplace_back(worker);
+    for (auto& thread : pool) thread.join();
+    return results;
+}
+
+void printSweepTable(std::ostream& os, const std::vector<SweepResult>& results) {
+    os << std::left << std::setw(10) << "Policy"
+       << std::setw(8) << "Quantum"
+       << std::setw(8) << "Frames"
+       << std::setw(8) << "Repl"
+       << std::setw(6) << "CPUs"
+       << std::setw(12) << "Turnaround"
+       << std::setw(10) << "Waiting"
+       << std::setw(8) << "Faults"
+       << std::setw(10) << "CtxSwitch"
+       << std::setw(8) << "MaxLag"
+       << std::setw(8) << "Time" << "\n";
+    os << std::string(96, '-') << "\n";
+    for (const auto& result : results) {
+        const SystemConfig& c = result.config;
+        const SystemReport& r = result.report;
+        os << std::left << std::setw(10) << schedulingPolicyToString(c.policy)
+           << std::setw(8) << c.time_quantum
+           << std::setw(8) << c.memory_size / c.page_size
+           << std::setw(8) << replacementPolicyToString(c.replacement)
+           << std::setw(6) << c.cpus
+           << std::fixed << std::setprecision(2)
+           << std::setw(12) << r.avg_turnaround
+           << std::setw(10) << r.avg_waiting
+           << std::setw(8) << r.page_faults
+           << std::setw(10) << r.context_switches
+           << std::setw(8) << r.worst_lag
+           << std::setw(8) << r.system_time << "\n";
+    }
+}
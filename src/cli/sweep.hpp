@@ -0,0 +1,37 @@
+#ifndef SWEEP_HPP
+#define SWEEP_HPP
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include "cli/system.hpp"
+
+// Axes of a parameter sweep. Every combination of values becomes one configuration.
+struct SweepGrid {
+    std::vector<SchedulingPolicy> policies = {SchedulingPolicy::ROUND_ROBIN};
+    std::vector<int> quanta = {4};
+    std::vector<int> frame_counts = {32};
+    std::vector<ReplacementPolicy> replacements = {ReplacementPolicy::LRU};
+    std::vector<int> cpu_counts = {1};
+    int page_size = 4;
+    ExecutionMode mode = ExecutionMode::EVENT;
+};
+
+struct SweepResult {
+    SystemConfig config;
+    SystemReport report;
+};
+
+// Cartesian product of the grid's axes.
+std::vector<SystemConfig> expandGrid(const SweepGrid& grid);
+
+// Replays `workload` (CLI command lines) on one isolated System per configuration,
+// spread over `threads` worker threads (0 = one per host core). Each System writes
+// its console output to a private discarded stream. Results keep the order of `configs`.
+std::vector<SweepResult> runSweep(const std::vector<std::string>& workload,
+                                  const std::vector<SystemConfig>& configs,
+                                  unsigned threads = 0);
+
+void printSweepTable(std::ostream& os, const std::vector<SweepResult>& results);
+
+#endif
@@ -1,162 +1,400 @@
 #include "system.hpp"
+#include "batch.hpp"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 using namespace std;
 
-System::System() : mmu(128, 4, ReplacementPolicy::LRU),
-                   scheduler(SchedulingPolicy::ROUND_ROBIN, 4),
+System::System() : System(SystemConfig()) {}
+
+System::System(const SystemConfig& config)
+                 : out(config.out != nullptr ? config.out : &std::cout),
+                   out_sink(*out),
+                   logger(out_sink),
+                   mmu(config.memory_size, config.page_size, config.replacement, *out),
+                   scheduler(config.policy, config.time_quantum, *out),
                    next_pid(1),
                    system_time(0),
+                   ready_queue(scheduler.makeReadyQueue()),
                    total_processes_created(0),
-                   total_turnaround_time(0),
-                   finished_process_count(0),
-                   shared_resource_value(0)
+                   reap_terminated(config.reap_terminated),
+                   load_window(-1),
+                   sync(*this),
+                   shared_mutex(sync.mutex("shared"))
 {
-    cout << "System initialized.\n";
+    scheduler.setExecutionMode(config.mode);
+    scheduler.setProgramHost(this);
+    mmu.configureTlb(config.tlb);
+    mmu.setFaultLatency(config.fault_latency);
+    mmu.configureReadahead(config.readahead);
+    mmu.configureResidentSets(config.resident_set);
+    enableLoadControl(config.load_control);
+    std::string error;
+    if (config.swap_slots > 0 && !mmu.configureSwap(config.swap_slots, config.swap_path, &error)) {
+        *out << "Swap disabled: " << error << "\n";
+    }
+    scheduler.setCfsTunables(config.cfs_target_latency, config.cfs_min_granularity);
+    if (config.log_sink != nullptr) {
+        setLogSink(config.log_sink);
+    }
+    if (config.cpus > 1) {
+        scheduler.setCpuCount(config.cpus, config.balance_interval, *ready_queue);
+    }
+    *out << "System initialized.\n";
 }
 
 // Main interactive loop for the unified CLI
 void System::runCLI()
 {
-    string line, command;
-    cout << "\nWelcome to the MOSKS Unified CLI.\nType 'help' for a list of commands.\n";
+    string line;
+    *out << "\nWelcome to the MOSKS Unified CLI.\nType 'help' for a list of commands.\n";
 
     while (true)
     {
-        cout << "\nMOSKS> ";
-        getline(cin, line);
-        istringstream iss(line);
-        iss >> command;
-
-        if (command == "help")
+        *out << "\nMOSKS> ";
+        if (!getline(cin, line) || !runCLICommand(line))
         {
-            std::cout << "Available Commands:\n"
-                      << "  create <burst> <prio> [io_time] [io_freq] - Create a new process.\n"
-                      << "  access <pid> <vpn> <type>                 - Access memory (type: READ, WRITE, EXECUTE).\n"
-                      << "  lock <pid>                                - Process attempts to lock the shared resource.\n"
-                      << "  unlock <pid>                              - Process attempts to unlock the shared resource.\n"
-                      << "  run [steps]                               - Run the CPU scheduler.\n"
-                      << "  ps                                        - Show process list.\n"
-                      << "  mem <pid>                                 - Show page table for a process.\n"
-                      << "  memmap                                    - Display the physical memory layout.\n"
-                      << "  queues                                    - Display the scheduler ready and waiting queues.\n"
-                      << "  stats                                     - Show system statistics.\n"
-                      << "  loglevel <level>                          - Set log level (0=NORMAL, 1=VERBOSE, 2=DEBUG).\n"
-                      << "  exit                                      - Exit the simulator.\n";
+            break;
         }
-        else if (command == "create")
-        {
-            int burst = 0, prio = 0, io_time = 0, io_freq = 0;
-            iss >> burst >> prio >> io_time >> io_freq;
-            if (burst > 0)
-            {
-                createProcess(burst, prio, io_time, io_freq);
-            }
-            else
-            {
-                cout << "Usage: create <burst_time> <priority> [io_time] [io_freq]\n";
-            }
+    }
+}
+
+// Executes a single CLI command line. Returns false once the user asks to exit.
+bool System::runCLICommand(const std::string& command_line)
+{
+    string command;
+    istringstream iss(command_line);
+    iss >> command;
+
+    if (command == "help")
+    {
+        *out << "Available Commands:\n"
+             << "  create <burst> <prio> [io_time] [io_freq] - Create a new process.\n"
+             << "  fork <pid>                                - Clone a process, sharing its memory copy-on-write.\n"
+             << "  access <pid> <vpn> <type>                 - Access memory (type: READ, WRITE, EXECUTE).\n"
+             << "  lock <pid> [mutex]                        - Process locks a mutex (default: shared).\n"
+             << "  unlock <pid> [mutex]                      - Process unlocks a mutex (default: shared).\n"
+             << "  mutex <name> <pi|nopi>                    - Turn priority inheritance on or off for a mutex.\n"
+             << "  sem <name> <count>                        - Create a counting semaphore.\n"
+             << "  wait <pid> <sem> / signal <sem>           - Take or give a semaphore unit.\n"
+             << "  cvwait <pid> <cv> <mutex>                 - Release the mutex and sleep on a condition variable.\n"
+             << "  cvsignal <cv> / cvbroadcast <cv>          - Wake one or all waiters of a condition variable.\n"
+             << "  locks                                     - Show per-lock contention statistics.\n"
+             << "  program <name> [statements]               - Define a process program, or list one.\n"
+             << "  spawn <program> [prio] [count]            - Create processes that run a program.\n"
+             << "  run [steps]                               - Run the CPU scheduler.\n"
+             << "  ps                                        - Show process list.\n"
+             << "  mem <pid>                                 - Show page table for a process.\n"
+             << "  memmap                                    - Display the physical memory layout.\n"
+             << "  tlb <entries> [ways] [LRU|FIFO|RANDOM] [split] | tlb off - Reshape the TLB.\n"
+             << "  swap <slots> [path] | swap off            - Write dirty evicted pages to a swap file.\n"
+             << "  faultcost <fault> <clean> <writeback> <swapin> - Set the page fault latency model.\n"
+             << "  readahead <max_window> [initial] | readahead off - Prefault pages ahead of sequential faults.\n"
+             << "  shm [create <name> <pages> | remove <name>] - Create, remove or list shared memory segments.\n"
+             << "  shm attach <pid> <name> <vpn> [rwx] | shm detach <pid> <name> - Map or unmap a segment.\n"
+             << "  rss [<pid> <pages|off> | local | global | window <ws> [faults]] - Resident set limits and stats.\n"
+             << "  loadcontrol <suspend_rate> <resume_rate> | loadcontrol off - Suspend processes while thrashing.\n"
+             << "  queues                                    - Display the scheduler ready and waiting queues.\n"
+             << "  stats                                     - Show system statistics.\n"
+             << "  loglevel <level>                          - Set log level (0=NORMAL, 1=VERBOSE, 2=DEBUG).\n"
+             << "  mode <tick|event>                         - Step the scheduler per tick or jump between events.\n"
+             << "  logsink <stdout|null|ring <n>|file <path>> - Choose where log messages go.\n"
+             << "  logdump                                   - Print the messages held by a ring log sink.\n"
+             << "  trace <start <path>|stop>                 - Record scheduler events to a binary trace file.\n"
+             << "  reap                                      - Release the memory of terminated processes.\n"
+             << "  cpus <n> [balance_interval]               - Simulate n CPUs with per-CPU run queues.\n"
+             << "  policy <RR|PRIORITY|SJF|CFS>              - Switch the scheduling policy.\n"
+             << "  cfs <target_latency> <min_granularity>    - Tune the CFS scheduling period.\n"
+             << "  exit                                      - Exit the simulator.\n"
+             << "Start with '--batch <file>' to run a command file without the shell.\n";
+    }
+    else if (command == "create")
+    {
+        BatchCommand create;
+        create.op = BatchOp::CREATE;
+        iss >> create.args[0] >> create.args[1] >> create.args[2] >> create.args[3];
+        execute(create);
+    }
+    else if (command == "access")
+    {
+        BatchCommand access;
+        access.op = BatchOp::ACCESS;
+        string type_str;
+        iss >> access.args[0] >> access.args[1] >> type_str;
+        AccessType type = AccessType::READ;
+        if (type_str == "WRITE")
+            type = AccessType::WRITE;
+        if (type_str == "EXECUTE")
+            type = AccessType::EXECUTE;
+        access.args[2] = static_cast<int>(type);
+        execute(access);
+    } else if(command == "lock" || command == "unlock"){
+        BatchCommand mutex_op;
+        mutex_op.op = (command == "lock") ? BatchOp::LOCK : BatchOp::UNLOCK;
+        string name;
+        iss >> mutex_op.args[0] >> name;
+        if (name.empty() || mutex_op.args[0] <= 0) {
+            execute(mutex_op);
+        } else if (command == "lock") {
+            lockMutex(mutex_op.args[0], sync.mutex(name));
+        } else if (Mutex* mutex = sync.findMutex(name)) {
+            unlockMutex(mutex_op.args[0], *mutex);
+        } else {
+            *out << "Mutex '" << name << "' does not exist.\n";
         }
-        else if (command == "access")
-        {
-            int pid = 0, vpn = 0;
-            string type_str;
-            iss >> pid >> vpn >> type_str;
-            AccessType type = AccessType::READ;
-            if (type_str == "WRITE")
-                type = AccessType::WRITE;
-            if (type_str == "EXECUTE")
-                type = AccessType::EXECUTE;
-            accessMemory(pid, vpn, type);
-        } else if(command == "lock"){
-            int pid = 0;
-            iss >> pid;
-            if (pid > 0) {
-                lockSharedResource(pid);
-            } else {
-                std::cout << "Usage: lock <pid>\n";
-            }
-        } else if(command == "unlock"){
-            int pid = 0;
-            iss >> pid;
-            if (pid > 0) {
-                unlockSharedResource(pid);
-            } else {
-                std::cout << "Usage: unlock <pid>\n";
-            }
+    }
+    else if (command == "mutex")
+    {
+        configureMutex(iss);
+    }
+    else if (command == "sem")
+    {
+        createSemaphore(iss);
+    }
+    else if (command == "wait" || command == "signal")
+    {
+        int pid = 0;
+        string name;
+        if (command == "wait") iss >> pid;
+        iss >> name;
+        if (name.empty() || (command == "wait" && pid <= 0)) {
+            *out << "Usage: wait <pid> <sem> | signal <sem>\n";
+        } else if (command == "wait") {
+            waitSemaphore(pid, name);
+        } else {
+            signalSemaphore(name);
         }
-        else if (command == "run")
-        {
-            int num_steps = -1; // Default to run until competion
-            iss >> num_steps;
-
-            if (num_steps > 0)
-            {
-                cout << "Running scheduler for " << num_steps << " steps...\n";
-                scheduler.run(ready_queue, waiting_queue, system_time, num_steps);
-            }
-            else
-            {
-                cout << "Running scheduler until all processes complete...\n";
-                scheduler.run(ready_queue, waiting_queue, system_time);
-            }
+    }
+    else if (command == "cvwait")
+    {
+        int pid = 0;
+        string cv_name, mutex_name;
+        iss >> pid >> cv_name >> mutex_name;
+        if (pid > 0 && !mutex_name.empty()) {
+            waitCondition(pid, cv_name, mutex_name);
+        } else {
+            *out << "Usage: cvwait <pid> <cv> <mutex>\n";
         }
-        else if (command == "ps")
-        {
-            showProcessList();
+    }
+    else if (command == "cvsignal" || command == "cvbroadcast")
+    {
+        string cv_name;
+        iss >> cv_name;
+        if (!cv_name.empty()) {
+            signalCondition(cv_name, command == "cvbroadcast");
+        } else {
+            *out << "Usage: " << command << " <cv>\n";
         }
-        else if (command == "mem")
+    }
+    else if (command == "locks")
+    {
+        sync.display(*out);
+    }
+    else if (command == "program")
+    {
+        defineProgram(iss);
+    }
+    else if (command == "spawn")
+    {
+        spawnProgram(iss);
+    }
+    else if (command == "run")
+    {
+        BatchCommand run;
+        run.op = BatchOp::RUN;
+        run.args[0] = -1; // Default to run until competion
+        iss >> run.args[0];
+        execute(run);
+    }
+    else if (command == "fork")
+    {
+        int pid = 0;
+        iss >> pid;
+        forkProcess(pid);
+    }
+    else if (command == "reap")
+    {
+        int reaped = reapTerminated();
+        *out << "Reaped " << reaped << " terminated process" << (reaped == 1 ? "" : "es") << ".\n";
+    }
+    else if (command == "ps")
+    {
+        showProcessList();
+    }
+    else if (command == "mem")
+    {
+        int pid = 0;
+        iss >> pid;
+        if (const ProcessControlBlock* pcb = process_table.find(pid))
         {
-            int pid = 0;
-            iss >> pid;
-            if (process_table.count(pid))
-            {
-                mmu.printPageTable(process_table.at(pid));
-            }
-            else
-            {
-                cout << "Process " << pid << " not found.\n";
-            }
-        }else if(command == "memmap"){
-            mmu.displayMemoryLayout();
-        }else if(command == "queues"){
-            scheduler.displayQueues(ready_queue,waiting_queue);
+            mmu.printPageTable(*pcb);
         }
-        else if (command == "stats")
+        else
         {
-            showStats();
-        } else if( command == "loglevel"){
-            int level = 0;
-            iss >> level;
-            switch(level) {
-                case 1: setLogLevel(VERBOSE); break;
-                case 2: setLogLevel(DEBUG); break;
-                default: setLogLevel(NORMAL); break;
-            }
+            *out << "Process " << pid << " not found.\n";
         }
-        else if (command == "exit")
-        {
-            cout << "Shutting down MOSKS...\n";
-            break;
+    }else if(command == "memmap"){
+        mmu.displayMemoryLayout();
+    }else if(command == "tlb"){
+        configureTlb(iss);
+    }else if(command == "swap"){
+        configureSwap(iss);
+    }else if(command == "faultcost"){
+        configureFaultCost(iss);
+    }else if(command == "readahead"){
+        configureReadahead(iss);
+    }else if(command == "shm"){
+        sharedMemory(iss);
+    }else if(command == "rss"){
+        configureResidentSets(iss);
+    }else if(command == "loadcontrol"){
+        configureLoadControl(iss);
+    }else if(command == "queues"){
+        scheduler.displayQueues(*ready_queue,waiting_queue);
+    }
+    else if (command == "stats")
+    {
+        showStats();
+    } else if( command == "loglevel"){
+        int level = 0;
+        iss >> level;
+        switch(level) {
+            case 1: setLogLevel(VERBOSE); break;
+            case 2: setLogLevel(DEBUG); break;
+            default: setLogLevel(NORMAL); break;
         }
-        else if (!command.empty())
-        {
-            cout << "Unknown command: '" << command << "'. Type 'help' for a list of commands.\n";
+    }
+    else if (command == "logsink")
+    {
+        configureLogSink(iss);
+    }
+    else if (command == "logdump")
+    {
+        dumpLogRing();
+    }
+    else if (command == "trace")
+    {
+        configureTrace(iss);
+    }
+    else if (command == "mode")
+    {
+        string mode_str;
+        iss >> mode_str;
+        if (mode_str == "tick") {
+            scheduler.setExecutionMode(ExecutionMode::TICK);
+            *out << "Scheduler will advance one tick at a time.\n";
+        } else if (mode_str == "event") {
+            scheduler.setExecutionMode(ExecutionMode::EVENT);
+            *out << "Scheduler will skip ahead to the next event.\n";
+        } else {
+            *out << "Usage: mode <tick|event>\n";
+        }
+    }
+    else if (command == "cpus")
+    {
+        int count = 0, interval = DEFAULT_BALANCE_INTERVAL;
+        iss >> count >> interval;
+        if (count > 0) {
+            scheduler.setCpuCount(count, interval, *ready_queue);
+        } else {
+            *out << "Usage: cpus <n> [balance_interval]\n";
+        }
+    }
+    else if (command == "policy")
+    {
+        string name;
+        iss >> name;
+        SchedulingPolicy policy;
+        if (parseSchedulingPolicy(name, policy)) {
+            changePolicy(policy);
+        } else {
+            *out << "Usage: policy <RR|PRIORITY|SJF|CFS>\n";
+        }
+    }
+    else if (command == "cfs")
+    {
+        int latency = 0, granularity = 0;
+        iss >> latency >> granularity;
+        if (latency > 0 && granularity > 0) {
+            scheduler.setCfsTunables(latency, granularity);
+            *out << "CFS target latency set to " << latency << ", minimum granularity to " << granularity << ".\n";
+        } else {
+            *out << "Usage: cfs <target_latency> <min_granularity>\n";
+        }
+    }
+    else if (command == "exit")
+    {
+        *out << "Shutting down MOSKS...\n";
+        return false;
+    }
+    else if (!command.empty())
+    {
+        *out << "Unknown command: '" << command << "'. Type 'help' for a list of commands.\n";
+    }
+    return true;
+}
+
+// Shared by the interactive shell and batch mode; the shell parses a line into
+// the same BatchCommand a batch file decodes to.
+bool System::execute(const BatchCommand& command)
+{
+    const int* args = command.args;
+    switch (command.op) {
+        case BatchOp::CREATE:
+            if (args[0] > 0) {
+                createProcess(args[0], args[1], args[2], args[3]);
+            } else {
+                *out << "Usage: create <burst_time> <priority> [io_time] [io_freq]\n";
+            }
+            break;
+        case BatchOp::ACCESS:
+            accessMemory(args[0], args[1], static_cast<AccessType>(args[2]));
+            break;
+        case BatchOp::LOCK:
+        case BatchOp::UNLOCK: {
+            bool lock = command.op == BatchOp::LOCK;
+            if (args[0] > 0) {
+                if (lock) lockMutex(args[0], shared_mutex); else unlockMutex(args[0], shared_mutex);
+            } else {
+                *out << "Usage: " << (lock ? "lock" : "unlock") << " <pid> [mutex]\n";
+            }
+            break;
         }
+        case BatchOp::RUN:
+            runScheduler(args[0]);
+            break;
+        case BatchOp::COMMAND:
+            return runCLICommand(std::string(command.text, command.length));
     }
+    return true;
 }
 
 // --- Private Helper Functions ---
 
-void System::createProcess(int burst, int priority, int io_time, int io_freq)
+void System::runScheduler(int num_steps)
+{
+    if (num_steps > 0)
+    {
+        *out << "Running scheduler for " << num_steps << " steps...\n";
+        scheduler.run(*ready_queue, waiting_queue, system_time, num_steps);
+    }
+    else
+    {
+        *out << "Running scheduler until all processes complete...\n";
+        scheduler.run(*ready_queue, waiting_queue, system_time);
+    }
+    if (reap_terminated) reapTerminated();
+}
+
+ProcessControlBlock& System::createProcess(int burst, int priority, int io_time, int io_freq)
 {
     total_processes_created++;
 
     // 1. Create and store the PCB
-    process_table.emplace(next_pid, ProcessControlBlock(next_pid, burst, priority, io_time, io_freq));
-    ProcessControlBlock &new_pcb = process_table.at(next_pid);
+    ProcessControlBlock &new_pcb = process_table.create(next_pid, burst, priority, io_time, io_freq);
     new_pcb.creation_time = system_time;
+    new_pcb.ready_since = system_time;
     // 2. Initialize its memory with the MMU
     mmu.allocateProcess(new_pcb);
 
@@ -164,71 +402,169 @@ void System::createProcess(int burst, int priority, int io_time, int io_freq)
     new_pcb.state = ProcessState::READY;
 
     // 3. Add it to the scheduler's ready queue
-    ready_queue.push_back(&new_pcb);
+    ready_queue->push(&new_pcb);
+    trace(TraceEvent::ADMIT, new_pcb, new_pcb.remaining_burst_time);
 
-    std::cout << "Created Process " << next_pid << ".\n";
+    *out << "Created Process " << next_pid << ".\n";
     next_pid++;
+    return new_pcb;
+}
+
+// The child starts with the parent's remaining work, program position and
+// address space; the MMU shares the parent's frames with it copy-on-write.
+void System::forkProcess(int pid)
+{
+    ProcessControlBlock* parent = process_table.find(pid);
+    if (parent == nullptr || parent->state == ProcessState::TERMINATED)
+    {
+        *out << "Process " << pid << " not found or already terminated.\n";
+        return;
+    }
+    ProcessControlBlock &child = createProcess(parent->remaining_burst_time, parent->base_priority,
+                                               parent->io_burst_time, parent->io_burst_frequency);
+    child.program = parent->program;
+    mmu.forkProcess(*parent, child);
+}
+
+// program <name> [statements]: the statements are the rest of the line (see parseProgram).
+void System::defineProgram(std::istringstream& args)
+{
+    string name, source;
+    args >> name;
+    getline(args, source);
+    if (name.empty()) {
+        *out << "Usage: program <name> [statements separated by ';']\n";
+        return;
+    }
+    auto it = programs.find(name);
+    if (source.find_first_not_of(" \t") == string::npos) {
+        if (it == programs.end()) {
+            *out << "Program '" << name << "' does not exist.\n";
+            return;
+        }
+        const Program& program = *it->second;
+        *out << "--- Program " << name << " (" << program.cpu_time << " ticks of CPU) ---\n";
+        int depth = 0;
+        for (int pc = 0; pc < static_cast<int>(program.code.size()); ++pc) {
+            if (program.code[pc].op == OpCode::END) depth--;
+            *out << std::setw(4) << pc << "  " << string(2 * depth, ' ') << describeInstruction(program, pc) << "\n";
+            if (program.code[pc].op == OpCode::REPEAT) depth++;
+        }
+        return;
+    }
+    if (it != programs.end()) {
+        *out << "Program '" << name << "' already exists.\n";
+        return;
+    }
+    std::unique_ptr<Program> program(new Program());
+    string error;
+    if (!parseProgram(name, source, *program, &error)) {
+        *out << "Error in program '" << name << "': " << error << "\n";
+        return;
+    }
+    for (size_t i = 0; i < program->mutex_names.size(); ++i) {
+        program->mutexes[i] = &sync.mutex(program->mutex_names[i]);
+    }
+    *out << "Defined program '" << name << "' (" << program->code.size() << " instructions, "
+         << program->cpu_time << " ticks of CPU).\n";
+    programs[name] = std::move(program);
+}
+
+// spawn <program> [priority] [count]
+void System::spawnProgram(std::istringstream& args)
+{
+    string name;
+    int priority = 0, count = 1;
+    args >> name >> priority >> count;
+    auto it = programs.find(name);
+    if (it == programs.end()) {
+        *out << "Program '" << name << "' does not exist.\n";
+        return;
+    }
+    const Program& program = *it->second;
+    for (int i = 0; i < count; ++i) {
+        ProcessControlBlock& pcb = createProcess(static_cast<int>(program.cpu_time), priority, 0, 0);
+        pcb.program.code = &program;
+    }
+}
+
+// The ready queue's structure depends on the policy, so it is rebuilt and refilled.
+void System::changePolicy(SchedulingPolicy policy)
+{
+    std::unique_ptr<ReadyQueue> old_queue = std::move(ready_queue);
+    scheduler.setPolicy(policy, *old_queue);
+    ready_queue = scheduler.makeReadyQueue();
+    while (ProcessControlBlock* pcb = old_queue->pop())
+    {
+        ready_queue->push(pcb);
+    }
 }
 
 void System::accessMemory(int pid, int vpn, AccessType type)
 {
-    if (process_table.count(pid))
+    if (ProcessControlBlock* pcb = process_table.find(pid))
     {
-        mmu.accessPage(process_table.at(pid), vpn, type);
+        mmu.accessPage(*pcb, vpn, type);
     }
     else
     {
-        std::cout << "Process " << pid << " not found.\n";
+        *out << "Process " << pid << " not found.\n";
     }
 }
 
 void System::showStats()
 {
-    int ready_count = 0;
-    int waiting_count = 0;
-    int terminated_count = 0;
-    int running_count = 0;
-
-    int total_turnaround_time = 0;
-    int finished_process_count = 0;
-
-    for (const auto &pair : process_table)
-    {
-        const ProcessControlBlock &pcb = pair.second;
-        switch (pcb.state) {
-            case ProcessState::READY: ready_count++; break;
-            case ProcessState::WAITING: waiting_count++; break;
-            case ProcessState::RUNNING: running_count++; break;
-            case ProcessState::TERMINATED: 
-                terminated_count++;
-                if (pcb.completion_time != -1) {
-                    total_turnaround_time += (pcb.completion_time - pcb.creation_time);
-                    finished_process_count++;
-                }
-                break;
-            default: break;  
-        }
+    // The counts and latency statistics are maintained incrementally. Only the
+    // per-process tables (CFS fairness, resident sets) need the process table,
+    // which is walked once for both.
+    const SchedulerStats& stats = scheduler.getStats();
+    long long ready_count = static_cast<long long>(scheduler.readyCount(*ready_queue));
+    long long waiting_count = static_cast<long long>(waiting_queue.size());
+    long long blocked_count = sync.blockedCount();
+    long long terminated_count = stats.completed;
+    long long suspended_count = static_cast<long long>(scheduler.suspendedCount());
+    long long running_count = total_processes_created - ready_count - waiting_count - blocked_count - terminated_count
+                              - suspended_count;
+
+    *out << "\n--- System Statistics ---\n";
+    *out << "Current System Time: " << system_time << "\n";
+    *out << "Total Processes Created: " << total_processes_created << "\n";
+    if (stats.turnaround.count() > 0) {
+        *out << "Average Turnaround Time: " << stats.turnaround.mean() << " units\n";
     }
+    *out << "Process States:\n";
+    *out << "  - Running:    " << running_count << "\n";
+    *out << "  - Ready:      " << ready_count << "\n";
+    *out << "  - Waiting:    " << waiting_count << "\n";
+    *out << "  - Blocked:    " << blocked_count << "\n";
+    *out << "  - Suspended:  " << suspended_count << "\n";
+    *out << "  - Terminated: " << terminated_count << "\n";
+    
+    scheduler.displayLatencyStats();
+    scheduler.displayCpuStats();
 
-    double avg_turnaround_time = 0.0;
-    if (finished_process_count > 0) {
-        avg_turnaround_time = static_cast<double>(total_turnaround_time) / finished_process_count;
+    std::vector<const ProcessControlBlock*> processes, resident;
+    process_table.forEach([&](const ProcessControlBlock& pcb) {
+        processes.push_back(&pcb);
+        if (pcb.state != ProcessState::TERMINATED) resident.push_back(&pcb);
+    });
+    if (scheduler.getPolicy() == SchedulingPolicy::CFS) {
+        scheduler.displayFairness(processes);
     }
 
-    std::cout << "\n--- System Statistics ---\n";
-    std::cout << "Current System Time: " << system_time << "\n";
-    std::cout << "Total Processes Created: " << process_table.size() << "\n";
-    if (finished_process_count > 0) {
-        std::cout << "Average Turnaround Time: " << avg_turnaround_time << " units\n";
+    *out << "\n--- MMU Statistics ---\n";
+    *out << "Total Page Faults: " << mmu.getPageFaults() << " (" << mmu.getCowCopies() << " copy-on-write, "
+         << mmu.getMinorFaults() << " shared memory minor)\n";
+    mmu.printResidentSets(resident);
+    if (load_control.enabled) {
+        *out << "Load control: suspend above a fault rate of " << load_control.suspend_rate << ", resume below "
+             << load_control.resume_rate << "; " << stats.suspensions << " suspensions\n";
+    } else {
+        *out << "Load control: off\n";
     }
-    std::cout << "Process States:\n";
-    std::cout << "  - Running:    " << running_count << "\n";
-    std::cout << "  - Ready:      " << ready_count << "\n";
-    std::cout << "  - Waiting:    " << waiting_count << "\n";
-    std::cout << "  - Terminated: " << terminated_count << "\n";
-    
-    std::cout << "\n--- MMU Statistics ---\n";
-    std::cout << "Total Page Faults: " << mmu.getPageFaults() << "\n";
+    mmu.printSwapStats();
+    mmu.printReadaheadStats();
+    mmu.printTlbStats();
     mmu.printFrameTable();
 }
 
@@ -246,6 +582,8 @@ string processStateToString(ProcessState state)
         return "WAITING";
     case ProcessState::BLOCKED_ON_MUTEX:
         return "BLOCKED";
+    case ProcessState::SUSPENDED:
+        return "SUSPENDED";
     case ProcessState::TERMINATED:
         return "TERMINATED";
     default:
@@ -254,85 +592,566 @@ string processStateToString(ProcessState state)
 }
 void System::showProcessList()
 {
-    std::cout << "--- Process List ---\n";
-    std::cout << std::left << std::setw(5) << "PID"
-              << std::setw(12) << "State"
-              << std::setw(10) << "Burst"
-              << std::setw(10) << "Priority" << "\n";
-    std::cout << "-------------------------------------\n";
+    *out << "--- Process List ---\n";
+    *out << std::left << std::setw(5) << "PID"
+         << std::setw(12) << "State"
+         << std::setw(10) << "Burst"
+         << std::setw(10) << "Priority" << "\n";
+    *out << "-------------------------------------\n";
 
     if (process_table.empty())
     {
-        std::cout << "(No processes)\n";
+        *out << "(No processes)\n";
         return;
     }
 
-    for (const auto &pair : process_table)
-    {
-        const ProcessControlBlock &pcb = pair.second;
-        std::cout << std::left << std::setw(5) << pcb.process_id
-                  << std::setw(12) << processStateToString(pcb.state)
-                  << std::setw(10) << pcb.remaining_burst_time
-                  << std::setw(10) << pcb.priority << "\n";
-    }
+    process_table.forEach([&](const ProcessControlBlock& pcb) {
+        *out << std::left << std::setw(5) << pcb.process_id
+             << std::setw(12) << processStateToString(pcb.state)
+             << std::setw(10) << pcb.remaining_burst_time
+             << std::setw(10) << pcb.priority << "\n";
+    });
 }
 
 void System::setLogLevel(LogLevel level) {
+    logger.setLevel(level);
     mmu.setLogLevel(level);
     scheduler.setLogLevel(level);
-    std::cout << "System log level set.\n";
+    *out << "System log level set.\n";
 }
 
-void System::lockSharedResource(int pid) {
-    if (!process_table.count(pid)) {
-        std::cout << "Error: Process " << pid << " not found.\n"; return;
+void System::setLogSink(LogSink* sink) {
+    logger.setSink(sink != nullptr ? *sink : out_sink);
+    mmu.setLogSink(sink);
+    scheduler.setLogSink(sink);
+}
+
+// logsink stdout | null | ring <capacity> | file <path>
+void System::configureLogSink(std::istringstream& args) {
+    string kind;
+    args >> kind;
+    std::unique_ptr<LogSink> sink;
+    if (kind == "stdout") {
+        setLogSink(nullptr);
+    } else if (kind == "null") {
+        setLogSink(&nullSink());
+    } else if (kind == "ring") {
+        size_t capacity = 1024;
+        args >> capacity;
+        sink.reset(new RingSink(capacity));
+    } else if (kind == "file") {
+        string path;
+        args >> path;
+        std::unique_ptr<FileSink> file(path.empty() ? nullptr : new FileSink(path));
+        if (!file || !file->isOpen()) {
+            *out << "Cannot open log file '" << path << "'.\n";
+            return;
+        }
+        sink = std::move(file);
+    } else {
+        *out << "Usage: logsink <stdout|null|ring <n>|file <path>>\n";
+        return;
     }
-    ProcessControlBlock* pcb = &process_table.at(pid);
-    std::cout << "P" << pid << " is attempting to lock the mutex...\n";
-    if (shared_resource_mutex.lock(pcb)) {
-        std::cout << "P" << pid << " acquired the lock.\n";
+    if (sink) {
+        setLogSink(sink.get());
+    }
+    // Only release the previous sink once nothing points at it any more.
+    owned_log_sink = std::move(sink);
+    *out << "Log messages now go to " << kind << ".\n";
+}
+
+// tlb <entries> [ways] [LRU|FIFO|RANDOM] [split] | tlb off
+void System::configureTlb(std::istringstream& args) {
+    string first;
+    args >> first;
+    TlbConfig config = mmu.getTlbConfig();
+    if (first == "off") {
+        config.entries = 0;
     } else {
-        std::cout << "P" << pid << " failed to acquire lock and is now BLOCKED.\n";
-        // Remove from ready queue
-        for (size_t i = 0; i < ready_queue.size(); ++i) {
-            if (ready_queue[i] == pcb) {
-                ready_queue.erase(ready_queue.begin() + i);
-                break;
+        std::istringstream number(first);
+        if (!(number >> config.entries) || config.entries <= 0) {
+            *out << "Usage: tlb <entries> [ways] [LRU|FIFO|RANDOM] [split] | tlb off\n";
+            return;
+        }
+        config.ways = 4;
+        config.split = false;
+        string word;
+        while (args >> word) {
+            if (word == "split") {
+                config.split = true;
+            } else if (!parseTlbReplacement(word, config.replacement)) {
+                std::istringstream ways(word);
+                if (!(ways >> config.ways) || config.ways <= 0 || config.ways > config.entries) {
+                    *out << "Invalid TLB option '" << word << "'.\n";
+                    return;
+                }
             }
         }
     }
+    mmu.configureTlb(config);
+    mmu.printTlbStats();
+}
+
+// swap <slots> [path] | swap off
+void System::configureSwap(std::istringstream& args) {
+    string first, path;
+    args >> first >> path;
+    int slots = 0;
+    if (first != "off") {
+        std::istringstream number(first);
+        if (!(number >> slots) || slots <= 0) {
+            *out << "Usage: swap <slots> [path] | swap off\n";
+            return;
+        }
+    }
+    string error;
+    if (!mmu.configureSwap(slots, path, &error)) {
+        *out << "Cannot reconfigure swap: " << error << ".\n";
+        return;
+    }
+    mmu.printSwapStats();
+}
+
+// faultcost <fault> <clean_eviction> <writeback> <swap_in>
+void System::configureFaultCost(std::istringstream& args) {
+    FaultLatency latency;
+    if (!(args >> latency.fault >> latency.clean_eviction >> latency.writeback >> latency.swap_in) ||
+        latency.fault < 0 || latency.clean_eviction < 0 || latency.writeback < 0 || latency.swap_in < 0) {
+        *out << "Usage: faultcost <fault> <clean_eviction> <writeback> <swap_in>\n";
+        return;
+    }
+    mmu.setFaultLatency(latency);
+    *out << "Page faults cost " << latency.fault << " ticks, plus " << latency.clean_eviction
+         << " to drop a clean page, " << latency.writeback << " to write back a dirty one and "
+         << latency.swap_in << " to swap a page in.\n";
+}
+
+// readahead <max_window> [initial_window] | readahead off
+void System::configureReadahead(std::istringstream& args) {
+    string first;
+    args >> first;
+    ReadaheadConfig config = mmu.getReadaheadConfig();
+    if (first == "off") {
+        config.max_window = 0;
+    } else {
+        std::istringstream number(first);
+        if (!(number >> config.max_window) || config.max_window <= 0) {
+            *out << "Usage: readahead <max_window> [initial_window] | readahead off\n";
+            return;
+        }
+        int initial = 0;
+        if (args >> initial && initial > 0) {
+            config.initial_window = initial;
+        }
+    }
+    mmu.configureReadahead(config);
+    mmu.printReadaheadStats();
+}
+
+// rss | rss <pid> <pages|off> | rss local | rss global | rss window <working_set> [fault_window]
+void System::configureResidentSets(std::istringstream& args) {
+    string first;
+    args >> first;
+    ResidentSetConfig config = mmu.getResidentSetConfig();
+    if (first == "local" || first == "global") {
+        config.local_replacement = first == "local";
+        mmu.configureResidentSets(config);
+        *out << "Page replacement is now " << first << ".\n";
+    } else if (first == "window") {
+        int working_set = 0, fault_window = config.fault_window;
+        args >> working_set >> fault_window;
+        if (working_set <= 0 || fault_window <= 0) {
+            *out << "Usage: rss window <working_set_accesses> [fault_window_accesses]\n";
+            return;
+        }
+        config.working_set_window = working_set;
+        config.fault_window = fault_window;
+        mmu.configureResidentSets(config);
+        *out << "Working sets span " << working_set << " accesses; fault rates are measured over "
+             << fault_window << " accesses.\n";
+    } else if (!first.empty()) {
+        std::istringstream number(first);
+        int pid = 0, pages = 0;
+        string limit;
+        args >> limit;
+        ProcessControlBlock* pcb = nullptr;
+        if (number >> pid) pcb = process_table.find(pid);
+        if (pcb == nullptr || pcb->state == ProcessState::TERMINATED) {
+            *out << "Process " << first << " not found or already terminated.\n";
+            return;
+        }
+        std::istringstream pages_in(limit);
+        if (limit != "off" && (!(pages_in >> pages) || pages <= 0)) {
+            *out << "Usage: rss <pid> <pages|off>\n";
+            return;
+        }
+        mmu.setResidentLimit(*pcb, pages);
+    } else {
+        std::vector<const ProcessControlBlock*> processes;
+        process_table.forEach([&](const ProcessControlBlock& pcb) {
+            if (pcb.state != ProcessState::TERMINATED) processes.push_back(&pcb);
+        });
+        mmu.printResidentSets(processes);
+    }
+}
+
+// loadcontrol <suspend_rate> <resume_rate> | loadcontrol off
+void System::configureLoadControl(std::istringstream& args) {
+    string first;
+    args >> first;
+    LoadControlConfig config;
+    if (first != "off") {
+        std::istringstream number(first);
+        if (!(number >> config.suspend_rate) || !(args >> config.resume_rate) || config.suspend_rate <= 0.0 ||
+            config.resume_rate < 0.0 || config.resume_rate > config.suspend_rate) {
+            *out << "Usage: loadcontrol <suspend_rate> <resume_rate> | loadcontrol off (rates are faults per access)\n";
+            return;
+        }
+        config.enabled = true;
+    }
+    enableLoadControl(config);
+    if (config.enabled) {
+        *out << "Load control on: suspend above a fault rate of " << config.suspend_rate << ", resume below "
+             << config.resume_rate << ".\n";
+    } else {
+        *out << "Load control off.\n";
+    }
+}
+
+void System::enableLoadControl(const LoadControlConfig& config) {
+    load_control = config;
+    scheduler.setLoadController(config.enabled ? this : nullptr);
+}
+
+// shm create <name> <pages> | shm attach <pid> <name> <vpn> [rwx] |
+// shm detach <pid> <name> | shm remove <name> | shm
+void System::sharedMemory(std::istringstream& args) {
+    string action, name, permissions = "rw";
+    args >> action;
+    string error;
+    bool ok = true;
+    if (action.empty() || action == "list") {
+        mmu.printSegments();
+        return;
+    } else if (action == "create") {
+        int pages = 0;
+        args >> name >> pages;
+        ok = mmu.createSegment(name, pages, &error);
+    } else if (action == "remove") {
+        args >> name;
+        ok = mmu.removeSegment(name, &error);
+    } else if (action == "attach" || action == "detach") {
+        int pid = 0, vpn = -1;
+        args >> pid >> name;
+        if (action == "attach") args >> vpn >> permissions;
+        ProcessControlBlock* pcb = process_table.find(pid);
+        if (pcb == nullptr || pcb->state == ProcessState::TERMINATED) {
+            *out << "Process " << pid << " not found or already terminated.\n";
+            return;
+        }
+        if (action == "detach") {
+            ok = mmu.detachSegment(*pcb, name, &error);
+        } else if (permissions.find_first_not_of("rwx") != string::npos) {
+            *out << "Permissions are a combination of r, w and x.\n";
+            return;
+        } else {
+            ok = mmu.attachSegment(*pcb, name, vpn, permissions.find('r') != string::npos,
+                                   permissions.find('w') != string::npos, permissions.find('x') != string::npos, &error);
+        }
+    } else {
+        *out << "Usage: shm [create <name> <pages> | attach <pid> <name> <vpn> [rwx] | detach <pid> <name> | remove <name>]\n";
+        return;
+    }
+    if (!ok) {
+        *out << "Shared memory: " << error << ".\n";
+    }
+}
+
+void System::dumpLogRing() {
+    const RingSink* ring = dynamic_cast<const RingSink*>(owned_log_sink.get());
+    if (ring == nullptr) {
+        *out << "The current log sink is not a ring. Use 'logsink ring <n>' first.\n";
+        return;
+    }
+    *out << "--- Log ring (" << ring->size() << " of " << ring->capacity() << " messages, "
+         << ring->dropped() << " overwritten) ---\n";
+    for (const string& line : ring->lines()) {
+        *out << line << "\n";
+    }
+}
+
+void System::configureTrace(std::istringstream& args) {
+    string action, path;
+    args >> action >> path;
+    if (action == "start" && !path.empty()) {
+        stopTrace();
+        std::unique_ptr<TraceRecorder> recorder(new TraceRecorder(path));
+        if (!recorder->isOpen()) {
+            *out << "Cannot open trace file '" << path << "'.\n";
+            return;
+        }
+        tracer = std::move(recorder);
+        scheduler.setTraceRecorder(tracer.get());
+        *out << "Recording scheduler events to " << path << ".\n";
+    } else if (action == "stop") {
+        if (!tracer) {
+            *out << "No trace is being recorded.\n";
+            return;
+        }
+        unsigned long long records = tracer->recorded();
+        stopTrace();
+        *out << "Trace stopped after " << records << " events.\n";
+    } else {
+        *out << "Usage: trace <start <path>|stop>\n";
+    }
 }
 
-void System::unlockSharedResource(int pid) {
-    if (!process_table.count(pid)) {
-        std::cout << "Error: Process " << pid << " not found.\n"; return;
+void System::stopTrace() {
+    scheduler.setTraceRecorder(nullptr);
+    if (tracer) {
+        tracer->close();
+        tracer.reset();
     }
-    ProcessControlBlock* pcb = &process_table.at(pid);
-    std::cout << "P" << pid << " is attempting to unlock the mutex...\n";
-    ProcessControlBlock* unblocked_pcb = shared_resource_mutex.unlock(pcb);
+}
+
+void System::trace(TraceEvent event, const ProcessControlBlock& pcb, int arg) {
+    if (tracer) tracer->record(event, system_time, pcb.process_id, -1, arg);
+}
+
+void System::setSystemLogLevel(LogLevel level) {
+    setLogLevel(level);
+}
+
+// Only a runnable process can issue a call that may put it to sleep.
+ProcessControlBlock* System::findRunnable(int pid, const char* action) {
+    ProcessControlBlock* pcb = process_table.find(pid);
+    if (pcb == nullptr) {
+        *out << "Error: Process " << pid << " not found.\n";
+    } else if (pcb->state != ProcessState::READY) {
+        *out << "Error: P" << pid << " is " << processStateToString(pcb->state) << " and cannot " << action << ".\n";
+        pcb = nullptr;
+    }
+    return pcb;
+}
 
+void System::lockMutex(int pid, Mutex& mutex) {
+    ProcessControlBlock* pcb = findRunnable(pid, "lock");
+    if (pcb == nullptr) return;
+    if (mutex.isOwner(pcb)) {
+        *out << "P" << pid << " already holds mutex '" << mutex.name() << "'.\n";
+        return;
+    }
+    *out << "P" << pid << " is attempting to lock mutex '" << mutex.name() << "'...\n";
+    if (sync.lock(mutex, pcb, system_time)) {
+        *out << "P" << pid << " acquired the lock.\n";
+    } else {
+        *out << "P" << pid << " failed to acquire lock and is now BLOCKED behind P"
+             << mutex.getOwner()->process_id << ".\n";
+    }
+}
+
+void System::unlockMutex(int pid, Mutex& mutex) {
+    ProcessControlBlock* pcb = process_table.find(pid);
+    if (pcb == nullptr) {
+        *out << "Error: Process " << pid << " not found.\n"; return;
+    }
+    if (!mutex.isOwner(pcb)) {
+        *out << "P" << pid << " does not hold mutex '" << mutex.name() << "'.\n";
+        return;
+    }
+    ProcessControlBlock* unblocked_pcb = sync.unlock(mutex, pcb, system_time);
     if (unblocked_pcb != nullptr) {
-        ready_queue.push_back(unblocked_pcb);
-        std::cout << "P" << pid << " unlocked the mutex. P" << unblocked_pcb->process_id << " was unblocked and moved to the ready queue.\n";
+        *out << "P" << pid << " unlocked mutex '" << mutex.name() << "'. P" << unblocked_pcb->process_id
+             << " was unblocked and moved to the ready queue.\n";
     } else {
-        std::cout << "P" << pid << " unlocked the mutex. No processes were waiting.\n";
+        *out << "P" << pid << " unlocked mutex '" << mutex.name() << "'. No processes were waiting.\n";
     }
 }
 
-// Add this new function to system.cpp
-void System::runCLICommand(const std::string& command_line) {
-    std::string command;
-    std::istringstream iss(command_line);
-    iss >> command;
+// mutex <name> <pi|nopi>
+void System::configureMutex(std::istringstream& args) {
+    string name, mode;
+    args >> name >> mode;
+    if (name.empty() || (mode != "pi" && mode != "nopi")) {
+        *out << "Usage: mutex <name> <pi|nopi>\n";
+        return;
+    }
+    sync.setPriorityInheritance(sync.mutex(name), mode == "pi");
+    *out << "Priority inheritance " << (mode == "pi" ? "enabled" : "disabled") << " for mutex '" << name << "'.\n";
+}
+
+// sem <name> <count>
+void System::createSemaphore(std::istringstream& args) {
+    string name;
+    int count = -1;
+    args >> name >> count;
+    if (name.empty() || count < 0) {
+        *out << "Usage: sem <name> <count>\n";
+    } else if (sync.findSemaphore(name) != nullptr) {
+        *out << "Semaphore '" << name << "' already exists.\n";
+    } else {
+        sync.semaphore(name, count);
+        *out << "Created semaphore '" << name << "' with value " << count << ".\n";
+    }
+}
+
+void System::waitSemaphore(int pid, const string& name) {
+    Semaphore* semaphore = sync.findSemaphore(name);
+    if (semaphore == nullptr) {
+        *out << "Semaphore '" << name << "' does not exist.\n";
+        return;
+    }
+    ProcessControlBlock* pcb = findRunnable(pid, "wait");
+    if (pcb == nullptr) return;
+    if (sync.wait(*semaphore, pcb, system_time)) {
+        *out << "P" << pid << " took a unit of '" << name << "' (" << semaphore->value() << " left).\n";
+    } else {
+        *out << "P" << pid << " is BLOCKED on semaphore '" << name << "'.\n";
+    }
+}
+
+void System::signalSemaphore(const string& name) {
+    Semaphore* semaphore = sync.findSemaphore(name);
+    if (semaphore == nullptr) {
+        *out << "Semaphore '" << name << "' does not exist.\n";
+        return;
+    }
+    if (ProcessControlBlock* woken = sync.signal(*semaphore, system_time)) {
+        *out << "Signalled '" << name << "'. P" << woken->process_id << " was unblocked.\n";
+    } else {
+        *out << "Signalled '" << name << "' (value " << semaphore->value() << ").\n";
+    }
+}
+
+void System::waitCondition(int pid, const string& cv_name, const string& mutex_name) {
+    Mutex* mutex = sync.findMutex(mutex_name);
+    ProcessControlBlock* pcb = findRunnable(pid, "wait");
+    if (pcb == nullptr) return;
+    if (mutex == nullptr || !mutex->isOwner(pcb)) {
+        *out << "P" << pid << " must hold mutex '" << mutex_name << "' to wait on '" << cv_name << "'.\n";
+        return;
+    }
+    ConditionVariable& cv = sync.conditionVariable(cv_name);
+    if (cv.boundMutex() != nullptr && cv.boundMutex() != mutex) {
+        *out << "Condition variable '" << cv_name << "' is in use with mutex '" << cv.boundMutex()->name() << "'.\n";
+        return;
+    }
+    sync.wait(cv, *mutex, pcb, system_time);
+    *out << "P" << pid << " released '" << mutex_name << "' and is BLOCKED on '" << cv_name << "'.\n";
+}
+
+void System::signalCondition(const string& cv_name, bool broadcast) {
+    size_t woken = sync.signal(sync.conditionVariable(cv_name), system_time, broadcast);
+    *out << "Woke " << woken << " waiter" << (woken == 1 ? "" : "s") << " of '" << cv_name << "'.\n";
+}
+
+void System::sleep(ProcessControlBlock* pcb) {
+    // Remove from ready queue (O(log n) via the PCB's queue handle). A running
+    // program that blocks is on no queue.
+    if (scheduler.dequeue(pcb, *ready_queue)) {
+        // Time spent READY so far still counts as waiting; it resumes on wake-up.
+        pcb->total_wait_time += system_time - pcb->ready_since;
+    }
+    trace(TraceEvent::BLOCK, *pcb);
+}
+
+void System::wake(ProcessControlBlock* pcb) {
+    pcb->state = ProcessState::READY;
+    pcb->ready_since = system_time;
+    ready_queue->push(pcb);
+    trace(TraceEvent::UNBLOCK, *pcb);
+}
 
-    if (command == "run") {
-        int num_steps = -1;
-        iss >> num_steps;
-        scheduler.run(ready_queue, waiting_queue, system_time, num_steps);
+// Queues order by priority, so a queued process is taken out and put back.
+void System::setPriority(ProcessControlBlock* pcb, int priority) {
+    bool queued = pcb->state == ProcessState::READY && scheduler.dequeue(pcb, *ready_queue);
+    pcb->priority = priority;
+    if (queued) ready_queue->push(pcb);
+    MOSKS_LOG(logger, VERBOSE, "P" << pcb->process_id << " now runs at priority " << priority
+              << (priority < pcb->base_priority ? " (inherited)" : "") << ".");
+}
+
+int System::touch(ProcessControlBlock* pcb, int vpn, AccessType type) {
+    long long ticks = mmu.getFaultTicks();
+    mmu.accessPage(*pcb, vpn, type);
+    return static_cast<int>(mmu.getFaultTicks() - ticks);
+}
+
+// A process is only suspended if it faults at least as often as the system
+// as a whole, and never the last one that could run.
+bool System::shouldSuspend(ProcessControlBlock* pcb) {
+    const FaultFrequency& rate = mmu.getFaultRate();
+    long long active = total_processes_created - scheduler.getStats().completed
+                       - static_cast<long long>(scheduler.suspendedCount());
+    if (rate.rate < load_control.suspend_rate || rate.windows == load_window || active <= 1 ||
+        pcb->page_directory.fault_rate.rate < rate.rate) {
+        return false;
+    }
+    load_window = rate.windows;
+    int evicted = mmu.trimResidentSet(*pcb, 0);
+    MOSKS_LOG(logger, VERBOSE, "Load control: fault rate " << rate.rate << ", suspending P" << pcb->process_id
+              << " (" << evicted << " pages evicted).");
+    return true;
+}
+
+bool System::shouldResume() {
+    const FaultFrequency& rate = mmu.getFaultRate();
+    if (rate.rate >= load_control.resume_rate || rate.windows == load_window) {
+        return false;
+    }
+    load_window = rate.windows;
+    return true;
+}
+
+// Programs relock a mutex they already own and unlock one they do not hold
+// without effect, rather than deadlocking on themselves.
+bool System::lock(ProcessControlBlock* pcb, int index) {
+    Mutex& mutex = *pcb->program.code->mutexes[index];
+    return mutex.isOwner(pcb) || sync.lock(mutex, pcb, system_time);
+}
+
+void System::unlock(ProcessControlBlock* pcb, int index) {
+    Mutex& mutex = *pcb->program.code->mutexes[index];
+    if (mutex.isOwner(pcb)) sync.unlock(mutex, pcb, system_time);
+}
+
+// Built from the scheduler's running totals, so reaped processes still count.
+SystemReport System::getReport() const {
+    const SchedulerStats& stats = scheduler.getStats();
+    SystemReport report;
+    report.processes = total_processes_created;
+    report.finished = static_cast<int>(stats.completed);
+    report.avg_turnaround = stats.turnaround.mean();
+    // Time spent READY; processes are otherwise running, doing I/O or blocked.
+    report.avg_waiting = stats.waiting.mean();
+    report.worst_lag = stats.worst_lag;
+    report.p95_turnaround = stats.turnaround.percentile(95);
+    report.p99_turnaround = stats.turnaround.percentile(99);
+    report.p99_response = stats.response.percentile(99);
+    report.instructions = stats.instructions;
+    report.page_faults = mmu.getPageFaults();
+    report.tlb_hits = mmu.getTlbHits();
+    report.tlb_misses = mmu.getTlbMisses();
+    report.context_switches = scheduler.getContextSwitches();
+    report.system_time = system_time;
+    return report;
+}
+
+int System::reapTerminated() {
+    std::vector<ProcessControlBlock*> zombies;
+    process_table.forEach([&](ProcessControlBlock& pcb) {
+        // A terminated mutex owner keeps its PCB: the mutex still points at it.
+        if (pcb.state == ProcessState::TERMINATED && !SyncManager::holdsLocks(pcb)) {
+            zombies.push_back(&pcb);
+        }
+    });
+    for (ProcessControlBlock* pcb : zombies) {
+        mmu.freeProcess(*pcb);
+        process_table.release(pcb->process_id);
     }
-    // This can be expanded to handle other commands in tests if needed
+    return static_cast<int>(zombies.size());
 }
 
-const std::map<int, ProcessControlBlock>& getProcessTable(const System& sys) {
+const PcbStore& getProcessTable(const System& sys) {
     return sys.process_table;
 }
\ No newline at end of file
@@ -3,63 +3,182 @@
 
 #include <map>
 #include <string>
+#include <iostream>
 #include "memory/virtual_memory/virtual_memory.hpp"
 #include "scheduler/scheduler.hpp"
-#include "core/mutex.hpp"
+#include "scheduler/pcb_store.hpp"
+#include "core/sync.hpp"
 
 
 
 std::string processStateToString(ProcessState state);
 
+struct BatchCommand;    // see cli/batch.hpp
+
+// Load control (see LoadController). While the fault rate of all processes is
+// at least `suspend_rate`, a process faulting at least as often is suspended
+// once its fault has been serviced, and its resident pages are given to the
+// others. Suspended processes resume while the rate is below `resume_rate`.
+// Each fault rate window (ResidentSetConfig::fault_window) changes at most one
+// process.
+struct LoadControlConfig {
+    bool enabled = false;
+    double suspend_rate = 0.5;
+    double resume_rate = 0.1;
+};
+
+// Construction parameters for a System. The defaults match the interactive simulator.
+struct SystemConfig {
+    SchedulingPolicy policy = SchedulingPolicy::ROUND_ROBIN;
+    int time_quantum = 4;
+    int cfs_target_latency = DEFAULT_CFS_TARGET_LATENCY;
+    int cfs_min_granularity = DEFAULT_CFS_MIN_GRANULARITY;
+    int memory_size = 128;
+    int page_size = 4;
+    ReplacementPolicy replacement = ReplacementPolicy::LRU;
+    TlbConfig tlb;
+    int cpus = 1;
+    int balance_interval = DEFAULT_BALANCE_INTERVAL;
+    ExecutionMode mode = ExecutionMode::TICK;
+    std::ostream* out = nullptr; // all console output of this instance; nullptr means std::cout
+    LogSink* log_sink = nullptr; // destination of subsystem log messages; nullptr means `out`
+    bool reap_terminated = false; // release terminated processes after every 'run'
+    FaultLatency fault_latency;  // ticks a process program waits for each page fault
+    int swap_slots = 0;          // 0: no swap; dirty victims are discarded
+    std::string swap_path;       // swap file; empty for anonymous memory
+    ReadaheadConfig readahead;
+    ResidentSetConfig resident_set;
+    LoadControlConfig load_control;
+};
+
+// End-of-run metrics used to compare configurations.
+struct SystemReport {
+    int processes = 0;
+    int finished = 0;
+    double avg_turnaround = 0.0;
+    double avg_waiting = 0.0;
+    int page_faults = 0;
+    long long tlb_hits = 0;
+    long long tlb_misses = 0;
+    long long context_switches = 0;
+    double worst_lag = 0.0;      // largest CFS service lag of any process
+    long long p95_turnaround = 0;
+    long long p99_turnaround = 0;
+    long long p99_response = 0;
+    long long instructions = 0;  // program instructions executed
+    int system_time = 0;
+};
 
-class System{
+
+class System : private SyncHost, private ProgramHost, private LoadController {
     public:
         System();
+        explicit System(const SystemConfig& config);
         void runCLI();
 
         void setLogLevel(LogLevel level);
+        // Route scheduler and MMU log messages to `sink` (nullptr: the console output).
+        void setLogSink(LogSink* sink);
 
-        const std::vector<ProcessControlBlock*>& getReadyQueue() const { return ready_queue; }
-        const std::vector<ProcessControlBlock*>& getWaitingQueue() const { return waiting_queue; }
+        const ReadyQueue& getReadyQueue() const { return *ready_queue; }
+        const TimerWheel& getWaitingQueue() const { return waiting_queue; }
         const VirtualMemoryManager& getMMU() const { return mmu; }
-        void runCLICommand(const std::string& command);
+        bool runCLICommand(const std::string& command);
+        // Execute an already decoded command. Returns false once the user asks to exit.
+        bool execute(const BatchCommand& command);
+        SystemReport getReport() const;
         void setSystemLogLevel(LogLevel level);
 
-        friend const std::map<int, ProcessControlBlock>& getProcessTable(const System& sys);
+        // Release the PCBs and memory of terminated processes. Returns how many were reaped.
+        int reapTerminated();
+
+        friend const PcbStore& getProcessTable(const System& sys);
     private:
+        std::ostream* out;
+        StreamSink out_sink;    // default log destination: the output stream
+        Logger logger;          // for messages raised while the scheduler runs
+
         // --- Core OS Components ---
         VirtualMemoryManager mmu;
         Scheduler scheduler;
 
         // --- Process Management ---
-        std::map<int, ProcessControlBlock> process_table;
+        PcbStore process_table;
         int next_pid;
         int system_time;
 
-        std::vector<ProcessControlBlock*> ready_queue;
-        std::vector<ProcessControlBlock*> waiting_queue;
+        std::unique_ptr<ReadyQueue> ready_queue;
+        TimerWheel waiting_queue;
 
 
         // --- Statistics Tracking ---
         int total_processes_created;
-        int total_turnaround_time;
-        int finished_process_count;
+        bool reap_terminated;
+        LoadControlConfig load_control;
+        long long load_window;  // fault rate window of the last suspension or resumption
 
         // --- Private CLI Helper Functions ---
-        void createProcess(int burst,int priority,int io_time,int io_freq);
+        ProcessControlBlock& createProcess(int burst,int priority,int io_time,int io_freq);
+        void forkProcess(int pid);
+        void runScheduler(int num_steps);
         void accessMemory(int pid,int vpn , AccessType type);
         void showStats();
         void showProcessList();
+        void changePolicy(SchedulingPolicy policy);
+        void configureLogSink(std::istringstream& args);
+        void configureTlb(std::istringstream& args);
+        void configureSwap(std::istringstream& args);
+        void configureFaultCost(std::istringstream& args);
+        void configureReadahead(std::istringstream& args);
+        void sharedMemory(std::istringstream& args);
+        void configureResidentSets(std::istringstream& args);
+        void configureLoadControl(std::istringstream& args);
+        void enableLoadControl(const LoadControlConfig& config);
+        void dumpLogRing();
+        void configureTrace(std::istringstream& args);
+        void stopTrace();
+        void trace(TraceEvent event, const ProcessControlBlock& pcb, int arg = 0);
         
-        void lockSharedResource(int pid);
-        void unlockSharedResource(int pid);
+        // --- Synchronization commands ---
+        ProcessControlBlock* findRunnable(int pid, const char* action);
+        void lockMutex(int pid, Mutex& mutex);
+        void unlockMutex(int pid, Mutex& mutex);
+        void configureMutex(std::istringstream& args);
+        void createSemaphore(std::istringstream& args);
+        void waitSemaphore(int pid, const std::string& name);
+        void signalSemaphore(const std::string& name);
+        void waitCondition(int pid, const std::string& cv_name, const std::string& mutex_name);
+        void signalCondition(const std::string& cv_name, bool broadcast);
+
+        // --- Process programs ---
+        void defineProgram(std::istringstream& args);
+        void spawnProgram(std::istringstream& args);
+
+        // ProgramHost: system calls made by running programs
+        int touch(ProcessControlBlock* pcb, int vpn, AccessType type) override;
+        bool lock(ProcessControlBlock* pcb, int index) override;
+        void unlock(ProcessControlBlock* pcb, int index) override;
+
+        // SyncHost: moves processes between the wait queues and the ready queue
+        void sleep(ProcessControlBlock* pcb) override;
+        void wake(ProcessControlBlock* pcb) override;
+        void setPriority(ProcessControlBlock* pcb, int priority) override;
+
+        // LoadController: suspends processes while memory is overcommitted
+        bool shouldSuspend(ProcessControlBlock* pcb) override;
+        bool shouldResume() override;
+
+        // Sink created by the 'logsink' command, if any
+        std::unique_ptr<LogSink> owned_log_sink;
+        // Recorder started by 'trace start', if any
+        std::unique_ptr<TraceRecorder> tracer;
 
         // --- Concurrency Simulation ---
-        Mutex shared_resource_mutex;
-        int shared_resource_value;
+        SyncManager sync;
+        Mutex& shared_mutex;    // the mutex 'lock <pid>' uses when no name is given
 
-
-        
+        // Programs defined with 'program', by name; never freed while processes may run them
+        std::map<std::string, std::unique_ptr<Program>> programs;
 };
 
 #endif
\ No newline at end of file
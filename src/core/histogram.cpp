@@ -0,0 +1,60 @@
+#include "histogram.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const int SUB_BUCKET_BITS = 5;
+static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+// Exact buckets for 0..31, then 32 buckets for each power of two from 2^5 to 2^62.
+static const int BUCKET_COUNT = SUB_BUCKETS + (62 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+LatencyHistogram::LatencyHistogram() : counts(BUCKET_COUNT, 0) {
+    clear();
+}
+
+void LatencyHistogram::clear() {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    total_sum = 0;
+    min_value = std::numeric_limits<long long>::max();
+    max_value = 0;
+}
+
+int LatencyHistogram::bucketOf(long long value) {
+    if (value < SUB_BUCKETS) return static_cast<int>(value);
+    int msb = 63 - __builtin_clzll(static_cast<unsigned long long>(value));
+    int shift = msb - SUB_BUCKET_BITS;
+    int sub = static_cast<int>(value >> shift) - SUB_BUCKETS;
+    return SUB_BUCKETS + shift * SUB_BUCKETS + sub;
+}
+
+long long LatencyHistogram::bucketUpperBound(int bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    int shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+    int sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+    long long lower = static_cast<long long>(SUB_BUCKETS + sub) << shift;
+    return lower + ((1LL << shift) - 1);
+}
+
+void LatencyHistogram::record(long long value) {
+    if (value < 0) value = 0;
+    counts[bucketOf(value)]++;
+    total++;
+    total_sum += value;
+    min_value = std::min(min_value, value);
+    max_value = std::max(max_value, value);
+}
+
+long long LatencyHistogram::percentile(double p) const {
+    if (total == 0) return 0;
+    p = std::min(100.0, std::max(0.0, p));
+    long long rank = static_cast<long long>(std::ceil(p / 100.0 * total));
+    if (rank < 1) rank = 1;
+    // Walk buckets from the low end; occupied ones are bounded by max_value.
+    long long seen = 0;
+    for (int bucket = 0, last = bucketOf(max_value); bucket <= last; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) return std::min(bucketUpperBound(bucket), max_value);
+    }
+    return max_value;
+}
@@ -0,0 +1,38 @@
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <vector>
+
+// Log-linear histogram of non-negative integer samples, in the style of
+// HdrHistogram. Values below 32 are counted exactly; above that every power of
+// two is split into 32 equal buckets, so a reported percentile is never more
+// than ~3% above the true sample. Recording and querying take constant time
+// and memory regardless of how many samples have been seen.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(long long value);      // negative values count as 0
+    void clear();
+
+    long long count() const { return total; }
+    long long sum() const { return total_sum; }
+    long long min() const { return total > 0 ? min_value : 0; }
+    long long max() const { return max_value; }
+    double mean() const { return total > 0 ? static_cast<double>(total_sum) / total : 0.0; }
+    // Smallest bucket bound such that `p` percent of the samples are at or below
+    // it (p in 0..100), capped at the largest sample. 0 when empty.
+    long long percentile(double p) const;
+
+private:
+    std::vector<long long> counts;
+    long long total;
+    long long total_sum;
+    long long min_value;
+    long long max_value;
+
+    static int bucketOf(long long value);
+    static long long bucketUpperBound(int bucket);
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include "logger.hpp"
+
+static const size_t FILE_SINK_BUFFER_SIZE = 1 << 16;
+
+// --- Sinks ---
+
+void StreamSink::write(LogLevel, const char* text, size_t length) {
+    os->write(text, static_cast<std::streamsize>(length));
+    os->put('\n');
+}
+
+FileSink::FileSink(const std::string& path) : buffer(FILE_SINK_BUFFER_SIZE) {
+    // The buffer has to be installed before the file is opened to take effect.
+    file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.open(path, std::ios::out | std::ios::app);
+}
+
+FileSink::~FileSink() {
+    file.flush();
+}
+
+void FileSink::write(LogLevel, const char* text, size_t length) {
+    file.write(text, static_cast<std::streamsize>(length));
+    file.put('\n');
+}
+
+RingSink::RingSink(size_t capacity)
+    : slots(capacity > 0 ? capacity : 1), next(0), count(0), overwritten(0) {}
+
+void RingSink::write(LogLevel, const char* text, size_t length) {
+    slots[next].assign(text, length);
+    next = (next + 1) % slots.size();
+    if (count < slots.size()) {
+        count++;
+    } else {
+        overwritten++;
+    }
+}
+
+std::vector<std::string> RingSink::lines() const {
+    std::vector<std::string> out;
+    out.reserve(count);
+    size_t start = (next + slots.size() - count) % slots.size();
+    for (size_t i = 0; i < count; ++i) {
+        out.push_back(slots[(start + i) % slots.size()]);
+    }
+    return out;
+}
+
+void RingSink::clear() {
+    next = 0;
+    count = 0;
+    overwritten = 0;
+}
+
+LogSink& stdoutSink() {
+    static StreamSink sink(std::cout);
+    return sink;
+}
+
+LogSink& nullSink() {
+    static NullSink sink;
+    return sink;
+}
+
+// --- Logger ---
+
+LineBuffer::int_type LineBuffer::overflow(int_type ch) {
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        text.push_back(traits_type::to_char_type(ch));
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize LineBuffer::xsputn(const char* s, std::streamsize n) {
+    text.append(s, static_cast<size_t>(n));
+    return n;
+}
+
+Logger::Logger(LogSink& sink, LogLevel level)
+    : target(&sink), current_level(level), discarding(sink.discards()), stream(&line) {}
+
+void Logger::setSink(LogSink& sink) {
+    target->flush();
+    target = &sink;
+    discarding = sink.discards();
+}
+
+void Logger::write(LogLevel level, const std::string& message) {
+    if (enabled(level)) {
+        target->write(level, message.data(), message.size());
+    }
+}
+
+std::ostream& Logger::begin() {
+    // Formatting flags set by one message must not leak into the next.
+    line.reset();
+    stream.clear();
+    stream.flags(std::ios::dec | std::ios::skipws);
+    stream.precision(6);
+    return stream;
+}
+
+void Logger::commit(LogLevel level) {
+    const std::string& text = line.str();
+    target->write(level, text.data(), text.size());
+}
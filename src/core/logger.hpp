@@ -0,0 +1,145 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "core/types.hpp"
+
+// Most verbose level compiled into the binary (0=NORMAL, 1=VERBOSE, 2=DEBUG).
+// Build with -DMOSKS_LOG_MAX_LEVEL=0 to strip VERBOSE and DEBUG messages entirely.
+#ifndef MOSKS_LOG_MAX_LEVEL
+#define MOSKS_LOG_MAX_LEVEL 2
+#endif
+
+// Log a message built with stream syntax, e.g.
+//     MOSKS_LOG(logger, VERBOSE, "Time " << t << ": P" << pid << " finished.");
+// The level is checked before any argument is evaluated, so a disabled message
+// costs one comparison, and nothing at all above MOSKS_LOG_MAX_LEVEL.
+#define MOSKS_LOG(logger, level, message)                                   \
+    do {                                                                    \
+        if ((level) <= MOSKS_LOG_MAX_LEVEL && (logger).enabled(level)) {    \
+            std::ostream& mosks_log_stream_ = (logger).begin();             \
+            mosks_log_stream_ << message;                                   \
+            (logger).commit(level);                                         \
+        }                                                                   \
+    } while (0)
+
+// Destination for formatted log messages. Sinks never flush per message.
+class LogSink {
+public:
+    virtual ~LogSink() = default;
+    // One complete message, without a trailing newline.
+    virtual void write(LogLevel level, const char* text, size_t length) = 0;
+    virtual void flush() {}
+    // True if messages are thrown away, so loggers can skip formatting them.
+    virtual bool discards() const { return false; }
+};
+
+// Writes to an ostream, one line per message. Output is left in the stream's
+// buffer; std::cout is still flushed before reading std::cin.
+class StreamSink : public LogSink {
+public:
+    explicit StreamSink(std::ostream& os) : os(&os) {}
+    void write(LogLevel level, const char* text, size_t length) override;
+    void flush() override { os->flush(); }
+    void setStream(std::ostream& stream) { os = &stream; }
+
+private:
+    std::ostream* os;
+};
+
+// Appends to a file through a 64 KiB buffer.
+class FileSink : public LogSink {
+public:
+    explicit FileSink(const std::string& path);
+    ~FileSink() override;
+    bool isOpen() const { return file.is_open(); }
+    void write(LogLevel level, const char* text, size_t length) override;
+    void flush() override { file.flush(); }
+
+private:
+    std::vector<char> buffer;
+    std::ofstream file;
+};
+
+// Keeps the most recent `capacity` messages in memory. Slots are reused, so a
+// full ring stops allocating once every slot has held a message of similar size.
+class RingSink : public LogSink {
+public:
+    explicit RingSink(size_t capacity);
+    void write(LogLevel level, const char* text, size_t length) override;
+
+    // Retained messages, oldest first.
+    std::vector<std::string> lines() const;
+    size_t size() const { return count; }
+    size_t capacity() const { return slots.size(); }
+    // Messages overwritten because the ring was full.
+    unsigned long long dropped() const { return overwritten; }
+    void clear();
+
+private:
+    std::vector<std::string> slots;
+    size_t next;
+    size_t count;
+    unsigned long long overwritten;
+};
+
+// Discards everything; loggers attached to it report every level as disabled.
+class NullSink : public LogSink {
+public:
+    void write(LogLevel, const char*, size_t) override {}
+    bool discards() const override { return true; }
+};
+
+// Shared sinks for std::cout and for discarding. Both are stateless apart from
+// the stream they wrap and can be used from any number of loggers.
+LogSink& stdoutSink();
+LogSink& nullSink();
+
+// Growable character buffer behind Logger's formatting stream. Clearing keeps
+// the capacity, so steady-state formatting does not allocate.
+class LineBuffer : public std::streambuf {
+public:
+    void reset() { text.clear(); }
+    const std::string& str() const { return text; }
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+private:
+    std::string text;
+};
+
+// Per-component logging front end: a verbosity level plus a non-owning sink.
+// Messages are formatted into a buffer owned by the logger and reused across
+// calls, so an enabled message does not allocate once the buffer has grown.
+class Logger {
+public:
+    explicit Logger(LogSink& sink = stdoutSink(), LogLevel level = NORMAL);
+
+    bool enabled(LogLevel level) const { return !discarding && level <= current_level; }
+    void setLevel(LogLevel level) { current_level = level; }
+    LogLevel level() const { return current_level; }
+    void setSink(LogSink& sink);
+    LogSink& sink() const { return *target; }
+
+    // Plain-string form for messages that are already built.
+    void write(LogLevel level, const std::string& message);
+
+    // Used by MOSKS_LOG: begin() hands out the cleared buffer, commit() sends it.
+    std::ostream& begin();
+    void commit(LogLevel level);
+
+private:
+    LogSink* target;
+    LogLevel current_level;
+    bool discarding;
+    LineBuffer line;
+    std::ostream stream;
+};
+
+#endif
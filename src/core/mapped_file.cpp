@@ -0,0 +1,47 @@
+#include "mapped_file.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const size_t READ_CHUNK = 1 << 20;
+
+MappedFile::~MappedFile() {
+    if (mapping != nullptr) munmap(mapping, length);
+}
+
+bool MappedFile::open(const std::string& path, std::string* error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* m = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED) {
+            madvise(m, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+            mapping = m;
+            begin = static_cast<const char*>(m);
+            length = static_cast<size_t>(st.st_size);
+            ::close(fd);
+            return true;
+        }
+    }
+    // Pipes and the like cannot be mapped: read everything in large chunks.
+    ssize_t n;
+    do {
+        size_t used = buffer.size();
+        buffer.resize(used + READ_CHUNK);
+        n = ::read(fd, buffer.data() + used, READ_CHUNK);
+        buffer.resize(used + (n > 0 ? static_cast<size_t>(n) : 0));
+    } while (n > 0);
+    ::close(fd);
+    if (n < 0) {
+        if (error) *error = "cannot read " + path;
+        return false;
+    }
+    begin = buffer.data();
+    length = buffer.size();
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file: mmap'd when possible, otherwise read into
+// memory with large reads.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path, std::string* error = nullptr);
+    const char* data() const { return begin; }
+    size_t size() const { return length; }
+
+private:
+    const char* begin = nullptr;
+    size_t length = 0;
+    void* mapping = nullptr;
+    std::vector<char> buffer;
+};
+
+#endif
@@ -1,34 +1,75 @@
 #include "mutex.hpp"
+#include <algorithm>
+#include <utility>
 
+Mutex::Mutex(std::string name, bool priority_inheritance)
+    : next_held(nullptr),
+      label(std::move(name)),
+      priority_inheritance(priority_inheritance),
+      owner(nullptr),
+      acquired_at(0) {}
 
-bool Mutex::lock(ProcessControlBlock* pcb){
-    if(!locked){
+// Make `pcb` the owner and link this mutex into its held list.
+void Mutex::acquire(ProcessControlBlock* pcb, int now) {
+    owner = pcb;
+    acquired_at = now;
+    next_held = pcb->held_locks;
+    pcb->held_locks = this;
+    stats.acquisitions++;
+}
+
+// Unlink this mutex from the owner's held list and account the hold time.
+void Mutex::release(int now) {
+    Mutex** link = &owner->held_locks;
+    while (*link != this) link = &(*link)->next_held;
+    *link = next_held;
+    next_held = nullptr;
+    int held = now - acquired_at;
+    stats.total_hold += held;
+    stats.max_hold = std::max(stats.max_hold, held);
+    owner = nullptr;
+}
+
+bool Mutex::lock(ProcessControlBlock* pcb, int now){
+    if(owner == nullptr){
         // if not locked, acquire it
-        locked = true;
-        owner = pcb;
+        acquire(pcb, now);
         return true;
     } else {
         pcb->state = ProcessState::BLOCKED_ON_MUTEX;
-        waiting_processes.push_back(pcb);
+        pcb->blocked_on = this;
+        pcb->blocked_since = now;
+        waiters.push(pcb);
+        waiter_priorities.insert(pcb->priority);
         return false;
     }
 }
 
-ProcessControlBlock* Mutex::unlock(ProcessControlBlock* pcb){
-    if(!locked || owner != pcb){
+ProcessControlBlock* Mutex::unlock(ProcessControlBlock* pcb, int now){
+    if(owner == nullptr || owner != pcb){
         return nullptr;
     }
+    release(now);
 
-    if(!waiting_processes.empty()){
-        ProcessControlBlock* next_pcb = waiting_processes.front();
-        waiting_processes.erase(waiting_processes.begin());
-
-        next_pcb->state = ProcessState::READY;
-        owner = next_pcb;
-        return next_pcb;
-    } else {
-        locked = false;
-        owner = nullptr;
+    ProcessControlBlock* next_pcb = waiters.pop();
+    if(next_pcb == nullptr){
         return nullptr;
     }
-}
\ No newline at end of file
+    waiter_priorities.erase(waiter_priorities.find(next_pcb->priority));
+    next_pcb->blocked_on = nullptr;
+    int waited = now - next_pcb->blocked_since;
+    stats.contended++;
+    stats.total_wait += waited;
+    stats.max_wait = std::max(stats.max_wait, waited);
+    acquire(next_pcb, now);
+    return next_pcb;
+}
+
+int Mutex::topWaiterPriority(int fallback) const {
+    return waiter_priorities.empty() ? fallback : *waiter_priorities.begin();
+}
+
+void Mutex::requeueWaiter(const ProcessControlBlock* pcb, int priority) {
+    waiter_priorities.erase(waiter_priorities.find(pcb->priority));
+    waiter_priorities.insert(priority);
+}
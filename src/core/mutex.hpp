@@ -1,20 +1,65 @@
 #ifndef MUTEX_HPP
 #define MUTEX_HPP
 
-#include <vector>
+#include <cstddef>
+#include <set>
+#include <string>
+#include "wait_queue.hpp"
 #include "../scheduler/pcb.hpp"
 
+// Contention counters of one synchronization object, in simulated ticks.
+struct LockStats {
+    long long acquisitions = 0;     // successful lock / wait operations
+    long long contended = 0;        // ... of which had to sleep first
+    long long total_wait = 0;
+    int max_wait = 0;
+    long long total_hold = 0;       // mutexes only
+    int max_hold = 0;
+};
+
+// Sleeping mutex with FIFO handoff: unlock() passes ownership straight to the
+// longest waiter. With priority inheritance enabled the mutex also tracks the
+// priorities of its waiters, so the owner can be boosted to the best of them
+// (see SyncManager).
 class Mutex {
     public:
-        Mutex() : locked(false), owner(nullptr) {}
+        explicit Mutex(std::string name = "mutex", bool priority_inheritance = false);
+
+        // Acquire for `pcb`, or queue it as BLOCKED_ON_MUTEX. Returns true if acquired.
+        bool lock(ProcessControlBlock* pcb, int now = 0);
+        // Release if `pcb` is the owner. Returns the waiter that now owns the mutex
+        // (its state is left for the caller to set), or nullptr.
+        ProcessControlBlock* unlock(ProcessControlBlock* pcb, int now = 0);
+
+        bool isLocked() const { return owner != nullptr; }
+        bool isOwner(const ProcessControlBlock* pcb) const { return owner == pcb; }
+        ProcessControlBlock* getOwner() const { return owner; }
+        size_t waiterCount() const { return waiters.size(); }
 
-        bool lock(ProcessControlBlock* pcb);
-        ProcessControlBlock* unlock(ProcessControlBlock* pcb);
+        const std::string& name() const { return label; }
+        bool inheritsPriority() const { return priority_inheritance; }
+        void setPriorityInheritance(bool enabled) { priority_inheritance = enabled; }
+        // Best (lowest) priority among the waiters; `fallback` if there are none.
+        int topWaiterPriority(int fallback) const;
+        // Record that the queued `pcb` is about to change priority to `priority`.
+        void requeueWaiter(const ProcessControlBlock* pcb, int priority);
+
+        const LockStats& getStats() const { return stats; }
+
+        // Next mutex held by the same owner (see ProcessControlBlock::held_locks).
+        Mutex* next_held;
 
     private:
-        bool locked;
+        std::string label;
+        bool priority_inheritance;
         ProcessControlBlock* owner;
-        std::vector<ProcessControlBlock*> waiting_processes;
+        int acquired_at;
+        WaitQueue waiters;
+        std::multiset<int> waiter_priorities;
+        LockStats stats;
+
+        void acquire(ProcessControlBlock* pcb, int now);
+        void release(int now);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,221 @@
+#include "sync.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <utility>
+
+// Fold the wait of a process woken at `now` into `stats`.
+static void recordWait(LockStats& stats, const ProcessControlBlock* pcb, int now) {
+    int waited = now - pcb->blocked_since;
+    stats.contended++;
+    stats.total_wait += waited;
+    stats.max_wait = std::max(stats.max_wait, waited);
+}
+
+// --- Semaphore ---
+
+Semaphore::Semaphore(std::string name, int count) : label(std::move(name)), count(count) {}
+
+bool Semaphore::wait(ProcessControlBlock* pcb, int now) {
+    if (count > 0) {
+        count--;
+        stats.acquisitions++;
+        return true;
+    }
+    pcb->state = ProcessState::BLOCKED_ON_MUTEX;
+    pcb->blocked_since = now;
+    waiters.push(pcb);
+    return false;
+}
+
+ProcessControlBlock* Semaphore::signal(int now) {
+    ProcessControlBlock* pcb = waiters.pop();
+    if (pcb == nullptr) {
+        count++;
+        return nullptr;
+    }
+    stats.acquisitions++;
+    recordWait(stats, pcb, now);
+    return pcb;
+}
+
+// --- ConditionVariable ---
+
+ConditionVariable::ConditionVariable(std::string name) : label(std::move(name)), bound(nullptr) {}
+
+void ConditionVariable::wait(ProcessControlBlock* pcb, Mutex& mutex, int now) {
+    bound = &mutex;
+    pcb->state = ProcessState::BLOCKED_ON_MUTEX;
+    pcb->blocked_since = now;
+    waiters.push(pcb);
+}
+
+ProcessControlBlock* ConditionVariable::wake(int now) {
+    ProcessControlBlock* pcb = waiters.pop();
+    if (pcb == nullptr) return nullptr;
+    if (waiters.empty()) bound = nullptr;
+    stats.acquisitions++;
+    recordWait(stats, pcb, now);
+    return pcb;
+}
+
+// --- SyncManager ---
+
+SyncManager::SyncManager(SyncHost& host) : host(host), blocked(0) {}
+
+Mutex& SyncManager::mutex(const std::string& name) {
+    std::unique_ptr<Mutex>& slot = mutexes[name];
+    if (!slot) slot.reset(new Mutex(name));
+    return *slot;
+}
+
+Semaphore& SyncManager::semaphore(const std::string& name, int count) {
+    std::unique_ptr<Semaphore>& slot = semaphores[name];
+    if (!slot) slot.reset(new Semaphore(name, count));
+    return *slot;
+}
+
+ConditionVariable& SyncManager::conditionVariable(const std::string& name) {
+    std::unique_ptr<ConditionVariable>& slot = condition_variables[name];
+    if (!slot) slot.reset(new ConditionVariable(name));
+    return *slot;
+}
+
+Mutex* SyncManager::findMutex(const std::string& name) {
+    auto it = mutexes.find(name);
+    return it != mutexes.end() ? it->second.get() : nullptr;
+}
+
+Semaphore* SyncManager::findSemaphore(const std::string& name) {
+    auto it = semaphores.find(name);
+    return it != semaphores.end() ? it->second.get() : nullptr;
+}
+
+void SyncManager::setPriorityInheritance(Mutex& mutex, bool enabled) {
+    mutex.setPriorityInheritance(enabled);
+    if (mutex.isLocked()) refreshPriority(mutex.getOwner());
+}
+
+void SyncManager::sleep(ProcessControlBlock* pcb) {
+    blocked++;
+    host.sleep(pcb);
+}
+
+void SyncManager::wake(ProcessControlBlock* pcb) {
+    blocked--;
+    host.wake(pcb);
+}
+
+bool SyncManager::lock(Mutex& mutex, ProcessControlBlock* pcb, int now) {
+    if (mutex.lock(pcb, now)) return true;
+    sleep(pcb);
+    if (mutex.inheritsPriority()) refreshPriority(mutex.getOwner());
+    return false;
+}
+
+ProcessControlBlock* SyncManager::unlock(Mutex& mutex, ProcessControlBlock* pcb, int now) {
+    ProcessControlBlock* next = mutex.unlock(pcb, now);
+    // The old owner may lose its boost and the new one may gain one from the
+    // waiters it now stands in front of.
+    refreshPriority(pcb);
+    if (next != nullptr) {
+        wake(next);
+        refreshPriority(next);
+    }
+    return next;
+}
+
+bool SyncManager::wait(Semaphore& semaphore, ProcessControlBlock* pcb, int now) {
+    if (semaphore.wait(pcb, now)) return true;
+    sleep(pcb);
+    return false;
+}
+
+ProcessControlBlock* SyncManager::signal(Semaphore& semaphore, int now) {
+    ProcessControlBlock* pcb = semaphore.signal(now);
+    if (pcb != nullptr) wake(pcb);
+    return pcb;
+}
+
+void SyncManager::wait(ConditionVariable& cv, Mutex& mutex, ProcessControlBlock* pcb, int now) {
+    cv.wait(pcb, mutex, now);
+    sleep(pcb);
+    unlock(mutex, pcb, now);
+}
+
+size_t SyncManager::signal(ConditionVariable& cv, int now, bool broadcast) {
+    size_t woken = 0;
+    while (Mutex* mutex = cv.boundMutex()) {
+        ProcessControlBlock* pcb = cv.wake(now);
+        woken++;
+        // Mutex::lock() restarts blocked_since, so time spent queued on the mutex
+        // is charged to the mutex rather than to the condition variable.
+        if (mutex->lock(pcb, now)) {
+            wake(pcb);
+        } else if (mutex->inheritsPriority()) {
+            refreshPriority(mutex->getOwner());
+        }
+        if (!broadcast) break;
+    }
+    return woken;
+}
+
+void SyncManager::refreshPriority(ProcessControlBlock* pcb) {
+    while (pcb != nullptr) {
+        int effective = pcb->base_priority;
+        for (const Mutex* held = pcb->held_locks; held != nullptr; held = held->next_held) {
+            if (held->inheritsPriority()) effective = std::min(effective, held->topWaiterPriority(effective));
+        }
+        if (effective == pcb->priority) return;
+        Mutex* waiting_on = pcb->blocked_on;
+        if (waiting_on != nullptr) waiting_on->requeueWaiter(pcb, effective);
+        host.setPriority(pcb, effective);
+        // Pass the change on to the owner this process is queued behind.
+        pcb = (waiting_on != nullptr && waiting_on->inheritsPriority()) ? waiting_on->getOwner() : nullptr;
+    }
+}
+
+// `avg_hold` is negative for objects without an owner.
+static void printStatsRow(std::ostream& os, const std::string& name, const char* type, const LockStats& stats,
+                          long long avg_hold, const std::string& state, size_t waiters) {
+    os << std::left << std::setw(12) << name << std::setw(7) << type
+       << std::right << std::setw(6) << stats.acquisitions << std::setw(7) << stats.contended
+       << std::setw(9) << stats.total_wait / std::max(stats.contended, 1LL) << std::setw(9) << stats.max_wait;
+    if (avg_hold >= 0) {
+        os << std::setw(9) << avg_hold << std::setw(9) << stats.max_hold;
+    } else {
+        os << std::setw(9) << "-" << std::setw(9) << "-";
+    }
+    os << "  " << std::left << std::setw(10) << state << waiters << "\n";
+}
+
+void SyncManager::display(std::ostream& os) const {
+    os << "--- Synchronization Objects ---\n";
+    if (mutexes.empty() && semaphores.empty() && condition_variables.empty()) {
+        os << "(No locks in use)\n";
+        return;
+    }
+    os << std::left << std::setw(12) << "Name" << std::setw(7) << "Type"
+       << std::right << std::setw(6) << "Acq" << std::setw(7) << "Cont"
+       << std::setw(9) << "AvgWait" << std::setw(9) << "MaxWait"
+       << std::setw(9) << "AvgHold" << std::setw(9) << "MaxHold"
+       << "  " << std::left << std::setw(10) << "State" << "Waiters\n";
+    for (const auto& entry : mutexes) {
+        const Mutex& m = *entry.second;
+        const LockStats& stats = m.getStats();
+        long long releases = stats.acquisitions - (m.isLocked() ? 1 : 0);
+        std::string state = m.isLocked() ? "P" + std::to_string(m.getOwner()->process_id) : "free";
+        printStatsRow(os, m.name(), m.inheritsPriority() ? "mutex*" : "mutex", stats,
+                      stats.total_hold / std::max(releases, 1LL), state, m.waiterCount());
+    }
+    for (const auto& entry : semaphores) {
+        const Semaphore& s = *entry.second;
+        printStatsRow(os, s.name(), "sem", s.getStats(), -1, "value " + std::to_string(s.value()),
+                      s.waiterCount());
+    }
+    for (const auto& entry : condition_variables) {
+        const ConditionVariable& cv = *entry.second;
+        std::string state = cv.boundMutex() != nullptr ? "on " + cv.boundMutex()->name() : "-";
+        printStatsRow(os, cv.name(), "cond", cv.getStats(), -1, state, cv.waiterCount());
+    }
+    os << "(mutex* = priority inheritance; times in ticks; averages over contended waits and releases)\n";
+}
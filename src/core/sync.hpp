@@ -0,0 +1,125 @@
+#ifndef SYNC_HPP
+#define SYNC_HPP
+
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include "mutex.hpp"
+#include "wait_queue.hpp"
+
+// Counting semaphore. signal() hands its unit straight to the longest waiter,
+// so a woken process never has to compete for it again.
+class Semaphore {
+public:
+    Semaphore(std::string name, int count);
+
+    // Take a unit for `pcb`, or queue it as BLOCKED_ON_MUTEX. Returns true if taken.
+    bool wait(ProcessControlBlock* pcb, int now);
+    // Give a unit to the longest waiter and return it, or bank the unit and return nullptr.
+    ProcessControlBlock* signal(int now);
+
+    int value() const { return count; }
+    size_t waiterCount() const { return waiters.size(); }
+    const std::string& name() const { return label; }
+    const LockStats& getStats() const { return stats; }
+
+private:
+    std::string label;
+    int count;
+    WaitQueue waiters;
+    LockStats stats;
+};
+
+// Condition variable. While it has waiters it is bound to the mutex they
+// released, and every waiter reacquires that mutex when it is signalled.
+class ConditionVariable {
+public:
+    explicit ConditionVariable(std::string name);
+
+    // Queue `pcb`, which has just released `mutex`.
+    void wait(ProcessControlBlock* pcb, Mutex& mutex, int now);
+    // Dequeue the longest waiter, or nullptr. The caller moves it on to the mutex.
+    ProcessControlBlock* wake(int now);
+
+    Mutex* boundMutex() const { return bound; }
+    size_t waiterCount() const { return waiters.size(); }
+    const std::string& name() const { return label; }
+    const LockStats& getStats() const { return stats; }
+
+private:
+    std::string label;
+    Mutex* bound;
+    WaitQueue waiters;
+    LockStats stats;
+};
+
+// What the synchronization layer needs from the process manager.
+class SyncHost {
+public:
+    virtual ~SyncHost() = default;
+    // A runnable process went to sleep on a wait queue: take it off the run queue.
+    virtual void sleep(ProcessControlBlock* pcb) = 0;
+    // A sleeping process may run again.
+    virtual void wake(ProcessControlBlock* pcb) = 0;
+    // Set the effective priority of a process, re-sorting it if it is queued.
+    virtual void setPriority(ProcessControlBlock* pcb, int priority) = 0;
+};
+
+// Named mutexes, semaphores and condition variables of one System. Objects are
+// created on first use and live as long as the manager, so references stay valid.
+//
+// Priority inheritance: a process that owns inheriting mutexes runs at the best
+// priority of its own base priority and every process queued on them. The boost
+// is applied when a waiter arrives and follows the chain of owners that are
+// themselves blocked on inheriting mutexes; it is recomputed when a mutex
+// changes hands. Lower priority values are more important, as in the scheduler.
+class SyncManager {
+public:
+    explicit SyncManager(SyncHost& host);
+
+    Mutex& mutex(const std::string& name);
+    Semaphore& semaphore(const std::string& name, int count);
+    ConditionVariable& conditionVariable(const std::string& name);
+    Mutex* findMutex(const std::string& name);
+    // Switching inheritance on or off re-evaluates the current owner right away.
+    void setPriorityInheritance(Mutex& mutex, bool enabled);
+    Semaphore* findSemaphore(const std::string& name);
+
+    // The caller must be runnable and must not already own the mutex.
+    // Returns true if acquired, false if the process went to sleep.
+    bool lock(Mutex& mutex, ProcessControlBlock* pcb, int now);
+    // The caller must own the mutex. Returns the waiter it was handed to, or nullptr.
+    ProcessControlBlock* unlock(Mutex& mutex, ProcessControlBlock* pcb, int now);
+
+    bool wait(Semaphore& semaphore, ProcessControlBlock* pcb, int now);
+    ProcessControlBlock* signal(Semaphore& semaphore, int now);
+
+    // Release `mutex` (which the caller must own) and sleep on `cv` in one step.
+    void wait(ConditionVariable& cv, Mutex& mutex, ProcessControlBlock* pcb, int now);
+    // Wake one waiter, or all of them. Returns how many were woken; each then
+    // either reacquires the mutex or queues on it.
+    size_t signal(ConditionVariable& cv, int now, bool broadcast = false);
+
+    static bool holdsLocks(const ProcessControlBlock& pcb) { return pcb.held_locks != nullptr; }
+    // Processes asleep on any wait queue.
+    long long blockedCount() const { return blocked; }
+
+    // Per-object contention table for the 'locks' command.
+    void display(std::ostream& os) const;
+
+private:
+    SyncHost& host;
+    std::map<std::string, std::unique_ptr<Mutex>> mutexes;
+    std::map<std::string, std::unique_ptr<Semaphore>> semaphores;
+    std::map<std::string, std::unique_ptr<ConditionVariable>> condition_variables;
+    long long blocked;
+
+    void sleep(ProcessControlBlock* pcb);
+    void wake(ProcessControlBlock* pcb);
+    // Recompute the effective priority of `pcb` and of the owners it is waiting behind.
+    void refreshPriority(ProcessControlBlock* pcb);
+};
+
+#endif
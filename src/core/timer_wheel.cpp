@@ -0,0 +1,211 @@
+#include "timer_wheel.hpp"
+#include <algorithm>
+#include <climits>
+
+static int lowestBit(uint64_t mask) { return __builtin_ctzll(mask); }
+
+// Bits of the occupancy mask strictly above `index`.
+static uint64_t maskAbove(int index) {
+    return (index >= 63) ? 0 : (~0ULL << (index + 1));
+}
+
+TimerWheel::TimerWheel(int start_time)
+    : current_time(start_time), pending(0), next_seq(0)
+{
+    for (auto& level : heads) {
+        std::fill(level, level + SLOTS, -1);
+    }
+    std::fill(occupied, occupied + LEVELS, 0);
+}
+
+int TimerWheel::schedule(ProcessControlBlock* pcb, int wake_time, WakeReason reason) {
+    int id;
+    if (!free_timers.empty()) {
+        id = free_timers.back();
+        free_timers.pop_back();
+    } else {
+        id = static_cast<int>(timers.size());
+        timers.push_back(Timer());
+    }
+    Timer& t = timers[id];
+    t.wake_time = wake_time;
+    t.seq = next_seq++;
+    t.pcb = pcb;
+    t.reason = reason;
+    t.armed = true;
+    place(id);
+    pending++;
+    return id;
+}
+
+bool TimerWheel::cancel(int handle) {
+    if (handle < 0 || handle >= static_cast<int>(timers.size()) || !timers[handle].armed) {
+        return false;
+    }
+    unlink(handle);
+    timers[handle].armed = false;
+    free_timers.push_back(handle);
+    pending--;
+    return true;
+}
+
+// Pick the list for a timer relative to the current time: the lowest level on
+// which the wake time and the current time agree in every higher slot index.
+void TimerWheel::place(int id) {
+    int wake = timers[id].wake_time;
+    if (wake <= current_time) {
+        link(id, DUE_LIST, 0);
+        return;
+    }
+    unsigned int diff = static_cast<unsigned int>(wake) ^ static_cast<unsigned int>(current_time);
+    for (int level = 0; level < LEVELS; ++level) {
+        if ((diff >> (LEVEL_BITS * (level + 1))) == 0) {
+            link(id, level, (wake >> (LEVEL_BITS * level)) & (SLOTS - 1));
+            return;
+        }
+    }
+    link(id, OVERFLOW_LIST, 0);
+}
+
+// Slots are doubly linked lists appended at the tail so that timers sharing a
+// slot stay in scheduling order; the head's prev points at the tail.
+void TimerWheel::link(int id, int level, int slot) {
+    Timer& t = timers[id];
+    t.level = level;
+    t.slot = slot;
+    int& head = heads[level][slot];
+    if (head == -1) {
+        head = id;
+        t.prev = id;
+        t.next = -1;
+        if (level < LEVELS) occupied[level] |= (1ULL << slot);
+    } else {
+        int tail = timers[head].prev;
+        timers[tail].next = id;
+        t.prev = tail;
+        t.next = -1;
+        timers[head].prev = id;
+    }
+}
+
+void TimerWheel::unlink(int id) {
+    Timer& t = timers[id];
+    int& head = heads[t.level][t.slot];
+    if (head == id) {
+        head = t.next;
+        if (head != -1) timers[head].prev = t.prev;
+    } else {
+        timers[t.prev].next = t.next;
+        if (t.next != -1) timers[t.next].prev = t.prev;
+        else timers[head].prev = t.prev;
+    }
+    if (head == -1 && t.level < LEVELS) occupied[t.level] &= ~(1ULL << t.slot);
+}
+
+void TimerWheel::drain(int level, int slot, std::vector<int>& out) {
+    int id = heads[level][slot];
+    while (id != -1) {
+        int next = timers[id].next;
+        out.push_back(id);
+        id = next;
+    }
+    heads[level][slot] = -1;
+    if (level < LEVELS) occupied[level] &= ~(1ULL << slot);
+}
+
+// Earliest time after the current one at which some list has to be fired or
+// cascaded. Lower levels always come first: their slots lie inside the current
+// slot of every level above them.
+int TimerWheel::nextBoundary(int* level, int* slot) const {
+    for (int l = 0; l < LEVELS; ++l) {
+        int shift = LEVEL_BITS * l;
+        int index = (current_time >> shift) & (SLOTS - 1);
+        uint64_t ahead = occupied[l] & maskAbove(index);
+        if (ahead != 0) {
+            int s = lowestBit(ahead);
+            long long block = (static_cast<long long>(current_time) >> (shift + LEVEL_BITS)) << (shift + LEVEL_BITS);
+            *level = l;
+            *slot = s;
+            return static_cast<int>(block | (static_cast<long long>(s) << shift));
+        }
+    }
+    if (heads[OVERFLOW_LIST][0] != -1) {
+        int shift = LEVEL_BITS * LEVELS;
+        long long next_block = ((static_cast<long long>(current_time) >> shift) + 1) << shift;
+        *level = OVERFLOW_LIST;
+        *slot = 0;
+        return next_block > INT_MAX ? INT_MAX : static_cast<int>(next_block);
+    }
+    return INT_MAX;
+}
+
+void TimerWheel::advance(int now, std::vector<WakeEvent>& fired) {
+    std::vector<int> batch;
+    drain(DUE_LIST, 0, batch);
+
+    while (true) {
+        int level = 0, slot = 0;
+        int boundary = nextBoundary(&level, &slot);
+        if (boundary > now || boundary == INT_MAX) {
+            if (now > current_time) current_time = now;
+            break;
+        }
+        current_time = boundary;
+
+        // Re-place everything on the list that was reached. Timers due now land on
+        // the due list; the rest drop to a lower level.
+        std::vector<int> moved;
+        drain(level, slot, moved);
+        for (int id : moved) place(id);
+        drain(DUE_LIST, 0, batch);
+    }
+
+    std::sort(batch.begin(), batch.end(), [this](int a, int b) {
+        if (timers[a].wake_time != timers[b].wake_time) return timers[a].wake_time < timers[b].wake_time;
+        return timers[a].seq < timers[b].seq;
+    });
+    for (int id : batch) {
+        Timer& t = timers[id];
+        fired.push_back({t.pcb, t.wake_time, t.reason});
+        t.armed = false;
+        free_timers.push_back(id);
+        pending--;
+    }
+}
+
+int TimerWheel::earliestIn(int level, int slot) const {
+    int earliest = INT_MAX;
+    for (int id = heads[level][slot]; id != -1; id = timers[id].next) {
+        earliest = std::min(earliest, timers[id].wake_time);
+    }
+    return earliest;
+}
+
+int TimerWheel::nextExpiry() const {
+    if (heads[DUE_LIST][0] != -1) {
+        return earliestIn(DUE_LIST, 0);
+    }
+    int level = 0, slot = 0;
+    int boundary = nextBoundary(&level, &slot);
+    if (boundary == INT_MAX && heads[OVERFLOW_LIST][0] == -1) {
+        return -1;
+    }
+    // A level-0 slot holds exactly one wake time; higher slots and the overflow
+    // list span many, so look inside for the earliest.
+    return (level == 0) ? boundary : earliestIn(level, slot);
+}
+
+std::vector<WakeEvent> TimerWheel::snapshot() const {
+    std::vector<const Timer*> armed;
+    for (const auto& t : timers) {
+        if (t.armed) armed.push_back(&t);
+    }
+    std::sort(armed.begin(), armed.end(), [](const Timer* a, const Timer* b) {
+        if (a->wake_time != b->wake_time) return a->wake_time < b->wake_time;
+        return a->seq < b->seq;
+    });
+    std::vector<WakeEvent> out;
+    out.reserve(armed.size());
+    for (const Timer* t : armed) out.push_back({t->pcb, t->wake_time, t->reason});
+    return out;
+}
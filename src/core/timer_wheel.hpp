@@ -0,0 +1,87 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "scheduler/pcb.hpp"
+
+// Why a sleeping process was parked on the wheel.
+enum class WakeReason {
+    IO,
+    PAGE_FAULT,
+    DISK,
+    SLEEP
+};
+
+struct WakeEvent {
+    ProcessControlBlock* pcb;
+    int time;
+    WakeReason reason;
+};
+
+// Hierarchical timer wheel keyed on absolute wake-up time.
+//
+// Level L has 64 slots of 64^L ticks each; a timer lives on the lowest level whose
+// slot span still separates it from the current time, and is cascaded one level
+// down when the wheel reaches its slot. Timers beyond the top level wait on an
+// overflow list. Advancing the clock only touches slots that are occupied, so the
+// cost is proportional to the number of timers that fire or cascade, not to the
+// number of timers pending or ticks elapsed.
+class TimerWheel {
+public:
+    explicit TimerWheel(int start_time = 0);
+
+    // Arm a wake-up for `pcb` at absolute time `wake_time`. Returns a handle for cancel().
+    int schedule(ProcessControlBlock* pcb, int wake_time, WakeReason reason = WakeReason::IO);
+    // Disarm a pending wake-up. Returns false if it already fired or was cancelled.
+    bool cancel(int handle);
+
+    // Move the wheel clock forward to `now` and append every timer due by then to
+    // `fired`, ordered by wake time and then by the order they were scheduled.
+    void advance(int now, std::vector<WakeEvent>& fired);
+
+    // Earliest pending wake time, or -1 if nothing is pending.
+    int nextExpiry() const;
+
+    int now() const { return current_time; }
+    size_t size() const { return pending; }
+    bool empty() const { return pending == 0; }
+
+    // Pending wake-ups ordered by wake time (for display only).
+    std::vector<WakeEvent> snapshot() const;
+
+private:
+    static const int LEVEL_BITS = 6;
+    static const int SLOTS = 1 << LEVEL_BITS;
+    static const int LEVELS = 4;
+    static const int OVERFLOW_LIST = LEVELS;     // list index for timers past the top level
+    static const int DUE_LIST = LEVELS + 1;      // list index for timers already due
+
+    struct Timer {
+        int wake_time;
+        long long seq;
+        ProcessControlBlock* pcb;
+        WakeReason reason;
+        int prev, next;
+        int level, slot;
+        bool armed;
+    };
+
+    std::vector<Timer> timers;
+    std::vector<int> free_timers;
+    int heads[LEVELS + 2][SLOTS];
+    uint64_t occupied[LEVELS];
+    int current_time;
+    size_t pending;
+    long long next_seq;
+
+    void place(int id);
+    void link(int id, int level, int slot);
+    void unlink(int id);
+    void drain(int level, int slot, std::vector<int>& out);
+    int nextBoundary(int* level, int* slot) const;
+    int earliestIn(int level, int slot) const;
+};
+
+#endif
@@ -0,0 +1,245 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+static const char TRACE_MAGIC[8] = {'M', 'O', 'S', 'K', 'T', 'R', 'C', '1'};
+static const size_t TRACE_WRITE_BATCH = 4096;
+
+const char* traceEventToString(TraceEvent event) {
+    switch (event) {
+        case TraceEvent::ADMIT: return "ADMIT";
+        case TraceEvent::DISPATCH: return "DISPATCH";
+        case TraceEvent::PREEMPT: return "PREEMPT";
+        case TraceEvent::PAUSE: return "PAUSE";
+        case TraceEvent::IO_BLOCK: return "IO_BLOCK";
+        case TraceEvent::WAKE: return "WAKE";
+        case TraceEvent::TERMINATE: return "TERMINATE";
+        case TraceEvent::MIGRATE: return "MIGRATE";
+        case TraceEvent::BLOCK: return "BLOCK";
+        case TraceEvent::UNBLOCK: return "UNBLOCK";
+        case TraceEvent::SUSPEND: return "SUSPEND";
+        case TraceEvent::RESUME: return "RESUME";
+    }
+    return "UNKNOWN";
+}
+
+// --- TraceRing ---
+
+TraceRing::TraceRing(size_t capacity) : head(0), tail(0) {
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    slots.resize(size);
+    mask = size - 1;
+}
+
+bool TraceRing::push(const TraceRecord& record) {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == slots.size()) return false;
+    slots[h & mask] = record;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+size_t TraceRing::pop(TraceRecord* out, size_t max) {
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    uint64_t available = head.load(std::memory_order_acquire) - t;
+    size_t n = static_cast<size_t>(std::min<uint64_t>(available, max));
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = slots[(t + i) & mask];
+    }
+    tail.store(t + n, std::memory_order_release);
+    return n;
+}
+
+// --- TraceRecorder ---
+
+TraceRecorder::TraceRecorder(const std::string& path, size_t ring_capacity, bool background_writer)
+    : ring(ring_capacity), file(std::fopen(path.c_str(), "wb")), stopping(false), count(0)
+{
+    if (file == nullptr) return;
+    TraceFileHeader header;
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.record_size = sizeof(TraceRecord);
+    header.reserved = 0;
+    std::fwrite(&header, sizeof(header), 1, file);
+    if (background_writer) {
+        writer = std::thread(&TraceRecorder::writerLoop, this);
+    }
+}
+
+TraceRecorder::~TraceRecorder() {
+    close();
+}
+
+void TraceRecorder::record(TraceEvent event, int time, int pid, int cpu, int arg, uint8_t reason) {
+    if (file == nullptr) return;
+    TraceRecord rec;
+    rec.time = time;
+    rec.pid = pid;
+    rec.arg = arg;
+    rec.cpu = static_cast<int16_t>(cpu);
+    rec.event = static_cast<uint8_t>(event);
+    rec.reason = reason;
+    while (!ring.push(rec)) {
+        // Full: wait for the writer thread, or make room ourselves if there is none.
+        if (writer.joinable()) {
+            std::this_thread::yield();
+        } else {
+            drain();
+        }
+    }
+    count++;
+}
+
+void TraceRecorder::drain() {
+    TraceRecord batch[256];
+    size_t n;
+    while ((n = ring.pop(batch, sizeof(batch) / sizeof(batch[0]))) > 0) {
+        std::fwrite(batch, sizeof(TraceRecord), n, file);
+    }
+}
+
+void TraceRecorder::writerLoop() {
+    std::vector<TraceRecord> batch(TRACE_WRITE_BATCH);
+    while (true) {
+        bool last_pass = stopping.load(std::memory_order_acquire);
+        size_t n = ring.pop(batch.data(), batch.size());
+        if (n > 0) {
+            std::fwrite(batch.data(), sizeof(TraceRecord), n, file);
+        } else if (last_pass) {
+            break;
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
+}
+
+void TraceRecorder::close() {
+    if (file == nullptr) return;
+    if (writer.joinable()) {
+        stopping.store(true, std::memory_order_release);
+        writer.join();
+    }
+    drain();
+    std::fclose(file);
+    file = nullptr;
+}
+
+// --- TraceReplay ---
+
+bool TraceReplay::load(const std::string& path, std::string* error) {
+    FILE* in = std::fopen(path.c_str(), "rb");
+    if (in == nullptr) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    TraceFileHeader header;
+    if (std::fread(&header, sizeof(header), 1, in) != 1 ||
+        std::memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.record_size != sizeof(TraceRecord)) {
+        std::fclose(in);
+        if (error) *error = path + " is not a MOSKS trace file";
+        return false;
+    }
+    std::fseek(in, 0, SEEK_END);
+    long bytes = std::ftell(in) - static_cast<long>(sizeof(header));
+    std::fseek(in, sizeof(header), SEEK_SET);
+    trace.resize(static_cast<size_t>(bytes) / sizeof(TraceRecord));
+    size_t n = std::fread(trace.data(), sizeof(TraceRecord), trace.size(), in);
+    trace.resize(n);
+    std::fclose(in);
+    return true;
+}
+
+void TraceReplay::setRecords(std::vector<TraceRecord> records) {
+    trace = std::move(records);
+}
+
+std::map<int, TraceProcessState> TraceReplay::statesAt(int time) const {
+    // Records are appended in time order, so the cut-off is a binary search.
+    auto end = std::upper_bound(trace.begin(), trace.end(), time,
+        [](int t, const TraceRecord& rec) { return t < rec.time; });
+
+    std::map<int, TraceProcessState> states;
+    long long back_order = 0, front_order = 0;
+    for (auto it = trace.begin(); it != end; ++it) {
+        const TraceRecord& rec = *it;
+        TraceProcessState& p = states[rec.pid];
+        p.pid = rec.pid;
+        switch (static_cast<TraceEvent>(rec.event)) {
+            case TraceEvent::ADMIT:
+            case TraceEvent::UNBLOCK:
+            case TraceEvent::RESUME:
+                p.location = TraceLocation::READY;
+                p.cpu = -1;
+                p.order = back_order++;
+                break;
+            case TraceEvent::WAKE:
+            case TraceEvent::MIGRATE:
+                p.location = TraceLocation::READY;
+                p.cpu = rec.cpu;
+                p.order = back_order++;
+                break;
+            case TraceEvent::PREEMPT:
+                p.location = TraceLocation::READY;
+                p.cpu = rec.cpu;
+                p.remaining = rec.arg;
+                p.order = back_order++;
+                break;
+            case TraceEvent::PAUSE:
+                p.location = TraceLocation::READY;
+                p.cpu = rec.cpu;
+                p.remaining = rec.arg;
+                p.order = --front_order;
+                break;
+            case TraceEvent::DISPATCH:
+                p.location = TraceLocation::RUNNING;
+                p.cpu = rec.cpu;
+                p.remaining = rec.arg;
+                break;
+            case TraceEvent::IO_BLOCK:
+                p.location = TraceLocation::WAITING;
+                p.wake_time = rec.arg;
+                break;
+            case TraceEvent::TERMINATE:
+                p.location = TraceLocation::TERMINATED;
+                break;
+            case TraceEvent::BLOCK:
+                p.location = TraceLocation::BLOCKED;
+                break;
+            case TraceEvent::SUSPEND:
+                p.location = TraceLocation::SUSPENDED;
+                p.order = back_order++;
+                break;
+        }
+    }
+    return states;
+}
+
+TraceSnapshot TraceReplay::snapshotAt(int time) const {
+    TraceSnapshot snap;
+    snap.time = time;
+    std::map<int, std::vector<std::pair<long long, int>>> ready;
+    std::vector<std::pair<long long, int>> suspended;
+    for (const auto& entry : statesAt(time)) {
+        const TraceProcessState& p = entry.second;
+        switch (p.location) {
+            case TraceLocation::READY: ready[p.cpu].push_back({p.order, p.pid}); break;
+            case TraceLocation::RUNNING: snap.running[p.cpu] = p.pid; break;
+            case TraceLocation::WAITING: snap.waiting.push_back({p.pid, p.wake_time}); break;
+            case TraceLocation::BLOCKED: snap.blocked.push_back(p.pid); break;
+            case TraceLocation::SUSPENDED: suspended.push_back({p.order, p.pid}); break;
+            case TraceLocation::TERMINATED: snap.terminated.push_back(p.pid); break;
+        }
+    }
+    for (auto& queue : ready) {
+        std::sort(queue.second.begin(), queue.second.end());
+        for (const auto& item : queue.second) snap.ready[queue.first].push_back(item.second);
+    }
+    std::sort(suspended.begin(), suspended.end());
+    for (const auto& item : suspended) snap.suspended.push_back(item.second);
+    std::stable_sort(snap.waiting.begin(), snap.waiting.end(),
+        [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.second < b.second; });
+    return snap;
+}
@@ -0,0 +1,138 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Scheduler state transitions captured by the trace recorder.
+enum class TraceEvent : uint8_t {
+    ADMIT,      // new process placed on the shared ready queue
+    DISPATCH,   // ready -> running on `cpu`
+    PREEMPT,    // running -> ready (quantum or slice used up)
+    PAUSE,      // running -> front of the ready queue (bounded run ended)
+    IO_BLOCK,   // running -> waiting until `arg`
+    WAKE,       // waiting -> ready on `cpu` (-1: shared queue)
+    TERMINATE,  // running -> terminated
+    MIGRATE,    // ready on CPU `arg` -> ready on `cpu` (-1 on either side: shared queue)
+    BLOCK,      // ready -> blocked on a mutex
+    UNBLOCK,    // blocked -> ready on the shared queue
+    SUSPEND,    // waiting -> suspended by load control
+    RESUME      // suspended -> ready on the shared queue
+};
+const int TRACE_EVENT_COUNT = 12;
+
+const char* traceEventToString(TraceEvent event);
+
+// Fixed-size on-disk record. For events that leave a process READY, `cpu` is the
+// run queue it joins (-1: the shared queue, which is the only one on a single CPU);
+// otherwise it is the CPU involved. `arg` depends on the event: remaining burst for
+// ADMIT/DISPATCH/PREEMPT/PAUSE, wake time for IO_BLOCK and WAKE, source queue for MIGRATE.
+struct TraceRecord {
+    int32_t time;
+    int32_t pid;
+    int32_t arg;
+    int16_t cpu;
+    uint8_t event;
+    uint8_t reason;     // WakeReason for IO_BLOCK and WAKE
+};
+static_assert(sizeof(TraceRecord) == 16, "trace records must stay 16 bytes");
+
+// Trace files start with this header, followed by packed TraceRecords.
+struct TraceFileHeader {
+    char magic[8];              // "MOSKTRC1"
+    uint32_t record_size;
+    uint32_t reserved;
+};
+
+// Single-producer single-consumer ring of records. Neither side ever blocks or
+// takes a lock: push() fails when full and pop() when empty.
+class TraceRing {
+public:
+    explicit TraceRing(size_t capacity);   // rounded up to a power of two
+
+    bool push(const TraceRecord& record);
+    // Copy up to `max` records into `out`; returns how many were taken.
+    size_t pop(TraceRecord* out, size_t max);
+    size_t capacity() const { return slots.size(); }
+
+private:
+    std::vector<TraceRecord> slots;
+    size_t mask;
+    alignas(64) std::atomic<uint64_t> head;  // next write position (producer)
+    alignas(64) std::atomic<uint64_t> tail;  // next read position (consumer)
+};
+
+// Records trace events into a TraceRing that is drained to a file, either by a
+// background writer thread or, without one, by the producer whenever the ring
+// fills up and when the recorder is closed. Records are never dropped.
+class TraceRecorder {
+public:
+    TraceRecorder(const std::string& path, size_t ring_capacity = 1 << 16, bool background_writer = true);
+    ~TraceRecorder();
+
+    bool isOpen() const { return file != nullptr; }
+    void record(TraceEvent event, int time, int pid, int cpu = -1, int arg = 0, uint8_t reason = 0);
+    // Stop the writer, write out everything still buffered and close the file.
+    void close();
+    unsigned long long recorded() const { return count; }
+
+private:
+    TraceRing ring;
+    FILE* file;
+    std::thread writer;
+    std::atomic<bool> stopping;
+    unsigned long long count;
+
+    void drain();
+    void writerLoop();
+};
+
+// Where a process is at a given point of a trace.
+enum class TraceLocation { READY, RUNNING, WAITING, BLOCKED, SUSPENDED, TERMINATED };
+
+struct TraceProcessState {
+    int pid = 0;
+    TraceLocation location = TraceLocation::READY;
+    int cpu = -1;           // run queue / CPU (-1: shared ready queue)
+    int wake_time = -1;     // while WAITING
+    int remaining = -1;     // remaining burst at the last dispatch or preemption
+    long long order = 0;    // enqueue order among READY processes
+};
+
+// Queue state rebuilt from a trace.
+struct TraceSnapshot {
+    int time = 0;
+    std::map<int, std::vector<int>> ready;      // run queue (-1: shared) -> pids in enqueue order
+    std::map<int, int> running;                 // cpu -> pid
+    std::vector<std::pair<int, int>> waiting;   // (pid, wake time) ordered by wake time
+    std::vector<int> blocked;
+    std::vector<int> suspended;                 // in suspension order
+    std::vector<int> terminated;
+};
+
+// Reads a trace file and answers "what did the queues look like at time t".
+// The state at t includes every record stamped <= t, i.e. the decisions the
+// scheduler made at t, so it describes the tick [t, t+1).
+class TraceReplay {
+public:
+    bool load(const std::string& path, std::string* error = nullptr);
+    void setRecords(std::vector<TraceRecord> records);
+
+    const std::vector<TraceRecord>& records() const { return trace; }
+    int startTime() const { return trace.empty() ? 0 : trace.front().time; }
+    int endTime() const { return trace.empty() ? 0 : trace.back().time; }
+
+    std::map<int, TraceProcessState> statesAt(int time) const;
+    TraceSnapshot snapshotAt(int time) const;
+
+private:
+    std::vector<TraceRecord> trace;
+};
+
+#endif
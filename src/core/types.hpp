@@ -19,6 +19,7 @@ enum class ProcessState {
     RUNNING,
     WAITING,
     BLOCKED_ON_MUTEX,
+    SUSPENDED,      // taken out of memory by load control (see Scheduler)
     TERMINATED
 };
 
@@ -0,0 +1,44 @@
+#ifndef WAIT_QUEUE_HPP
+#define WAIT_QUEUE_HPP
+
+#include <cstddef>
+#include "scheduler/pcb.hpp"
+
+// FIFO of processes blocked on a synchronization object, linked through the
+// PCBs' wait_next field. A process sleeps on at most one queue at a time, so
+// push and pop are O(1) and never allocate.
+class WaitQueue {
+public:
+    WaitQueue() : head(nullptr), tail(nullptr), count(0) {}
+    WaitQueue(const WaitQueue&) = delete;
+    WaitQueue& operator=(const WaitQueue&) = delete;
+
+    void push(ProcessControlBlock* pcb) {
+        pcb->wait_next = nullptr;
+        if (tail != nullptr) tail->wait_next = pcb; else head = pcb;
+        tail = pcb;
+        count++;
+    }
+
+    // Dequeue the longest-waiting process, or nullptr if empty.
+    ProcessControlBlock* pop() {
+        ProcessControlBlock* pcb = head;
+        if (pcb == nullptr) return nullptr;
+        head = pcb->wait_next;
+        if (head == nullptr) tail = nullptr;
+        pcb->wait_next = nullptr;
+        count--;
+        return pcb;
+    }
+
+    ProcessControlBlock* front() const { return head; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    ProcessControlBlock* head;
+    ProcessControlBlock* tail;
+    size_t count;
+};
+
+#endif
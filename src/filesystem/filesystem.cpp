@@ -6,18 +6,16 @@
 
 
 void FileSystem::setLogLevel(LogLevel level) {
-    current_log_level = level;
+    logger.setLevel(level);
 }
 
-void FileSystem::log(LogLevel level, const std::string& message) {
-    if (current_log_level >= level) {
-        std::cout << message << std::endl;
-    }
+void FileSystem::setLogSink(LogSink* sink) {
+    logger.setSink(sink != nullptr ? *sink : stdoutSink());
 }
 
 
 // --- Constructor ---
-FileSystem::FileSystem(int num_blocks) : current_log_level(NORMAL){
+FileSystem::FileSystem(int num_blocks) {
     disk.resize(num_blocks);
     free_block_bitmap.resize(num_blocks,false);
     next_inode_id = 0;
@@ -27,7 +25,7 @@ FileSystem::FileSystem(int num_blocks) : current_log_level(NORMAL){
 
 // --- Format Method ---
 void FileSystem::format(){
-    log(NORMAL, "Formatting the file system...");
+    MOSKS_LOG(logger, NORMAL, "Formatting the file system...");
 
     inode_table.clear();
     root_directory.clear();
@@ -40,7 +38,7 @@ void FileSystem::format(){
     
     free_block_bitmap[0] = true; 
     
-    log(NORMAL, "File system formatted. Root directory created with Inode 0.");
+    MOSKS_LOG(logger, NORMAL, "File system formatted. Root directory created with Inode 0.");
 
 }
 
@@ -52,14 +50,14 @@ int FileSystem::findFreeInode() {
 int FileSystem::create(const std::string& filename){
     // 1. Check if the file already exists in the root directory
     if(root_directory.count(filename)){
-        log(NORMAL, "Error: File '" + filename + "' already exists.");
+        MOSKS_LOG(logger, NORMAL, "Error: File '" << filename << "' already exists.");
         return -1;
     }
 
     // 2. Get a new inode for the file
     int inode_id = findFreeInode();
     if(inode_id == -1){
-        log(NORMAL, "Error: No free inodes available.");
+        MOSKS_LOG(logger, NORMAL, "Error: No free inodes available.");
         return -1;
     }
     Inode new_inode;
@@ -72,7 +70,7 @@ int FileSystem::create(const std::string& filename){
     // 4. Add the new file entry to the root directory
     root_directory[filename] = inode_id;
 
-    log(VERBOSE, "Created file '" + filename + "' with Inode " + std::to_string(inode_id));
+    MOSKS_LOG(logger, VERBOSE, "Created file '" << filename << "' with Inode " << inode_id);
     return inode_id;
 }
 
@@ -89,7 +87,7 @@ int FileSystem::findFreeBlock(){
 int FileSystem::write(int inode_number,const std::string& data){
     // 1. Find the inode
     if(inode_table.find(inode_number) == inode_table.end()){
-        log(NORMAL, "Error: Inode " + std::to_string(inode_number) + " not found.");
+        MOSKS_LOG(logger, NORMAL, "Error: Inode " << inode_number << " not found.");
         return -1;
     }
     Inode& inode = inode_table.at(inode_number);
@@ -109,7 +107,7 @@ int FileSystem::write(int inode_number,const std::string& data){
     for(int i = 0;i < blocks_needed; i++){
         int block_index = findFreeBlock();
         if(block_index == -1){
-            log(NORMAL, "Error: Out of disk space.");
+            MOSKS_LOG(logger, NORMAL, "Error: Out of disk space.");
             for(int b_idx : inode.data_block_indices) free_block_bitmap[b_idx] = false;
             inode.data_block_indices.clear();
             return -1;
@@ -126,14 +124,14 @@ int FileSystem::write(int inode_number,const std::string& data){
     // 5. Update inode metadata
     inode.size = data_len;
 
-    log(VERBOSE, "Wrote " + std::to_string(data_len) + " bytes to Inode " + std::to_string(inode_number));
+    MOSKS_LOG(logger, VERBOSE, "Wrote " << data_len << " bytes to Inode " << inode_number);
     return data_len;
 }
 
 std::string FileSystem::read(int inode_number) {
     // 1. Find the inode
     if (inode_table.find(inode_number) == inode_table.end()) {
-        log(NORMAL, "Error: Inode " + std::to_string(inode_number) + " not found.");
+        MOSKS_LOG(logger, NORMAL, "Error: Inode " << inode_number << " not found.");
         return ""; // Return empty string on error
     }
     const Inode& inode = inode_table.at(inode_number);
@@ -148,21 +146,21 @@ std::string FileSystem::read(int inode_number) {
         bytes_to_read -= bytes_from_this_block;
     }
 
-    log(VERBOSE, "Read " + std::to_string(inode.size) + " bytes from Inode " + std::to_string(inode_number));
+    MOSKS_LOG(logger, VERBOSE, "Read " << inode.size << " bytes from Inode " << inode_number);
     return data;
 }
 
 void FileSystem::remove(const std::string& filename){
     // 1. Find the file in the root directory
     if(root_directory.find(filename) == root_directory.end()){
-        log(NORMAL, "Error: Cannot remove file '" + filename + "', not found.");
+        MOSKS_LOG(logger, NORMAL, "Error: Cannot remove file '" << filename << "', not found.");
         return;
     }
     int inode_number = root_directory.at(filename);
 
     // 2. Get the inode
     if(inode_table.find(inode_number) == inode_table.end()){
-        log(NORMAL, "Error: Inode " + std::to_string(inode_number) + " is corrupted or missing.");
+        MOSKS_LOG(logger, NORMAL, "Error: Inode " << inode_number << " is corrupted or missing.");
         return;
     }
     const Inode& inode = inode_table.at(inode_number);
@@ -180,6 +178,6 @@ void FileSystem::remove(const std::string& filename){
     // 5. Remove the file's entry from the root directory
     root_directory.erase(filename);
 
-    log(VERBOSE, "Removed file '" + filename + "' and freed its resources.");
+    MOSKS_LOG(logger, VERBOSE, "Removed file '" << filename << "' and freed its resources.");
 }
 
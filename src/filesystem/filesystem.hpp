@@ -3,6 +3,7 @@
 
 #include "fs_types.hpp"
 #include "core/types.hpp"
+#include "core/logger.hpp"
 #include <vector>
 #include <map>
 #include <string>
@@ -13,6 +14,8 @@ class FileSystem {
         void format();
 
         void setLogLevel(LogLevel level);
+        // Send log messages to `sink` instead of stdout (nullptr restores stdout).
+        void setLogSink(LogSink* sink);
 
         // Core file operations
         int create(const std::string& filename);
@@ -37,8 +40,7 @@ class FileSystem {
         int findFreeBlock();
         int findFreeInode();
 
-        LogLevel current_log_level;
-        void log(LogLevel level, const std::string& message);
+        Logger logger;
 
 };
 
@@ -1,5 +1,7 @@
 #include "cli/system.hpp"
+#include "cli/batch.hpp"
 #include <iostream>
+#include <string>
 
 void bootSystem() {
     std::cout << "Initializing Mini OS Kernel Simulator (MOSKS)..." << std::endl;
@@ -8,7 +10,36 @@ void bootSystem() {
     std::cout << "System Boot Complete [OK]" << std::endl;
 }
 
-int main() {
+static int usage() {
+    std::cerr << "Usage: main                               Interactive shell.\n"
+              << "       main --batch <file>                Run a text or binary command file and print a report.\n"
+              << "       main --compile <text> <binary>     Convert a text command file to the binary form.\n";
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        std::string mode = argv[1];
+        std::string error;
+        if (mode == "--batch" && argc == 3) {
+            BatchSummary summary;
+            if (!runBatch(argv[2], SystemConfig(), summary, &error)) {
+                std::cerr << error << "\n";
+                return 1;
+            }
+            printBatchReport(std::cout, summary);
+            return 0;
+        }
+        if (mode == "--compile" && argc == 4) {
+            if (!compileBatchFile(argv[2], argv[3], &error)) {
+                std::cerr << error << "\n";
+                return 1;
+            }
+            return 0;
+        }
+        return usage();
+    }
+
     bootSystem();
 
     System mosks;
@@ -16,4 +47,4 @@ int main() {
     mosks.runCLI();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,50 @@
+#ifndef GHOST_LIST_HPP
+#define GHOST_LIST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+
+// Recency-ordered set of pages that are no longer resident, used by the
+// adaptive replacement policies (ARC's B1/B2, 2Q's A1out) to recognise a page
+// that was evicted recently. Keys are (pid << 32 | vpn).
+class GhostList {
+public:
+    static uint64_t key(int pid, int vpn) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(pid)) << 32) | static_cast<uint32_t>(vpn);
+    }
+
+    size_t size() const { return order.size(); }
+    bool contains(uint64_t page) const { return index.count(page) != 0; }
+
+    void pushBack(uint64_t page) {
+        order.push_back(page);
+        index[page] = std::prev(order.end());
+    }
+    // Removes `page` if present; true if it was.
+    bool erase(uint64_t page) {
+        auto it = index.find(page);
+        if (it == index.end()) return false;
+        order.erase(it->second);
+        index.erase(it);
+        return true;
+    }
+    // Forget the oldest page.
+    void popFront() {
+        if (order.empty()) return;
+        index.erase(order.front());
+        order.pop_front();
+    }
+    void clear() {
+        order.clear();
+        index.clear();
+    }
+
+private:
+    std::list<uint64_t> order;      // oldest first
+    std::unordered_map<uint64_t, std::list<uint64_t>::iterator> index;
+};
+
+#endif
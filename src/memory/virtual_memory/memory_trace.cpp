@@ -0,0 +1,159 @@
+#include "memory_trace.hpp"
+#include "memory_types.hpp"
+#include "core/mapped_file.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const char TRACE_MAGIC[8] = {'M', 'O', 'S', 'K', 'M', 'T', '0', '1'};
+
+struct MemoryTraceRecord {
+    uint32_t vpn;
+    uint16_t pid;
+    uint8_t type;
+    uint8_t reserved;
+};
+static_assert(sizeof(MemoryTraceRecord) == 8, "memory trace records must stay 8 bytes");
+
+MemoryTraceReader::MemoryTraceReader(const char* data, size_t size, int page_size)
+    : pos(data), end(data + size), binary(false), page_shift(0), line_number(0),
+      last_page(~uint64_t(0)), last_vpn(0), has_pending(false) {
+    while (page_shift < 30 && (2 << page_shift) <= page_size) ++page_shift;
+    if (size >= sizeof(TRACE_MAGIC) && std::memcmp(data, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0) {
+        binary = true;
+        pos += sizeof(TRACE_MAGIC);
+    }
+}
+
+bool MemoryTraceReader::next(MemoryAccess& access) {
+    if (has_pending) {
+        access = pending;
+        has_pending = false;
+        return true;
+    }
+    return binary ? nextBinary(access) : nextText(access);
+}
+
+bool MemoryTraceReader::renumber(uint64_t page, int& vpn) {
+    // Consecutive accesses mostly stay on one page.
+    if (page == last_page) {
+        vpn = last_vpn;
+        return true;
+    }
+    auto inserted = page_numbers.emplace(page, static_cast<int>(page_numbers.size()));
+    vpn = inserted.first->second;
+    if (vpn >= MAX_VIRTUAL_PAGES) {
+        failure = "more than " + std::to_string(MAX_VIRTUAL_PAGES) + " distinct pages at line " + std::to_string(line_number);
+        return false;
+    }
+    last_page = page;
+    last_vpn = vpn;
+    return true;
+}
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool MemoryTraceReader::nextText(MemoryAccess& access) {
+    while (pos < end) {
+        const char* newline = static_cast<const char*>(std::memchr(pos, '\n', static_cast<size_t>(end - pos)));
+        const char* line_end = newline != nullptr ? newline : end;
+        const char* p = pos;
+        pos = newline != nullptr ? newline + 1 : end;
+        line_number++;
+
+        while (p < line_end && *p == ' ') ++p;
+        if (line_end - p < 3 || p[1] != ' ') continue;
+        AccessType type;
+        switch (*p) {
+            case 'I': case 'L': type = AccessType::READ; break;
+            case 'S': case 'M': type = AccessType::WRITE; break;
+            default: continue;
+        }
+        p += 2;
+        while (p < line_end && *p == ' ') ++p;
+        uint64_t address = 0;
+        int digits = 0;
+        for (int d; p < line_end && (d = hexDigit(*p)) >= 0; ++p, ++digits) address = (address << 4) | d;
+        if (digits == 0 || p == line_end || *p != ',') continue;
+        uint64_t size = 0;
+        for (++p; p < line_end && *p >= '0' && *p <= '9'; ++p) size = size * 10 + (*p - '0');
+
+        uint64_t first = address >> page_shift;
+        uint64_t last = (address + (size > 0 ? size - 1 : 0)) >> page_shift;
+        access.pid = 1;
+        access.type = type;
+        if (!renumber(first, access.vpn)) return false;
+        if (last != first) {
+            pending = access;
+            if (!renumber(last, pending.vpn)) return false;
+            has_pending = true;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool MemoryTraceReader::nextBinary(MemoryAccess& access) {
+    if (pos == end) return false;
+    line_number++;
+    if (static_cast<size_t>(end - pos) < sizeof(MemoryTraceRecord)) {
+        failure = "truncated record " + std::to_string(line_number);
+        return false;
+    }
+    MemoryTraceRecord record;
+    std::memcpy(&record, pos, sizeof(record));
+    pos += sizeof(record);
+    if (record.vpn >= static_cast<uint32_t>(MAX_VIRTUAL_PAGES) || record.type > static_cast<uint8_t>(AccessType::EXECUTE)) {
+        failure = "invalid record " + std::to_string(line_number);
+        return false;
+    }
+    access.pid = record.pid;
+    access.vpn = static_cast<int>(record.vpn);
+    access.type = static_cast<AccessType>(record.type);
+    return true;
+}
+
+bool compileMemoryTrace(const std::string& text_path, const std::string& binary_path, int page_size, std::string* error) {
+    MappedFile input;
+    if (!input.open(text_path, error)) return false;
+    MemoryTraceReader reader(input.data(), input.size(), page_size);
+    if (reader.isBinary()) {
+        if (error) *error = text_path + " is already a binary memory trace";
+        return false;
+    }
+    FILE* output = std::fopen(binary_path.c_str(), "wb");
+    if (output == nullptr) {
+        if (error) *error = "cannot create " + binary_path;
+        return false;
+    }
+
+    std::fwrite(TRACE_MAGIC, sizeof(TRACE_MAGIC), 1, output);
+    std::vector<MemoryTraceRecord> chunk;
+    chunk.reserve(1 << 16);
+    MemoryAccess access;
+    bool ok = true;
+    while (ok) {
+        bool more = reader.next(access);
+        if (more) {
+            chunk.push_back({static_cast<uint32_t>(access.vpn), static_cast<uint16_t>(access.pid),
+                             static_cast<uint8_t>(access.type), 0});
+        }
+        if (!more || chunk.size() == chunk.capacity()) {
+            ok = std::fwrite(chunk.data(), sizeof(MemoryTraceRecord), chunk.size(), output) == chunk.size();
+            chunk.clear();
+        }
+        if (!more) break;
+    }
+    ok = std::fclose(output) == 0 && ok;
+    if (!reader.error().empty()) {
+        if (error) *error = text_path + ": " + reader.error();
+        return false;
+    }
+    if (!ok && error) *error = "cannot write " + binary_path;
+    return ok;
+}
@@ -0,0 +1,72 @@
+#ifndef MEMORY_TRACE_HPP
+#define MEMORY_TRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "core/types.hpp"
+
+struct MemoryAccess {
+    int pid = 1;
+    int vpn = 0;
+    AccessType type = AccessType::READ;
+};
+
+// Decodes one page access at a time from a memory trace, text or binary
+// (detected from the header), without copying the input.
+//
+// Text traces use the Valgrind lackey format (--trace-mem=yes):
+//     I  0400d7d4,8       instruction fetch
+//      L 04222cac,8       load
+//      S 04222cac,8       store
+//      M 0421a0c0,4       modify (replayed as a store)
+// Other lines, such as Valgrind's "==pid==" messages, are skipped. An access that
+// straddles a page boundary touches both pages. Instruction fetches are replayed
+// as reads, since demand-faulted pages are mapped without execute permission.
+// Every access belongs to process 1. Host addresses are far apart and outside
+// the simulated 2^20-page address space, so each distinct page is renumbered in
+// the order of its first access. This keeps every reuse, which is all that
+// page replacement depends on.
+//
+// Binary traces start with the 8 bytes "MOSKMT01", followed by 8-byte records
+// {uint32 vpn, uint16 pid, uint8 AccessType, uint8 reserved}, holding
+// already-renumbered pages.
+class MemoryTraceReader {
+public:
+    // `page_size` is in bytes (rounded down to a power of two) and only matters
+    // for text traces.
+    MemoryTraceReader(const char* data, size_t size, int page_size = 4096);
+
+    bool isBinary() const { return binary; }
+    // Fills `access` with the next access; false at the end of the input or on
+    // a malformed binary record or an address space overflow (see error()).
+    bool next(MemoryAccess& access);
+    const std::string& error() const { return failure; }
+    long long line() const { return line_number; }
+    // Distinct pages seen so far in a text trace.
+    size_t pages() const { return page_numbers.size(); }
+
+private:
+    const char* pos;
+    const char* end;
+    bool binary;
+    int page_shift;
+    long long line_number;
+    std::string failure;
+    std::unordered_map<uint64_t, int> page_numbers;
+    uint64_t last_page;
+    int last_vpn;
+    bool has_pending;
+    MemoryAccess pending;   // second page of a straddling access
+
+    bool nextText(MemoryAccess& access);
+    bool nextBinary(MemoryAccess& access);
+    bool renumber(uint64_t page, int& vpn);
+};
+
+// Convert a text memory trace to the binary form.
+bool compileMemoryTrace(const std::string& text_path, const std::string& binary_path,
+                        int page_size = 4096, std::string* error = nullptr);
+
+#endif
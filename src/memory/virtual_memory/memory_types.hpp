@@ -1,28 +1,125 @@
 #ifndef MEMORY_TYPES_HPP
 #define MEMORY_TYPES_HPP
 
-#include <unordered_map>
+#include <cstdint>
+#include <vector>
 
-struct PageTableEntry; // Forward declaration
-using PageTable = std::unordered_map<int, PageTableEntry>;
+// Virtual page numbers are split into a page directory index and a page table
+// index of 10 bits each, so a process can address 2^20 pages.
+const int PAGE_TABLE_SIZE = 1024;
+const int MAX_VIRTUAL_PAGES = PAGE_TABLE_SIZE * PAGE_TABLE_SIZE;
 
-struct PageDirectoryEntry {
-    PageTable* pageTable;
-    bool valid;
-    PageDirectoryEntry() : pageTable(nullptr), valid(false) {}
+// The frame number and the status and permission bits share one 32-bit word;
+// the access time used by LRU follows it. Like a hardware PTE, a page that
+// is not resident but was written out reuses the frame number field for its
+// swap slot. A page fault grants R/W/no-X, unless the permissions were set
+// explicitly before (`configured`). The field width bounds both the number
+// of frames and the number of swap slots.
+const int FRAME_NUMBER_BITS = 23;
+const int MAX_FRAME_NUMBER = (1 << (FRAME_NUMBER_BITS - 1)) - 1;   // signed, -1 means none
+
+struct PageTableEntry {
+    int32_t frameNumber : FRAME_NUMBER_BITS;   // frame while valid, swap slot while swapped, else -1
+    uint32_t valid : 1;
+    uint32_t configured : 1;    // permissions set explicitly; faults keep them
+    uint32_t cow : 1;           // writable, but write-protected until a private copy is made
+    uint32_t swapped : 1;       // not resident; the contents are in swap
+    uint32_t referenced : 1;
+    uint32_t dirty : 1;         // written since it was loaded
+    uint32_t can_read : 1;
+    uint32_t can_write : 1;
+    uint32_t can_execute : 1;
+    uint64_t lastAccessTime;
+
+    PageTableEntry() : frameNumber(-1), valid(false), configured(false), cow(false), swapped(false), referenced(false), dirty(false),
+                       can_read(false), can_write(false), can_execute(false), lastAccessTime(0) {}
 };
+static_assert(sizeof(PageTableEntry) == 16, "page table entries must stay 16 bytes");
 
-using PageDirectory = std::unordered_map<int, PageDirectoryEntry>;
+// Second level: one PTE per page of a 1024-page region. Tables are handed out
+// by the VirtualMemoryManager's pool and returned once no page in them is
+// resident, swapped out or given permissions any more.
+struct alignas(64) PageTable {
+    PageTableEntry entries[PAGE_TABLE_SIZE];
+    int resident = 0;   // valid entries
+    int swapped = 0;    // entries whose page is in swap
+    int configured = 0; // entries with explicit permissions
 
-struct PageTableEntry {
-    int frameNumber;
-    bool valid;
-    bool referenced;
-    unsigned long lastAccessTime;
-    bool can_read, can_write, can_execute;
-
-    PageTableEntry() : frameNumber(-1), valid(false), referenced(false), lastAccessTime(0),
-                       can_read(false), can_write(false), can_execute(false) {}
+    PageTableEntry& operator[](int pti) { return entries[pti]; }
+    const PageTableEntry& operator[](int pti) const { return entries[pti]; }
+    bool unused() const { return resident == 0 && swapped == 0 && configured == 0; }
+};
+
+// First level: the page table of every region, or nullptr.
+struct PageDirectoryEntries {
+    PageTable* tables[PAGE_TABLE_SIZE];
+};
+
+// Per-process sequential fault detection for readahead. `last` follows the
+// stream: it moves on every demand fault and on the first use of every
+// prefetched page.
+struct ReadaheadState {
+    int last = -1;          // vpn the stream last touched
+    int stride = 0;         // distance between its last two steps
+    int window = 0;         // pages in the current window; 0: not sequential
+    int next = -1;          // first vpn after the current window
+    int marker = -1;        // prefetched vpn whose first use fetches the next window
+};
+
+// Page-fault frequency, measured over windows of a fixed number of accesses.
+// `rate` is the fraction of the accesses of the last complete window that
+// faulted; a window is closed by the first access after it.
+struct FaultFrequency {
+    int accesses = 0;       // in the current window
+    int faults = 0;
+    double rate = 0.0;
+    long long windows = 0;  // complete windows so far
+
+    void access(int window) {
+        if (accesses >= window) {
+            rate = static_cast<double>(faults) / accesses;
+            accesses = 0;
+            faults = 0;
+            windows++;
+        }
+        accesses++;
+    }
+};
+
+// A shared-memory segment mapped at pages [base, base + pages) of a process.
+struct SegmentAttachment {
+    int segment;    // index in the VirtualMemoryManager's segments
+    int base;
+    int pages;
+};
+
+// A process's address space. The directory itself is only allocated with the
+// first page table, so processes that never touch memory cost nothing.
+struct PageDirectory {
+    PageDirectoryEntries* entries = nullptr;
+    int table_count = 0;
+    int resident_pages = 0; // including frames shared with other processes
+    int first_mapping = -1; // mappings of the resident pages (see FrameMapping)
+    int resident_limit = 0; // most resident pages allowed; 0: no limit
+    long long faults = 0;
+    FaultFrequency fault_rate;
+    ReadaheadState readahead;
+    std::vector<SegmentAttachment> segments;
+
+    bool empty() const { return table_count == 0; }
+    PageTable* table(int pdi) const { return entries != nullptr ? entries->tables[pdi] : nullptr; }
+    // The PTE of `vpn`, or nullptr if its page table does not exist.
+    PageTableEntry* find(int vpn) const {
+        PageTable* pt = table(vpn / PAGE_TABLE_SIZE);
+        return pt != nullptr ? &(*pt)[vpn % PAGE_TABLE_SIZE] : nullptr;
+    }
+    // The shared-memory segment mapped at `vpn`, or nullptr.
+    const SegmentAttachment* attachment(int vpn) const {
+        for (const SegmentAttachment& a : segments) {
+            if (vpn >= a.base && vpn < a.base + a.pages) return &a;
+        }
+        return nullptr;
+    }
 };
 
-#endif
\ No newline at end of file
+#endif
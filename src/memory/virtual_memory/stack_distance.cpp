@@ -0,0 +1,108 @@
+#include "stack_distance.hpp"
+#include <algorithm>
+#include <cmath>
+
+static const uint32_t MIN_CAPACITY = 1 << 16;
+static const uint64_t SAMPLE_MODULUS = 1 << 24;
+
+// splitmix64 finalizer: spreads the (pid, vpn) key so sampling is uniform.
+static uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// --- MissRatioCurve ---
+
+MissRatioCurve::MissRatioCurve(const std::vector<double>& distances, double cold, long long accesses)
+    : tail(distances.size() + 1, 0.0), cold(cold), total(accesses) {
+    for (size_t d = distances.size(); d-- > 0;) tail[d] = tail[d + 1] + distances[d];
+}
+
+long long MissRatioCurve::misses(long long frames) const {
+    double reuses = frames < 0 ? tail.front() : (frames < static_cast<long long>(tail.size()) ? tail[frames] : 0.0);
+    return std::llround(cold + reuses);
+}
+
+double MissRatioCurve::missRatio(long long frames) const {
+    return total > 0 ? static_cast<double>(misses(frames)) / total : 0.0;
+}
+
+// --- StackDistanceAnalyzer ---
+
+StackDistanceAnalyzer::StackDistanceAnalyzer(double sample_rate)
+    : rate(std::min(1.0, std::max(sample_rate, 1.0 / SAMPLE_MODULUS))),
+      threshold(static_cast<uint64_t>(rate * SAMPLE_MODULUS)),
+      tree(MIN_CAPACITY + 1, 0), page_at(MIN_CAPACITY, NO_PAGE), now(0), cold(0.0), total(0) {}
+
+void StackDistanceAnalyzer::mark(uint32_t time, int delta) {
+    for (size_t i = time + 1; i < tree.size(); i += i & (~i + 1)) tree[i] += delta;
+}
+
+uint32_t StackDistanceAnalyzer::countUpTo(uint32_t time) const {
+    uint32_t count = 0;
+    for (size_t i = time; i > 0; i -= i & (~i + 1)) count += tree[i];
+    return count;
+}
+
+void StackDistanceAnalyzer::access(int pid, int vpn) {
+    total++;
+    uint64_t page = (static_cast<uint64_t>(static_cast<uint32_t>(pid)) << 32) | static_cast<uint32_t>(vpn);
+    if (rate < 1.0 && (mix(page) & (SAMPLE_MODULUS - 1)) >= threshold) return;
+    double weight = 1.0 / rate;
+    if (now > 0 && page_at[now - 1] == page) {
+        // Already on top of the stack: nothing moves.
+        if (distances.empty()) distances.resize(1, 0.0);
+        distances[0] += weight;
+        return;
+    }
+    if (now == page_at.size()) compact();
+
+    auto inserted = last_access.emplace(page, now);
+    if (inserted.second) {
+        cold += weight;
+    } else {
+        uint32_t previous = inserted.first->second;
+        // Pages whose last access came after `previous`; the page itself was
+        // counted at `previous`, which is excluded.
+        uint32_t distance = static_cast<uint32_t>(last_access.size()) - countUpTo(previous + 1);
+        size_t scaled = static_cast<size_t>(distance * weight);
+        if (scaled >= distances.size()) distances.resize(scaled + 1, 0.0);
+        distances[scaled] += weight;
+        mark(previous, -1);
+        page_at[previous] = NO_PAGE;
+        inserted.first->second = now;
+    }
+    mark(now, +1);
+    page_at[now] = page;
+    now++;
+}
+
+// Renumber the last accesses 0..n-1, keeping their order, and resize the tree
+// to leave as much room again.
+void StackDistanceAnalyzer::compact() {
+    size_t live = last_access.size();
+    size_t capacity = std::max<size_t>(MIN_CAPACITY, 2 * live);
+    std::vector<uint64_t> pages(capacity, NO_PAGE);
+    uint32_t next = 0;
+    for (uint32_t time = 0; time < now; ++time) {
+        if (page_at[time] == NO_PAGE) continue;
+        last_access[page_at[time]] = next;
+        pages[next++] = page_at[time];
+    }
+    page_at.swap(pages);
+    now = next;
+    // Linear-time Fenwick construction over `next` ones.
+    tree.assign(capacity + 1, 0);
+    for (size_t i = 1; i < tree.size(); ++i) {
+        if (i <= next) tree[i] += 1;
+        size_t parent = i + (i & (~i + 1));
+        if (parent < tree.size()) tree[parent] += tree[i];
+    }
+}
+
+MissRatioCurve StackDistanceAnalyzer::curve() const {
+    return MissRatioCurve(distances, cold, total);
+}
@@ -0,0 +1,70 @@
+#ifndef STACK_DISTANCE_HPP
+#define STACK_DISTANCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Miss counts of a global LRU memory for every frame count at once.
+class MissRatioCurve {
+public:
+    MissRatioCurve() = default;
+    MissRatioCurve(const std::vector<double>& distances, double cold, long long accesses);
+
+    // Page faults of an LRU memory with `frames` frames, first accesses included.
+    long long misses(long long frames) const;
+    double missRatio(long long frames) const;
+    long long accesses() const { return total; }
+    // Frame count beyond which only cold misses remain.
+    long long maxUsefulFrames() const { return static_cast<long long>(tail.size()) - 1; }
+
+private:
+    std::vector<double> tail{0.0};  // tail[f]: reuses at stack distance >= f; ends with 0
+    double cold = 0.0;
+    long long total = 0;
+};
+
+// One-pass Mattson stack-distance analysis. The stack distance of a reuse is
+// the number of distinct pages accessed since the previous access to the same
+// page. An LRU memory of F frames misses exactly on the reuses at distance >= F,
+// plus the first access to each page, so one histogram of distances gives
+// the whole miss-ratio curve.
+//
+// Each page's most recent access is marked in a Fenwick tree indexed by access
+// time, so a distance is a range count in O(log n). Time is renumbered densely
+// whenever the tree fills up, so memory stays proportional to the number of
+// distinct pages rather than to the trace length.
+//
+// With a sample rate below 1, only pages whose hash falls under the rate are
+// tracked (SHARDS): distances and counts are scaled by 1/rate. This trades
+// accuracy for speed and memory on very large traces.
+class StackDistanceAnalyzer {
+public:
+    explicit StackDistanceAnalyzer(double sample_rate = 1.0);
+
+    void access(int pid, int vpn);
+    MissRatioCurve curve() const;
+    long long accesses() const { return total; }
+    // Distinct sampled pages so far.
+    size_t pages() const { return last_access.size(); }
+
+private:
+    static constexpr uint64_t NO_PAGE = ~uint64_t(0);
+
+    double rate;
+    uint64_t threshold;         // sampled iff hash(page) < threshold
+    std::unordered_map<uint64_t, uint32_t> last_access;    // page -> time of its last access
+    std::vector<uint32_t> tree;     // Fenwick tree over time, 1-based
+    std::vector<uint64_t> page_at;  // page whose last access is at this time, or NO_PAGE
+    uint32_t now;
+    std::vector<double> distances;  // histogram of scaled stack distances
+    double cold;
+    long long total;
+
+    void mark(uint32_t time, int delta);
+    uint32_t countUpTo(uint32_t time) const;   // marked times in [0, time)
+    void compact();
+};
+
+#endif
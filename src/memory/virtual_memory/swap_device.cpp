@@ -0,0 +1,76 @@
+#include "swap_device.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+SwapDevice::~SwapDevice() {
+    close();
+}
+
+bool SwapDevice::open(const std::string& path, int slots, size_t slot_bytes, std::string* error) {
+    close();
+    if (slots <= 0 || slot_bytes == 0) {
+        if (error) *error = "a swap device needs at least one slot";
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(slots) * slot_bytes;
+    void* m = MAP_FAILED;
+    if (path.empty()) {
+        m = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    } else {
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0) {
+            if (error) *error = "cannot create " + path;
+            return false;
+        }
+        // Reserve the blocks now so that a write-back never finds the disk full.
+        // Filesystems without fallocate support still get a sparse file.
+        bool sized = posix_fallocate(fd, 0, static_cast<off_t>(bytes)) == 0 ||
+                     ftruncate(fd, static_cast<off_t>(bytes)) == 0;
+        if (sized) {
+            m = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (!sized) {
+            if (error) *error = "cannot allocate " + std::to_string(bytes) + " bytes in " + path;
+            return false;
+        }
+    }
+    if (m == MAP_FAILED) {
+        if (error) *error = "cannot map " + (path.empty() ? std::string("anonymous swap") : path);
+        return false;
+    }
+    base = static_cast<char*>(m);
+    length = bytes;
+    slot_size = slot_bytes;
+    slot_count = slots;
+    file_path = path;
+    // Pushed in reverse so that slots are handed out from the start of the file.
+    free_slots.clear();
+    for (int s = slots - 1; s >= 0; --s) free_slots.push_back(s);
+    references.assign(slots, 0);
+    return true;
+}
+
+void SwapDevice::close() {
+    if (base != nullptr) munmap(base, length);
+    base = nullptr;
+    length = 0;
+    slot_size = 0;
+    slot_count = 0;
+    free_slots.clear();
+    references.clear();
+    file_path.clear();
+}
+
+int SwapDevice::allocate() {
+    if (free_slots.empty()) return -1;
+    int s = free_slots.back();
+    free_slots.pop_back();
+    references[s] = 1;
+    return s;
+}
+
+void SwapDevice::release(int slot) {
+    if (--references[slot] == 0) free_slots.push_back(slot);
+}
@@ -0,0 +1,49 @@
+#ifndef SWAP_DEVICE_HPP
+#define SWAP_DEVICE_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Backing store for evicted dirty pages: a fixed number of equal slots in a
+// file that is preallocated up front and mapped shared, so writing a page
+// out is a copy into the mapping. Free slots are kept on a stack. A slot is
+// reference counted, since the page tables of forked processes can share it.
+class SwapDevice {
+public:
+    SwapDevice() = default;
+    ~SwapDevice();
+    SwapDevice(const SwapDevice&) = delete;
+    SwapDevice& operator=(const SwapDevice&) = delete;
+
+    // Creates or truncates `path` to `slots` slots of `slot_bytes` each and maps
+    // it. An empty path maps anonymous memory instead of a file.
+    bool open(const std::string& path, int slots, size_t slot_bytes, std::string* error = nullptr);
+    void close();
+
+    bool enabled() const { return base != nullptr; }
+    // A free slot holding one reference, or -1 if the device is full or closed.
+    int allocate();
+    void share(int slot) { references[slot]++; }
+    // Drops one reference; the slot is free again once none are left.
+    void release(int slot);
+    int referenceCount(int slot) const { return references[slot]; }
+    char* slot(int slot) { return base + static_cast<size_t>(slot) * slot_size; }
+    const char* slot(int slot) const { return base + static_cast<size_t>(slot) * slot_size; }
+
+    int slotCount() const { return slot_count; }
+    int slotsInUse() const { return slot_count - static_cast<int>(free_slots.size()); }
+    size_t slotBytes() const { return slot_size; }
+    const std::string& path() const { return file_path; }
+
+private:
+    char* base = nullptr;
+    size_t length = 0;
+    size_t slot_size = 0;
+    int slot_count = 0;
+    std::vector<int> free_slots;
+    std::vector<int> references;
+    std::string file_path;
+};
+
+#endif
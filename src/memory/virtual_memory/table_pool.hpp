@@ -0,0 +1,41 @@
+#ifndef TABLE_POOL_HPP
+#define TABLE_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Fixed-size allocator for page tables and page directories. Objects are carved
+// out of slabs that live as long as the pool; released objects go on a LIFO
+// free list so the most recently used (cache-warm) one is handed out next.
+// allocate() returns a value-initialized object.
+template <typename T>
+class TablePool {
+public:
+    explicit TablePool(size_t per_slab = 16) : per_slab(per_slab) {}
+    TablePool(const TablePool&) = delete;
+    TablePool& operator=(const TablePool&) = delete;
+
+    T* allocate() {
+        if (free_list.empty()) {
+            slabs.emplace_back(new T[per_slab]);
+            for (size_t i = per_slab; i-- > 0;) free_list.push_back(&slabs.back()[i]);
+        }
+        T* object = free_list.back();
+        free_list.pop_back();
+        *object = T();
+        return object;
+    }
+
+    void release(T* object) { free_list.push_back(object); }
+
+    size_t inUse() const { return capacity() - free_list.size(); }
+    size_t capacity() const { return slabs.size() * per_slab; }
+
+private:
+    size_t per_slab;
+    std::vector<std::unique_ptr<T[]>> slabs;
+    std::vector<T*> free_list;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include "tlb.hpp"
+
+std::string tlbReplacementToString(TlbReplacement policy) {
+    switch (policy) {
+        case TlbReplacement::LRU: return "LRU";
+        case TlbReplacement::FIFO: return "FIFO";
+        case TlbReplacement::RANDOM: return "RANDOM";
+    }
+    return "LRU";
+}
+
+bool parseTlbReplacement(const std::string& name, TlbReplacement& policy) {
+    if (name == "LRU" || name == "lru") policy = TlbReplacement::LRU;
+    else if (name == "FIFO" || name == "fifo") policy = TlbReplacement::FIFO;
+    else if (name == "RANDOM" || name == "random") policy = TlbReplacement::RANDOM;
+    else return false;
+    return true;
+}
+
+Tlb::Tlb(int entry_count, int way_count, TlbReplacement replacement)
+    : ways(way_count > 0 ? way_count : 1), replacement(replacement) {
+    sets = entry_count / ways;
+    if (sets > 0) entries.resize(static_cast<size_t>(sets) * ways);
+}
+
+PageTableEntry* Tlb::lookup(int pid, int vpn) {
+    if (entries.empty()) return nullptr;
+    Entry* way = set(pid, vpn);
+    for (int i = 0; i < ways; ++i) {
+        if (way[i].pid == pid && way[i].vpn == vpn) {
+            if (replacement == TlbReplacement::LRU) way[i].stamp = ++clock;
+            hit_count++;
+            return way[i].pte;
+        }
+    }
+    miss_count++;
+    return nullptr;
+}
+
+void Tlb::insert(int pid, int vpn, PageTableEntry* pte) {
+    if (entries.empty()) return;
+    Entry* way = set(pid, vpn);
+    Entry* victim = nullptr;
+    for (int i = 0; i < ways && victim == nullptr; ++i) {
+        if (way[i].pid == -1 || (way[i].pid == pid && way[i].vpn == vpn)) victim = &way[i];
+    }
+    if (victim == nullptr) {
+        if (replacement == TlbReplacement::RANDOM) {
+            // xorshift64: cheap and reproducible from run to run
+            random_state ^= random_state << 13;
+            random_state ^= random_state >> 7;
+            random_state ^= random_state << 17;
+            victim = &way[random_state % static_cast<uint64_t>(ways)];
+        } else {
+            victim = way;
+            for (int i = 1; i < ways; ++i) {
+                if (way[i].stamp < victim->stamp) victim = &way[i];
+            }
+        }
+    }
+    victim->pid = pid;
+    victim->vpn = vpn;
+    victim->pte = pte;
+    victim->stamp = ++clock;
+}
+
+void Tlb::invalidate(int pid, int vpn) {
+    if (entries.empty()) return;
+    Entry* way = set(pid, vpn);
+    for (int i = 0; i < ways; ++i) {
+        if (way[i].pid == pid && way[i].vpn == vpn) way[i] = Entry();
+    }
+}
+
+void Tlb::flush(int pid) {
+    for (Entry& entry : entries) {
+        if (entry.pid == pid) entry = Entry();
+    }
+}
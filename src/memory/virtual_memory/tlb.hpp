@@ -0,0 +1,68 @@
+#ifndef TLB_HPP
+#define TLB_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "memory/virtual_memory/memory_types.hpp"
+
+enum class TlbReplacement { LRU, FIFO, RANDOM };
+
+std::string tlbReplacementToString(TlbReplacement policy);
+bool parseTlbReplacement(const std::string& name, TlbReplacement& policy);
+
+// Shape of the TLB in front of the page tables. `entries` is rounded down to a
+// multiple of `ways`; 0 disables the TLB. A split TLB keeps one instruction
+// TLB (EXECUTE) and one data TLB (READ/WRITE), each of this size.
+struct TlbConfig {
+    int entries = 64;
+    int ways = 4;
+    TlbReplacement replacement = TlbReplacement::LRU;
+    bool split = false;
+};
+
+// Set-associative translation cache tagged with the process id, so it survives
+// context switches. An entry points at the page table entry it translates:
+// page table entries never move while valid, and a hit reads the current
+// permission bits without walking the directory.
+class Tlb {
+public:
+    Tlb() = default;
+    Tlb(int entries, int ways, TlbReplacement replacement);
+
+    // The cached translation of (pid, vpn), or nullptr on a miss.
+    PageTableEntry* lookup(int pid, int vpn);
+    void insert(int pid, int vpn, PageTableEntry* pte);
+    void invalidate(int pid, int vpn);
+    // Drop every translation of a process.
+    void flush(int pid);
+
+    bool enabled() const { return !entries.empty(); }
+    int size() const { return static_cast<int>(entries.size()); }
+    long long hits() const { return hit_count; }
+    long long misses() const { return miss_count; }
+
+private:
+    struct Entry {
+        int pid = -1;               // -1: empty
+        int vpn = 0;
+        PageTableEntry* pte = nullptr;
+        uint64_t stamp = 0;         // last use (LRU) or fill (FIFO)
+    };
+
+    std::vector<Entry> entries;     // sets * ways, one set after another
+    int sets = 0;
+    int ways = 0;
+    TlbReplacement replacement = TlbReplacement::LRU;
+    uint64_t clock = 0;
+    uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+    long long hit_count = 0;
+    long long miss_count = 0;
+
+    Entry* set(int pid, int vpn) {
+        uint32_t hash = static_cast<uint32_t>(vpn) ^ (static_cast<uint32_t>(pid) * 0x9E3779B1u);
+        return &entries[static_cast<size_t>(hash % static_cast<uint32_t>(sets)) * ways];
+    }
+};
+
+#endif
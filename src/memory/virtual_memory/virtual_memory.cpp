@@ -1,329 +1,1465 @@
 #include "virtual_memory.hpp"
 #include <iostream>
 #include <queue>
+#include <algorithm>
 #include <climits>
+#include <cstring>
+#include <unordered_map>
 #include <sstream>
 #include <iomanip>
 
 using namespace std;
 
+// What a swap slot holds. Pages have no contents in the simulator, so a slot
+// records whose page it is, and swap-ins check the page number. The pid may
+// differ: a forked child finds its parent's pages at the same numbers. Pages
+// of a shared-memory segment record their number within the segment.
+struct SwapRecord {
+    int32_t pid;
+    int32_t vpn;
+};
 
+std::string replacementPolicyToString(ReplacementPolicy policy) {
+    switch (policy) {
+        case ReplacementPolicy::FIFO: return "FIFO";
+        case ReplacementPolicy::LRU: return "LRU";
+        case ReplacementPolicy::CLOCK: return "CLOCK";
+        case ReplacementPolicy::OPT: return "OPT";
+        case ReplacementPolicy::ARC: return "ARC";
+        case ReplacementPolicy::TWO_Q: return "2Q";
+    }
+    return "UNKNOWN";
+}
+
+bool parseReplacementPolicy(const std::string& name, ReplacementPolicy& policy) {
+    if (name == "FIFO") policy = ReplacementPolicy::FIFO;
+    else if (name == "LRU") policy = ReplacementPolicy::LRU;
+    else if (name == "CLOCK") policy = ReplacementPolicy::CLOCK;
+    else if (name == "OPT") policy = ReplacementPolicy::OPT;
+    else if (name == "ARC") policy = ReplacementPolicy::ARC;
+    else if (name == "2Q") policy = ReplacementPolicy::TWO_Q;
+    else return false;
+    return true;
+}
 
-VirtualMemoryManager::VirtualMemoryManager(int memorySize, int pageSize, ReplacementPolicy policy)
-    : pageSize(pageSize), pageFaults(0), accessCounter(0), policy(policy), clockHand(0)
+VirtualMemoryManager::VirtualMemoryManager(int memorySize, int pageSize, ReplacementPolicy policy, std::ostream& out)
+    : pageSize(pageSize), pageFaults(0), clockHand(0), accessCounter(0),
+      cowCopies(0), minorFaults(0), swapIns(0), cleanEvictions(0), writebacks(0), faultTicks(0),
+      prefetched(0), prefetchUseful(0), prefetchWasted(0), policy(policy), out(&out), out_sink(out), logger(out_sink),
+      futurePosition(0), currentNextUse(LLONG_MAX), arcTarget(0.0)
 {
     totalFrames = memorySize / pageSize;
-    frameTable.resize(totalFrames, {NULL, -1});
+    if (totalFrames > MAX_FRAME_NUMBER + 1)
+    {
+        MOSKS_LOG(logger, NORMAL, "Error: " << totalFrames << " frames do not fit in a page table entry; using "
+                  << MAX_FRAME_NUMBER + 1 << ".");
+        totalFrames = MAX_FRAME_NUMBER + 1;
+    }
+    frameTable.resize(totalFrames);
+    // Pushed in reverse so that an empty memory fills from frame 0 upwards.
+    for (int frame = totalFrames - 1; frame >= 0; --frame)
+    {
+        freeFrames.push_back(frame);
+    }
+    configureTlb(TlbConfig());
+}
+
+void VirtualMemoryManager::configureTlb(const TlbConfig& config)
+{
+    tlbConfig = config;
+    dtlb = Tlb(config.entries, config.ways, config.replacement);
+    itlb = config.split ? Tlb(config.entries, config.ways, config.replacement) : Tlb();
 }
 
-void VirtualMemoryManager::log(LogLevel level, const string &message) const
+bool VirtualMemoryManager::configureSwap(int slots, const std::string& path, std::string* error)
 {
-    if (current_log_level >= level)
+    bool in_use = swap.slotsInUse() > 0;
+    if (in_use)
+    {
+        if (error) *error = std::to_string(swap.slotsInUse()) + " swap slots are still in use";
+        return false;
+    }
+    if (slots <= 0)
+    {
+        swap.close();
+        return true;
+    }
+    if (slots > MAX_FRAME_NUMBER + 1)
     {
-        cout << message << endl;
+        if (error) *error = "at most " + std::to_string(MAX_FRAME_NUMBER + 1) + " swap slots fit in a page table entry";
+        return false;
     }
+    return swap.open(path, slots, std::max<size_t>(pageSize, sizeof(SwapRecord)), error);
 }
 
 void VirtualMemoryManager::setLogLevel(LogLevel level)
 {
-    current_log_level = level;
+    logger.setLevel(level);
+}
+
+void VirtualMemoryManager::setOutput(std::ostream& stream)
+{
+    out = &stream;
+    out_sink.setStream(stream);
+}
+
+void VirtualMemoryManager::setLogSink(LogSink* sink)
+{
+    logger.setSink(sink != nullptr ? *sink : out_sink);
 }
 
 void VirtualMemoryManager::allocateProcess(ProcessControlBlock& pcb)
 {
     pcb.page_directory = PageDirectory();
-    log(NORMAL, "Initialized page directory for process " + to_string(pcb.process_id) + ".");
+    MOSKS_LOG(logger, NORMAL, "Initialized page directory for process " << pcb.process_id << ".");
 }
 
 // Set page permission
 void VirtualMemoryManager::setPagePermissions(ProcessControlBlock& pcb, int virtualPageNumber, bool read, bool write, bool execute)
 {
-    
+    if (virtualPageNumber < 0 || virtualPageNumber >= MAX_VIRTUAL_PAGES)
+    {
+        MOSKS_LOG(logger, NORMAL, "Invalid virtual page " << virtualPageNumber << " for P" << pcb.process_id << ".");
+        return;
+    }
     int pdi = virtualPageNumber / PAGE_TABLE_SIZE;
     int pti = virtualPageNumber % PAGE_TABLE_SIZE;
 
-    PageDirectory &pd = pcb.page_directory;
+    PageTable &pt = tableFor(pcb.page_directory, pdi);
+    PageTableEntry &pte = pt[pti];
 
-    if (pd.find(pdi) == pd.end() || !pd.at(pdi).valid)
+    if (!pte.configured)
     {
-        log(DEBUG, "Creating page table for PDI " + to_string(pdi) + " to set permissions.");
-        PageTable *newPageTable = new PageTable();
-        pd[pdi].pageTable = newPageTable;
-        pd[pdi].valid = true;
+        pte.configured = true;
+        pt.configured++;
     }
-
-    PageTable *pt = pd.at(pdi).pageTable;
-    PageTableEntry &pte = (*pt)[pti];
-
     pte.can_read = read;
-    pte.can_write = write;
     pte.can_execute = execute;
+    if (pte.cow)
+    {
+        // Still shared: writes have to make a copy first.
+        pte.cow = write;
+    }
+    else
+    {
+        pte.can_write = write;
+    }
+
+    MOSKS_LOG(logger, VERBOSE, "Permissions for P" << pcb.process_id << " VP " << virtualPageNumber << " set to: R=" << (read ? "1" : "0") << " W=" << (write ? "1" : "0") << " X=" << (execute ? "1" : "0"));
+}
+
+void VirtualMemoryManager::listUnlink(int frame)
+{
+    FrameDescriptor &f = frameTable[frame];
+    FrameList &l = lists[f.list];
+    (f.prev != -1 ? frameTable[f.prev].next : l.head) = f.next;
+    (f.next != -1 ? frameTable[f.next].prev : l.tail) = f.prev;
+    f.prev = f.next = -1;
+    l.size--;
+}
 
-    log(VERBOSE, "Permissions for P" + to_string(pcb.process_id) + " VP " + to_string(virtualPageNumber) + " set to: R=" + (read ? "1" : "0") + " W=" + (write ? "1" : "0") + " X=" + (execute ? "1" : "0"));
+void VirtualMemoryManager::listPushBack(int frame, int list)
+{
+    FrameDescriptor &f = frameTable[frame];
+    FrameList &l = lists[list];
+    f.list = list;
+    f.prev = l.tail;
+    f.next = -1;
+    (l.tail != -1 ? frameTable[l.tail].next : l.head) = frame;
+    l.tail = frame;
+    l.size++;
+}
+
+void VirtualMemoryManager::setFutureAccesses(const std::vector<MemoryAccess>& accesses)
+{
+    nextUses.assign(accesses.size(), LLONG_MAX);
+    std::unordered_map<uint64_t, long long> seen;
+    for (size_t i = accesses.size(); i-- > 0;)
+    {
+        auto inserted = seen.emplace(GhostList::key(accesses[i].pid, accesses[i].vpn), static_cast<long long>(i));
+        if (!inserted.second)
+        {
+            nextUses[i] = inserted.first->second;
+            inserted.first->second = static_cast<long long>(i);
+        }
+    }
+    futurePosition = 0;
+}
+
+// The page table of region `pdi`, allocating the directory and the table on first use.
+PageTable& VirtualMemoryManager::tableFor(PageDirectory& pd, int pdi)
+{
+    if (pd.entries == nullptr)
+    {
+        pd.entries = directoryPool.allocate();
+    }
+    PageTable*& table = pd.entries->tables[pdi];
+    if (table == nullptr)
+    {
+        MOSKS_LOG(logger, VERBOSE, "Directory Miss for PDI " << pdi << ". Allocating new page table.");
+        table = tablePool.allocate();
+        pd.table_count++;
+    }
+    return *table;
+}
+
+// Return an empty page table to the pool, and the directory once it has no tables left.
+void VirtualMemoryManager::releaseTable(PageDirectory& pd, int pdi)
+{
+    tablePool.release(pd.entries->tables[pdi]);
+    pd.entries->tables[pdi] = nullptr;
+    if (--pd.table_count == 0)
+    {
+        directoryPool.release(pd.entries);
+        pd.entries = nullptr;
+    }
+}
+
+// Whether `pte` lets `type` through. A copy-on-write page counts as writable.
+static bool permits(const PageTableEntry& pte, AccessType type)
+{
+    switch (type)
+    {
+    case AccessType::READ:
+        return pte.can_read;
+    case AccessType::WRITE:
+        return pte.can_write || pte.cow;
+    case AccessType::EXECUTE:
+        return pte.can_execute;
+    }
+    return false;
 }
 
 // Access Page
 void VirtualMemoryManager::accessPage(ProcessControlBlock& pcb, int virtualPageNumber, AccessType type)
 {
+    if (policy == ReplacementPolicy::OPT)
+    {
+        currentNextUse = futurePosition < nextUses.size() ? nextUses[futurePosition++] : LLONG_MAX;
+    }
+    pcb.page_directory.fault_rate.access(residentConfig.fault_window);
+    faultRate.access(residentConfig.fault_window);
+
+    // A TLB hit skips the page walk entirely.
+    Tlb& tlb = (type == AccessType::EXECUTE && tlbConfig.split) ? itlb : dtlb;
+    if (PageTableEntry* cached = tlb.lookup(pcb.process_id, virtualPageNumber))
+    {
+        completeAccess(pcb, virtualPageNumber, *cached, type);
+        return;
+    }
 
+    if (virtualPageNumber < 0 || virtualPageNumber >= MAX_VIRTUAL_PAGES)
+    {
+        MOSKS_LOG(logger, NORMAL, "Invalid virtual page " << virtualPageNumber << " for P" << pcb.process_id << ".");
+        return;
+    }
     int pdi = virtualPageNumber / PAGE_TABLE_SIZE;
     int pti = virtualPageNumber % PAGE_TABLE_SIZE;
 
-    log(DEBUG, "Translating VP " + to_string(virtualPageNumber) + " -> PDI: " + to_string(pdi) + ", PTI: " + to_string(pti));
+    MOSKS_LOG(logger, DEBUG, "Translating VP " << virtualPageNumber << " -> PDI: " << pdi << ", PTI: " << pti);
 
-    PageDirectory &pd = pcb.page_directory;
+    PageTable &pt = tableFor(pcb.page_directory, pdi);
+    PageTableEntry &pte = pt[pti];
 
-    if (pd.find(pdi) == pd.end() || pd.at(pdi).valid == false)
+    if (!pte.valid && pte.configured && !permits(pte, type))
     {
-        log(VERBOSE, "Directory Miss for PDI " + to_string(pdi) + ". Allocating new page table.");
-        PageTable *newPageTable = new PageTable();
-        pd[pdi].pageTable = newPageTable;
-        pd[pdi].valid = true;
+        // Nothing to load for an access that would be refused anyway.
+        protectionFault(pcb, type);
     }
+    else if (!pte.valid)
+    {
+        MOSKS_LOG(logger, VERBOSE, "Page fault at P" << pcb.process_id << " VP " << virtualPageNumber);
+        handlePageFault(pcb, virtualPageNumber, pt, pti, type);
+        if (readaheadConfig.max_window > 0 && policy != ReplacementPolicy::OPT && pte.valid)
+        {
+            sequentialFault(pcb, virtualPageNumber);
+        }
+    }
+    else
+    {
+        completeAccess(pcb, virtualPageNumber, pte, type);
+    }
+
+    if (pte.valid)
+    {
+        tlb.insert(pcb.process_id, virtualPageNumber, &pte);
+    }
+}
 
-    PageTable *pt = pd.at(pdi).pageTable;
+void VirtualMemoryManager::protectionFault(const ProcessControlBlock& pcb, AccessType type)
+{
+    MOSKS_LOG(logger, NORMAL, "!!! PROTECTION FAULT: P" << pcb.process_id << " attempted to " << (type == AccessType::WRITE ? "WRITE" : (type == AccessType::READ ? "READ" : "EXECUTE")) << " a page with no permission. Access denied.");
+}
 
-    if (pt->find(pti) == pt->end() || pt->at(pti).valid == false)
+// Permission check and bookkeeping for an access to a resident page.
+void VirtualMemoryManager::completeAccess(ProcessControlBlock& pcb, int virtualPageNumber, PageTableEntry& pte, AccessType type)
+{
+    if (policy == ReplacementPolicy::OPT)
     {
-        log(VERBOSE, "Page fault at P" + to_string(pcb.process_id) + " VP " + to_string(virtualPageNumber));
-        handlePageFault(pcb, virtualPageNumber, *pt, pti);
+        // Belady only looks at the reference string, granted or not.
+        int frame = pte.frameNumber;
+        FrameDescriptor &f = frameTable[frame];
+        optOrder.erase({f.next_use, frame});
+        f.next_use = currentNextUse;
+        optOrder.insert({f.next_use, frame});
     }
-    else
+
+    if (type == AccessType::WRITE && pte.cow && !copyOnWrite(pcb, virtualPageNumber, pte))
     {
-        PageTableEntry &pte = pt->at(pti);
-        bool permission_granted = false;
-        switch (type)
-        {
-        case AccessType::READ:
-            if (pte.can_read)
-                permission_granted = true;
-            break;
-        case AccessType::WRITE:
-            if (pte.can_write)
-                permission_granted = true;
-            break;
-        case AccessType::EXECUTE:
-            if (pte.can_execute)
-                permission_granted = true;
-            break;
-        }
-
-        if (!permission_granted)
-        {
-            log(NORMAL, "!!! PROTECTION FAULT: P" + to_string(pcb.process_id) + " attempted to " + (type == AccessType::WRITE ? "WRITE" : (type == AccessType::READ ? "READ" : "EXECUTE")) + " a page with no permission. Access denied.");
-            return;
+        return;
+    }
+
+    if (!permits(pte, type))
+    {
+        protectionFault(pcb, type);
+        return;
+    }
+
+    MOSKS_LOG(logger, VERBOSE, "Page access successful for P" << pcb.process_id << " VP " << virtualPageNumber << ".");
+    pte.lastAccessTime = accessCounter++;
+    pte.referenced = true;
+    if (type == AccessType::WRITE)
+    {
+        pte.dirty = true;
+    }
+
+    int frame = pte.frameNumber;
+    if (frameTable[frame].prefetched)
+    {
+        prefetchedHit(pcb, virtualPageNumber, frame);
+    }
+    touchFrame(frame);
+    int physicalAddress = frame * pageSize;
+    MOSKS_LOG(logger, DEBUG, "-> Physical Address: " << physicalAddress << " (Frame " << frame << ")");
+}
+
+// Reorders the replacement lists after a granted access to a resident page.
+void VirtualMemoryManager::touchFrame(int frame) {
+    FrameDescriptor &f = frameTable[frame];
+    switch (policy) {
+    case ReplacementPolicy::LRU:
+        if (frame != lists[0].tail) {
+            listUnlink(frame);
+            listPushBack(frame, 0);
         }
+        break;
+    case ReplacementPolicy::ARC:
+        // A second use promotes a page from T1 to T2.
+        listUnlink(frame);
+        listPushBack(frame, 1);
+        break;
+    case ReplacementPolicy::TWO_Q:
+        // Hits in A1in leave it alone; Am is kept in LRU order.
+        if (f.list == 1) {
+            listUnlink(frame);
+            listPushBack(frame, 1);
+        }
+        break;
+    default:
+        break;
+    }
+}
 
-        log(VERBOSE, "Page access successful for P" + to_string(pcb.process_id) + " VP " + to_string(virtualPageNumber) + ".");
-        pte.lastAccessTime = accessCounter++;
-        pte.referenced = true;
+void VirtualMemoryManager::handlePageFault(ProcessControlBlock& pcb, int virtualPageNumber, PageTable &pt, int pti, AccessType type) {
+    countFault(pcb);
+    int slot = pt[pti].swapped ? static_cast<int>(pt[pti].frameNumber) : -1;
+    MOSKS_LOG(logger, VERBOSE, "Handling page fault...");
 
-        int frame = pte.frameNumber;
-        int physicalAddress = frame * pageSize;
-        stringstream ss_pa;
-        ss_pa << "-> Physical Address: " << physicalAddress << " (Frame " << frame << ")";
-        log(DEBUG, ss_pa.str());
+    // A page of a shared segment that another process has resident is simply
+    // mapped; otherwise it comes from the segment's swap slot, if any.
+    int segment = -1, segment_page = -1;
+    if (const SegmentAttachment* attachment = pcb.page_directory.attachment(virtualPageNumber)) {
+        segment = attachment->segment;
+        segment_page = virtualPageNumber - attachment->base;
+        int resident = segments[segment].frames[segment_page];
+        if (resident != -1) {
+            minorFaults++;
+            if (pcb.page_directory.resident_limit > 0 && pcb.page_directory.resident_pages >= pcb.page_directory.resident_limit) {
+                // The mapping counts against the limit even though the frame is shared.
+                int victim = localVictim(pcb);
+                evictFrame(victim, &pt);
+                freeFrames.push_back(victim);
+            }
+            MOSKS_LOG(logger, VERBOSE, "P" << pcb.process_id << " VP " << virtualPageNumber << " maps frame " << resident
+                      << " of segment " << segments[segment].name << ".");
+            mapPage(resident, pcb, virtualPageNumber, pt, pti);
+            pt[pti].dirty = type == AccessType::WRITE;
+            touchFrame(resident);
+            return;
+        }
+        slot = segments[segment].slots[segment_page];
+    }
+
+    int list = 0;
+    int frame = obtainFrame(pcb, virtualPageNumber, pt, list);
+    if (frame == -1) {
+        return;
     }
+    mapFrame(frame, pcb, virtualPageNumber, pt, pti, list);
+    if (segment != -1) {
+        frameTable[frame].segment = segment;
+        frameTable[frame].segment_page = segment_page;
+        segments[segment].frames[segment_page] = frame;
+    }
+    if (slot != -1) {
+        swapIn(frame, pt[pti], pt, slot);
+    }
+    // The faulting access itself: a write leaves the page dirty.
+    pt[pti].dirty = type == AccessType::WRITE;
 }
 
-void VirtualMemoryManager::handlePageFault(ProcessControlBlock& pcb, int virtualPageNumber, PageTable &pt, int pti) {
+void VirtualMemoryManager::countFault(ProcessControlBlock& pcb) {
     pageFaults++;
-    log(VERBOSE, "Handling page fault...");
+    faultTicks += faultLatency.fault;
+    pcb.page_directory.faults++;
+    pcb.page_directory.fault_rate.faults++;
+    faultRate.faults++;
+}
 
-    // Find a free frame first
-    for (int i = 0; i < totalFrames; ++i) {
-        if (frameTable[i].first == nullptr) {
-            log(VERBOSE, "Found free frame " + to_string(i) + ".");
-            frameTable[i] = {&pcb, virtualPageNumber};
-            pt[pti].frameNumber = i;
-            pt[pti].valid = true;
-            pt[pti].lastAccessTime = accessCounter++;
-            pt[pti].referenced = true;
-            pt[pti].can_read = true;
-            pt[pti].can_write = true;
-            pt[pti].can_execute = false;
-            if (policy == ReplacementPolicy::FIFO) {
-                pageQueue.push({pcb.process_id, virtualPageNumber});
+// A frame for a new page of `pcb`: a free one, or the one the replacement
+// policy evicts, or the process's own least recently used page when it has to
+// replace locally. -1 if there is none. Sets the replacement list to join.
+int VirtualMemoryManager::obtainFrame(ProcessControlBlock& pcb, int virtualPageNumber, const PageTable& pt, int& list) {
+    bool local = replacesLocally(pcb);
+    bool full = freeFrames.empty();
+    int frame = replacementMiss(GhostList::key(pcb.process_id, virtualPageNumber), full && !local, list);
+    if (local) {
+        frame = localVictim(pcb);
+        MOSKS_LOG(logger, VERBOSE, "P" << pcb.process_id << " replaces one of its own pages.");
+    } else if (!full) {
+        frame = freeFrames.back();
+        freeFrames.pop_back();
+        MOSKS_LOG(logger, VERBOSE, "Found free frame " << frame << ".");
+        return frame;
+    } else {
+        MOSKS_LOG(logger, VERBOSE, "No free frames. Starting replacement...");
+    }
+    if (frame == -1) {
+        MOSKS_LOG(logger, NORMAL, "CRITICAL ERROR: Could not determine a victim frame!");
+        return -1;
+    }
+    evictFrame(frame, &pt);
+    return frame;
+}
+
+// At its resident limit a process always replaces its own pages; under local
+// replacement, it does so whenever memory is full.
+bool VirtualMemoryManager::replacesLocally(const ProcessControlBlock& pcb) const {
+    const PageDirectory &pd = pcb.page_directory;
+    if (pd.resident_pages == 0) {
+        return false;
+    }
+    if (pd.resident_limit > 0 && pd.resident_pages >= pd.resident_limit) {
+        return true;
+    }
+    return residentConfig.local_replacement && freeFrames.empty();
+}
+
+// The process's least recently used resident page, preferring frames no other
+// process maps, whose eviction would not take a page from anyone else.
+int VirtualMemoryManager::localVictim(const ProcessControlBlock& pcb) const {
+    int victim = -1;
+    bool victim_shared = true;
+    uint64_t oldest = 0;
+    for (int m = pcb.page_directory.first_mapping; m != -1; m = mappings[m].owner_next) {
+        const FrameMapping &mapping = mappings[m];
+        bool shared = frameTable[mapping.frame].mappers > 1;
+        uint64_t time = mapping.pte->lastAccessTime;
+        if (victim == -1 || (victim_shared && !shared) || (shared == victim_shared && time < oldest)) {
+            victim = mapping.frame;
+            victim_shared = shared;
+            oldest = time;
+        }
+    }
+    return victim;
+}
+
+// Reads the page in `slot` into `frame`. The slot keeps its copy, so the page
+// can be dropped again for free as long as it stays clean. A segment's slot
+// stays with the segment.
+void VirtualMemoryManager::swapIn(int frame, PageTableEntry& pte, PageTable& pt, int slot) {
+    FrameDescriptor &f = frameTable[frame];
+    int page = f.segment != -1 ? f.segment_page : f.vpn;
+    SwapRecord record;
+    std::memcpy(&record, swap.slot(slot), sizeof(record));
+    if (record.vpn != page) {
+        MOSKS_LOG(logger, NORMAL, "CRITICAL ERROR: swap slot " << slot << " holds P" << record.pid << " VP " << record.vpn
+                  << ", expected P" << f.owner->process_id << " VP " << page << ".");
+    }
+    MOSKS_LOG(logger, VERBOSE, "Swapped in P" << f.owner->process_id << " VP " << f.vpn << " from slot " << slot << ".");
+    if (f.segment == -1) {
+        pte.swapped = false;
+        pt.swapped--;
+        f.swap_slot = slot;
+    }
+    swapIns++;
+    faultTicks += faultLatency.swap_in;
+}
+
+// The stream keeps the window it is in and the one ahead resident, and each
+// window pushed out the pages used before the previous one; a quarter of
+// memory per window lets all of that fit.
+int VirtualMemoryManager::maxReadahead() const {
+    return std::min(readaheadConfig.max_window, std::max(1, totalFrames / 4));
+}
+
+// A demand fault that continues a constant stride opens or doubles the
+// readahead window; any other fault ends the stream.
+void VirtualMemoryManager::sequentialFault(ProcessControlBlock& pcb, int virtualPageNumber) {
+    ReadaheadState &ra = pcb.page_directory.readahead;
+    int delta = virtualPageNumber - ra.last;
+    if (ra.last != -1 && delta != 0 && delta == ra.stride) {
+        ra.window = ra.window > 0 ? std::min(2 * ra.window, maxReadahead())
+                                  : std::min(readaheadConfig.initial_window, maxReadahead());
+        readahead(pcb, virtualPageNumber + delta, delta, ra.window);
+    } else {
+        ra.stride = ra.last != -1 ? delta : 0;
+        ra.window = 0;
+        ra.marker = -1;
+    }
+    ra.last = virtualPageNumber;
+}
+
+// First use of a prefetched page. Reaching the marker fetches the next window.
+void VirtualMemoryManager::prefetchedHit(ProcessControlBlock& pcb, int virtualPageNumber, int frame) {
+    frameTable[frame].prefetched = false;
+    prefetchUseful++;
+    ReadaheadState &ra = pcb.page_directory.readahead;
+    ra.last = virtualPageNumber;
+    if (virtualPageNumber == ra.marker && ra.window > 0) {
+        ra.window = std::min(2 * ra.window, maxReadahead());
+        readahead(pcb, ra.next, ra.stride, ra.window);
+    }
+}
+
+// Loads up to `count` pages from `start` on, `stride` apart, in one batch. The
+// page table is looked up once per region rather than once per page, and the
+// free frames for the whole window come off the free stack together; only
+// the rest is taken from the replacement policy. Prefetched pages do not pay
+// the fault trap, only what making room and swapping in cost.
+void VirtualMemoryManager::readahead(ProcessControlBlock& pcb, int start, int stride, int count) {
+    PageDirectory &pd = pcb.page_directory;
+    ReadaheadState &ra = pd.readahead;
+    readaheadPages.clear();
+    // A process that replaces its own pages only reads ahead into free
+    // frames, and never past its resident limit.
+    size_t budget = static_cast<size_t>(count);
+    if (pd.resident_limit > 0) {
+        budget = std::min<size_t>(budget, std::max(0, pd.resident_limit - pd.resident_pages));
+    }
+    if (pd.resident_limit > 0 || residentConfig.local_replacement) {
+        budget = std::min(budget, freeFrames.size());
+    }
+    long long vpn = start;
+    for (int i = 0; i < count && vpn >= 0 && vpn < MAX_VIRTUAL_PAGES && readaheadPages.size() < budget; ++i, vpn += stride) {
+        // Shared segments are left to their demand faults.
+        const PageTableEntry* pte = pd.find(static_cast<int>(vpn));
+        if ((pte == nullptr || !pte->valid) && pd.attachment(static_cast<int>(vpn)) == nullptr) {
+            readaheadPages.push_back(static_cast<int>(vpn));
+        }
+    }
+    ra.next = static_cast<int>(std::max(-1LL, std::min<long long>(vpn, MAX_VIRTUAL_PAGES)));
+    ra.marker = -1;
+
+    size_t reserved = std::min(readaheadPages.size(), freeFrames.size());
+    size_t first_free = freeFrames.size() - reserved;
+    PageTable* pt = nullptr;
+    int table_pdi = -1;
+    for (size_t i = 0; i < readaheadPages.size(); ++i) {
+        int page = readaheadPages[i];
+        int pdi = page / PAGE_TABLE_SIZE;
+        int pti = page % PAGE_TABLE_SIZE;
+        if (pdi != table_pdi) {
+            pt = &tableFor(pd, pdi);
+            table_pdi = pdi;
+        }
+        bool full = i >= reserved;
+        int list = 0;
+        int frame = replacementMiss(GhostList::key(pcb.process_id, page), full, list);
+        if (!full) {
+            frame = freeFrames[freeFrames.size() - 1 - i];
+        } else {
+            if (i == reserved) {
+                freeFrames.resize(first_free);
             }
-            return;
+            if (frame == -1) {
+                break;
+            }
+            evictFrame(frame, pt);
+        }
+        PageTableEntry &pte = (*pt)[pti];
+        int slot = pte.swapped ? static_cast<int>(pte.frameNumber) : -1;
+        mapFrame(frame, pcb, page, *pt, pti, list);
+        if (slot != -1) {
+            swapIn(frame, pte, *pt, slot);
+        }
+        // Not used yet: CLOCK may take it back before pages that were.
+        pte.referenced = false;
+        frameTable[frame].prefetched = true;
+        prefetched++;
+        if (ra.marker == -1) {
+            ra.marker = page;
         }
     }
+    freeFrames.resize(std::min(freeFrames.size(), first_free));
+    MOSKS_LOG(logger, VERBOSE, "Readahead for P" << pcb.process_id << ": " << readaheadPages.size()
+              << " pages from VP " << start << " (stride " << stride << ").");
+}
 
-    log(VERBOSE, "No free frames. Starting replacement...");
-    int victimFrame = -1;
+// The policy's bookkeeping for a miss on `page`: sets the replacement list it
+// joins and, when memory is `full`, returns the frame to evict (-1 if none).
+int VirtualMemoryManager::replacementMiss(uint64_t page, bool full, int& list) {
+    list = 0;
+    if (policy == ReplacementPolicy::ARC) {
+        return arcMiss(page, full, list);
+    }
+    if (policy == ReplacementPolicy::TWO_Q) {
+        return twoQMiss(page, full, list);
+    }
+    return full ? selectVictim() : -1;
+}
 
-    // --- UPDATED REPLACEMENT LOGIC ---
-    if (policy == ReplacementPolicy::FIFO) {
-        if (!pageQueue.empty()) {
-            auto toEvict = pageQueue.front();
-            pageQueue.pop();
-            // Find the frame containing the page to evict
-            for(int i = 0; i < totalFrames; ++i) {
-                if(frameTable[i].first->process_id == toEvict.first && frameTable[i].second == toEvict.second) {
-                    victimFrame = i;
-                    break;
-                }
+// Chooses an occupied frame to evict under FIFO, LRU, CLOCK or OPT; -1 if there is none.
+int VirtualMemoryManager::selectVictim() {
+    if (totalFrames == 0) {
+        return -1;
+    }
+    if (policy == ReplacementPolicy::CLOCK) {
+        // Second chance: the hand clears referenced bits until it finds a frame
+        // that was not used since the last sweep, at most one revolution later.
+        while (true) {
+            int frame = clockHand;
+            clockHand = (clockHand + 1) % totalFrames;
+            // A shared frame counts as used if any of its mappers used it.
+            bool referenced = false;
+            for (int m = frameTable[frame].first_mapping; m != -1; m = mappings[m].next_mapper) {
+                referenced = referenced || mappings[m].pte->referenced;
+                mappings[m].pte->referenced = false;
+            }
+            if (!referenced) {
+                return frame;
             }
         }
     }
-    else if (policy == ReplacementPolicy::LRU) {
-        unsigned long minAccessTime = ULONG_MAX;
-        for (int i = 0; i < totalFrames; ++i) {
-            ProcessControlBlock* victimPcb = frameTable[i].first;
-            int vpn = frameTable[i].second;
-            int victim_pdi = vpn / PAGE_TABLE_SIZE;
-            int victim_pti = vpn % PAGE_TABLE_SIZE;
-            if (victimPcb->page_directory.at(victim_pdi).pageTable->at(victim_pti).lastAccessTime < minAccessTime) {
-                minAccessTime = victimPcb->page_directory.at(victim_pdi).pageTable->at(victim_pti).lastAccessTime;
-                victimFrame = i;
+    if (policy == ReplacementPolicy::OPT) {
+        return optOrder.empty() ? -1 : optOrder.rbegin()->second;
+    }
+    // FIFO never reorders the list and LRU moves a frame to the tail on every
+    // use, so the head is the oldest load or the least recent use.
+    return lists[0].head;
+}
+
+// ARC (Megiddo and Modha) on a miss for `page`. Adapts the target size of T1
+// when the page is a ghost, trims the ghost lists, sets the list the page
+// joins, and returns the frame to evict when memory is `full`. Pages evicted
+// from T1 and T2 are remembered in B1 and B2.
+int VirtualMemoryManager::arcMiss(uint64_t page, bool full, int& list) {
+    const double capacity = totalFrames;
+    bool in_b2 = false;
+    if (arcB1.contains(page)) {
+        // Evicted from T1 too early: give recency more room.
+        arcTarget = std::min(capacity, arcTarget + std::max(1.0, static_cast<double>(arcB2.size()) / arcB1.size()));
+        arcB1.erase(page);
+        list = 1;
+    } else if (arcB2.contains(page)) {
+        // Evicted from T2 too early: give frequency more room.
+        arcTarget = std::max(0.0, arcTarget - std::max(1.0, static_cast<double>(arcB1.size()) / arcB2.size()));
+        arcB2.erase(page);
+        in_b2 = true;
+        list = 1;
+    } else {
+        list = 0;
+        size_t recent = lists[0].size + arcB1.size();
+        size_t all = recent + lists[1].size + arcB2.size();
+        if (recent >= static_cast<size_t>(totalFrames)) {
+            if (lists[0].size < totalFrames) {
+                arcB1.popFront();
+            } else if (full) {
+                return lists[0].head;   // T1 fills memory: drop its oldest page without a ghost
             }
+        } else if (all >= 2 * static_cast<size_t>(totalFrames)) {
+            arcB2.popFront();
         }
     }
-    // ... Clock policy would also need updating here ...
+    if (!full || totalFrames == 0) {
+        return -1;
+    }
 
-    // --- Common eviction logic ---
-    if (victimFrame != -1) {
-        ProcessControlBlock* victimPcb = frameTable[victimFrame].first;
-        int victimVpn = frameTable[victimFrame].second;
-        log(VERBOSE, "Evicting P" + to_string(victimPcb->process_id) + " VP" + to_string(victimVpn) + " from frame " + to_string(victimFrame) + ".");
+    int t1 = lists[0].size;
+    int from = (t1 >= 1 && (t1 > arcTarget || (in_b2 && t1 == arcTarget))) ? 0 : 1;
+    if (lists[from].size == 0) {
+        from = 1 - from;
+    }
+    int victim = lists[from].head;
+    const FrameDescriptor &f = frameTable[victim];
+    (from == 0 ? arcB1 : arcB2).pushBack(GhostList::key(f.owner->process_id, f.vpn));
+    return victim;
+}
 
-        int victim_pdi = victimVpn / PAGE_TABLE_SIZE;
-        int victim_pti = victimVpn % PAGE_TABLE_SIZE;
-        PageTable* victimPT = victimPcb->page_directory.at(victim_pdi).pageTable;
-        victimPT->at(victim_pti).valid = false;
-        victimPT->at(victim_pti).frameNumber = -1;
+// 2Q (Johnson and Shasha) on a miss for `page`. New pages enter the FIFO A1in;
+// a page that comes back while remembered in A1out joins the LRU list Am.
+// A1in is emptied first once it holds more than a quarter of memory, and
+// A1out remembers as many pages as half of memory.
+int VirtualMemoryManager::twoQMiss(uint64_t page, bool full, int& list) {
+    list = twoQOut.erase(page) ? 1 : 0;
+    if (!full || totalFrames == 0) {
+        return -1;
+    }
+    int in_limit = std::max(1, totalFrames / 4);
+    size_t out_limit = static_cast<size_t>(std::max(1, totalFrames / 2));
+    if (lists[0].size > in_limit || lists[1].size == 0) {
+        int victim = lists[0].head;
+        const FrameDescriptor &f = frameTable[victim];
+        twoQOut.pushBack(GhostList::key(f.owner->process_id, f.vpn));
+        while (twoQOut.size() > out_limit) {
+            twoQOut.popFront();
+        }
+        return victim;
+    }
+    return lists[1].head;
+}
 
-        frameTable[victimFrame] = {&pcb, virtualPageNumber};
-        pt[pti].frameNumber = victimFrame;
-        pt[pti].valid = true;
-        pt[pti].lastAccessTime = accessCounter++;
-        pt[pti].referenced = true;
-        pt[pti].can_read = true;
-        pt[pti].can_write = true;
-        pt[pti].can_execute = false;
+// Unmaps the page held by `frame` from every process that maps it. A page
+// table is returned to the pool once none of its pages are resident or in
+// swap, unless it is the table the faulting page is about to be mapped into.
+void VirtualMemoryManager::evictFrame(int frame, const PageTable* faulting_table) {
+    FrameDescriptor &f = frameTable[frame];
+    ProcessControlBlock* victimPcb = f.owner;
+    MOSKS_LOG(logger, VERBOSE, "Evicting P" << victimPcb->process_id << " VP" << f.vpn << " from frame " << frame
+              << (f.mappers > 1 ? " (shared)" : "") << ".");
 
-        if (policy == ReplacementPolicy::FIFO) {
-            pageQueue.push({pcb.process_id, virtualPageNumber});
+    // A clean page is dropped: it is either unchanged since it was loaded or
+    // identical to its copy in swap. A dirty one is written back first, to a
+    // new slot if its old one is still shared with a process that forked.
+    // Segment pages go to the segment's slot, which only the segment holds.
+    bool dirty = false;
+    for (int m = f.first_mapping; m != -1; m = mappings[m].next_mapper) {
+        dirty = dirty || mappings[m].pte->dirty;
+    }
+    SharedSegment* segment = f.segment != -1 ? &segments[f.segment] : nullptr;
+    int slot = segment != nullptr ? segment->slots[f.segment_page] : f.swap_slot;
+    if (dirty) {
+        writebacks++;
+        faultTicks += faultLatency.writeback;
+        if (slot != -1 && swap.referenceCount(slot) > 1) {
+            swap.release(slot);
+            slot = -1;
         }
+        if (slot == -1) {
+            slot = swap.allocate();
+        }
+        if (slot != -1) {
+            SwapRecord record = {victimPcb->process_id, segment != nullptr ? f.segment_page : f.vpn};
+            std::memcpy(swap.slot(slot), &record, sizeof(record));
+        } else if (swap.enabled()) {
+            MOSKS_LOG(logger, NORMAL, "Swap is full: the contents of P" << victimPcb->process_id << " VP " << f.vpn << " are lost.");
+        }
+    } else {
+        cleanEvictions++;
+        faultTicks += faultLatency.clean_eviction;
+    }
+    if (f.prefetched) {
+        prefetchWasted++;
+        ReadaheadState &ra = victimPcb->page_directory.readahead;
+        if (ra.window > 1) {
+            ra.window /= 2;
+        }
+    }
+
+    listUnlink(frame);
+    if (policy == ReplacementPolicy::OPT) {
+        optOrder.erase({f.next_use, frame});
+    }
+    while (f.first_mapping != -1) {
+        FrameMapping m = mappings[f.first_mapping];
+        removeMapping(f.first_mapping);
+        PageTableEntry &pte = *m.pte;
+        pte.valid = false;
+        pte.dirty = false;
+        pte.swapped = segment == nullptr && slot != -1;
+        pte.frameNumber = pte.swapped ? slot : -1;
+        dtlb.invalidate(m.owner->process_id, m.vpn);
+        itlb.invalidate(m.owner->process_id, m.vpn);
+
+        PageDirectory &pd = m.owner->page_directory;
+        int pdi = m.vpn / PAGE_TABLE_SIZE;
+        PageTable* pt = pd.table(pdi);
+        if (pte.swapped) {
+            swap.share(slot);
+            pt->swapped++;
+        }
+        pt->resident--;
+        if (pt->unused() && pt != faulting_table) {
+            releaseTable(pd, pdi);
+        }
+    }
+    if (segment != nullptr) {
+        segment->frames[f.segment_page] = -1;
+        segment->slots[f.segment_page] = slot;
+    } else if (slot != -1) {
+        swap.release(slot);     // the frame's own reference; the page tables hold theirs
+    }
+    f = FrameDescriptor();
+}
+
+// Puts a newly loaded `frame` on replacement list `list` and maps it.
+void VirtualMemoryManager::mapFrame(int frame, ProcessControlBlock& pcb, int virtualPageNumber, PageTable& pt, int pti, int list) {
+    FrameDescriptor &f = frameTable[frame];
+    listPushBack(frame, list);
+    if (policy == ReplacementPolicy::OPT) {
+        f.next_use = currentNextUse;
+        optOrder.insert({f.next_use, frame});
+    }
+    mapPage(frame, pcb, virtualPageNumber, pt, pti);
+}
+
+// Points the entry at `frame`. A page loaded into a frame of its own is no
+// longer shared, so a copy-on-write page gets write access back.
+void VirtualMemoryManager::mapPage(int frame, ProcessControlBlock& pcb, int virtualPageNumber, PageTable& pt, int pti) {
+    PageTableEntry &pte = pt[pti];
+    pte.frameNumber = frame;
+    pte.valid = true;
+    pte.lastAccessTime = accessCounter++;
+    pte.referenced = true;
+    if (!pte.configured) {
+        pte.can_read = true;
+        pte.can_write = true;
+        pte.can_execute = false;
+    } else if (pte.cow) {
+        pte.can_write = true;
+    }
+    pte.cow = false;
+    pt.resident++;
+    addMapping(frame, pcb, virtualPageNumber, &pte);
+}
+
+// Adds a mapping at the end of `frame`'s list, so the first mapper stays first.
+void VirtualMemoryManager::addMapping(int frame, ProcessControlBlock& pcb, int virtualPageNumber, PageTableEntry* pte) {
+    int m;
+    if (!freeMappings.empty()) {
+        m = freeMappings.back();
+        freeMappings.pop_back();
+    } else {
+        m = static_cast<int>(mappings.size());
+        mappings.emplace_back();
+    }
+    FrameMapping &mapping = mappings[m];
+    mapping = FrameMapping();
+    mapping.owner = &pcb;
+    mapping.vpn = virtualPageNumber;
+    mapping.pte = pte;
+    mapping.frame = frame;
+
+    FrameDescriptor &f = frameTable[frame];
+    int* link = &f.first_mapping;
+    while (*link != -1) {
+        link = &mappings[*link].next_mapper;
+    }
+    *link = m;
+    if (f.mappers++ == 0) {
+        f.owner = &pcb;
+        f.vpn = virtualPageNumber;
+        f.pte = pte;
+    }
+
+    PageDirectory &pd = pcb.page_directory;
+    mapping.owner_next = pd.first_mapping;
+    if (pd.first_mapping != -1) {
+        mappings[pd.first_mapping].owner_prev = m;
+    }
+    pd.first_mapping = m;
+    pd.resident_pages++;
+}
+
+// Unlinks a mapping from its frame and its process. The page table entry is
+// left alone.
+void VirtualMemoryManager::removeMapping(int m) {
+    FrameMapping &mapping = mappings[m];
+    FrameDescriptor &f = frameTable[mapping.frame];
+    int* link = &f.first_mapping;
+    while (*link != m) {
+        link = &mappings[*link].next_mapper;
+    }
+    *link = mapping.next_mapper;
+    f.mappers--;
+    if (f.first_mapping != -1) {
+        const FrameMapping &first = mappings[f.first_mapping];
+        f.owner = first.owner;
+        f.vpn = first.vpn;
+        f.pte = first.pte;
     } else {
-        log(NORMAL, "CRITICAL ERROR: Could not determine a victim frame!");
+        f.owner = nullptr;
+        f.vpn = -1;
+        f.pte = nullptr;
+    }
+
+    PageDirectory &pd = mapping.owner->page_directory;
+    (mapping.owner_prev != -1 ? mappings[mapping.owner_prev].owner_next : pd.first_mapping) = mapping.owner_next;
+    if (mapping.owner_next != -1) {
+        mappings[mapping.owner_next].owner_prev = mapping.owner_prev;
+    }
+    pd.resident_pages--;
+    freeMappings.push_back(m);
+}
+
+// The mapping of `frame` through `pte`.
+int VirtualMemoryManager::findMapping(int frame, const PageTableEntry* pte) const {
+    int m = frameTable[frame].first_mapping;
+    while (m != -1 && mappings[m].pte != pte) {
+        m = mappings[m].next_mapper;
+    }
+    return m;
+}
+
+// A write to a copy-on-write page. The last process sharing the frame simply
+// gets write access back; any other takes a private copy in a new frame,
+// which costs a page fault. False if no frame could be found.
+bool VirtualMemoryManager::copyOnWrite(ProcessControlBlock& pcb, int virtualPageNumber, PageTableEntry& pte) {
+    int shared = pte.frameNumber;
+    pte.cow = false;
+    pte.can_write = true;
+    if (frameTable[shared].mappers == 1) {
+        return true;
+    }
+
+    countFault(pcb);
+    cowCopies++;
+    MOSKS_LOG(logger, VERBOSE, "Copy-on-write: P" << pcb.process_id << " VP " << virtualPageNumber
+              << " leaves shared frame " << shared << ".");
+    int pdi = virtualPageNumber / PAGE_TABLE_SIZE;
+    int pti = virtualPageNumber % PAGE_TABLE_SIZE;
+    PageTable &pt = *pcb.page_directory.table(pdi);
+    removeMapping(findMapping(shared, &pte));
+    pt.resident--;
+
+    int list = 0;
+    int frame = obtainFrame(pcb, virtualPageNumber, pt, list);
+    if (frame == -1) {
+        pte.valid = false;
+        pte.frameNumber = -1;
+        dtlb.invalidate(pcb.process_id, virtualPageNumber);
+        itlb.invalidate(pcb.process_id, virtualPageNumber);
+        return false;
+    }
+    bool read = pte.can_read, execute = pte.can_execute;
+    mapFrame(frame, pcb, virtualPageNumber, pt, pti, list);
+    pte.can_read = read;
+    pte.can_execute = execute;
+    return true;
+}
+
+void VirtualMemoryManager::forkProcess(ProcessControlBlock& parent, ProcessControlBlock& child)
+{
+    PageDirectory &from = parent.page_directory;
+    PageDirectory &to = child.page_directory;
+    to = PageDirectory();
+    to.readahead = from.readahead;
+    // Shared segments stay shared: the child attaches them at the same pages.
+    to.segments = from.segments;
+    for (const SegmentAttachment &attachment : to.segments)
+    {
+        segments[attachment.segment].attachments++;
+    }
+    int shared = 0, cow = 0;
+    for (int pdi = 0; from.entries != nullptr && pdi < PAGE_TABLE_SIZE; ++pdi)
+    {
+        PageTable *src = from.table(pdi);
+        if (src == nullptr)
+        {
+            continue;
+        }
+        PageTable &dst = tableFor(to, pdi);
+        for (int pti = 0; pti < PAGE_TABLE_SIZE; ++pti)
+        {
+            PageTableEntry &pte = (*src)[pti];
+            if (pte.valid && pte.can_write && from.attachment(pdi * PAGE_TABLE_SIZE + pti) == nullptr)
+            {
+                pte.can_write = false;
+                pte.cow = true;
+                cow++;
+            }
+            dst[pti] = pte;
+            if (pte.valid)
+            {
+                addMapping(pte.frameNumber, child, pdi * PAGE_TABLE_SIZE + pti, &dst[pti]);
+                shared++;
+            }
+            else if (pte.swapped)
+            {
+                swap.share(pte.frameNumber);
+            }
+        }
+        dst.resident = src->resident;
+        dst.swapped = src->swapped;
+        dst.configured = src->configured;
     }
+    MOSKS_LOG(logger, NORMAL, "Forked P" << parent.process_id << " into P" << child.process_id << ": "
+              << shared << " resident pages shared, " << cow << " of them copy-on-write.");
 }
 
 void VirtualMemoryManager::freeProcess(ProcessControlBlock& pcb)
 {
+    // The page tables are about to be deleted; no translation may outlive them.
+    dtlb.flush(pcb.process_id);
+    itlb.flush(pcb.process_id);
+
     PageDirectory &pd = pcb.page_directory;
+    while (!pd.segments.empty())
+    {
+        detachSegment(pcb, pd.segments.size() - 1);
+    }
+
+    // Walk the process's own mappings instead of the whole frame table. A frame
+    // shared with another process only loses a reference.
+    for (int m = pd.first_mapping; m != -1;)
+    {
+        int next = mappings[m].owner_next;
+        int frame = mappings[m].frame;
+        removeMapping(m);
+        m = next;
+        if (frameTable[frame].mappers > 0)
+        {
+            continue;
+        }
+        listUnlink(frame);
+        if (policy == ReplacementPolicy::OPT)
+        {
+            optOrder.erase({frameTable[frame].next_use, frame});
+        }
+        if (frameTable[frame].swap_slot != -1)
+        {
+            swap.release(frameTable[frame].swap_slot);
+        }
+        if (frameTable[frame].prefetched)
+        {
+            prefetchWasted++;
+        }
+        frameTable[frame] = FrameDescriptor();
+        freeFrames.push_back(frame);
+    }
 
-    for (auto const &pde_pair : pd)
+    for (int pdi = 0; pd.entries != nullptr && pdi < PAGE_TABLE_SIZE; ++pdi)
     {
-        auto const &pde = pde_pair.second;
-        if (pde.valid && pde.pageTable != nullptr)
+        PageTable *pt = pd.table(pdi);
+        if (pt == nullptr)
+        {
+            continue;
+        }
+        for (int pti = 0; pti < PAGE_TABLE_SIZE && pt->swapped > 0; ++pti)
         {
-            PageTable *pt = pde.pageTable;
-            for (auto const &pte_pair : *pt)
+            if ((*pt)[pti].swapped)
             {
-                auto const &pte = pte_pair.second;
-                if (pte.valid)
-                {
-                    frameTable[pte.frameNumber] = {NULL, -1};
-                }
+                swap.release((*pt)[pti].frameNumber);
+                pt->swapped--;
             }
-            delete pt;
         }
+        releaseTable(pd, pdi);
     }
 
-    if (policy == ReplacementPolicy::FIFO)
+    MOSKS_LOG(logger, NORMAL, "Freed memory resources for process " << pcb.process_id << ".");
+}
+
+int VirtualMemoryManager::segmentIndex(const std::string& name) const
+{
+    for (size_t i = 0; i < segments.size() && !name.empty(); ++i)
     {
-        queue<pair<int, int>> newQueue;
-        while (!pageQueue.empty())
+        if (segments[i].name == name)
         {
-            auto p = pageQueue.front();
-            if (p.first != pcb.process_id)
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+const SharedSegment* VirtualMemoryManager::findSegment(const std::string& name) const
+{
+    int index = segmentIndex(name);
+    return index != -1 ? &segments[index] : nullptr;
+}
+
+bool VirtualMemoryManager::createSegment(const std::string& name, int pages, std::string* error)
+{
+    if (name.empty() || pages <= 0 || pages > MAX_VIRTUAL_PAGES)
+    {
+        if (error) *error = "a segment needs a name and 1 to " + std::to_string(MAX_VIRTUAL_PAGES) + " pages";
+        return false;
+    }
+    if (segmentIndex(name) != -1)
+    {
+        if (error) *error = "segment " + name + " already exists";
+        return false;
+    }
+    size_t index = 0;
+    while (index < segments.size() && !segments[index].name.empty())
+    {
+        index++;
+    }
+    if (index == segments.size())
+    {
+        segments.emplace_back();
+    }
+    SharedSegment &segment = segments[index];
+    segment.name = name;
+    segment.frames.assign(pages, -1);
+    segment.slots.assign(pages, -1);
+    segment.attachments = 0;
+    MOSKS_LOG(logger, NORMAL, "Created shared memory segment " << name << " of " << pages << " pages.");
+    return true;
+}
+
+bool VirtualMemoryManager::attachSegment(ProcessControlBlock& pcb, const std::string& name, int virtualPageNumber,
+                                         bool read, bool write, bool execute, std::string* error)
+{
+    int index = segmentIndex(name);
+    if (index == -1)
+    {
+        if (error) *error = "no segment named " + name;
+        return false;
+    }
+    int pages = static_cast<int>(segments[index].frames.size());
+    if (virtualPageNumber < 0 || virtualPageNumber > MAX_VIRTUAL_PAGES - pages)
+    {
+        if (error) *error = "VP " + std::to_string(virtualPageNumber) + " to " + std::to_string(virtualPageNumber + pages - 1)
+                            + " are outside the address space";
+        return false;
+    }
+    PageDirectory &pd = pcb.page_directory;
+    for (int vpn = virtualPageNumber; vpn < virtualPageNumber + pages; ++vpn)
+    {
+        const PageTableEntry *pte = pd.find(vpn);
+        if (pd.attachment(vpn) != nullptr || (pte != nullptr && (pte->valid || pte->swapped)))
+        {
+            if (error) *error = "VP " + std::to_string(vpn) + " of P" + std::to_string(pcb.process_id) + " is already in use";
+            return false;
+        }
+    }
+
+    pd.segments.push_back({index, virtualPageNumber, pages});
+    segments[index].attachments++;
+    for (int vpn = virtualPageNumber; vpn < virtualPageNumber + pages; ++vpn)
+    {
+        setPagePermissions(pcb, vpn, read, write, execute);
+    }
+    MOSKS_LOG(logger, NORMAL, "Attached segment " << name << " to P" << pcb.process_id << " at VP " << virtualPageNumber
+              << " to " << virtualPageNumber + pages - 1 << ".");
+    return true;
+}
+
+bool VirtualMemoryManager::detachSegment(ProcessControlBlock& pcb, const std::string& name, std::string* error)
+{
+    int index = segmentIndex(name);
+    const std::vector<SegmentAttachment> &attached = pcb.page_directory.segments;
+    for (size_t i = 0; i < attached.size() && index != -1; ++i)
+    {
+        if (attached[i].segment == index)
+        {
+            detachSegment(pcb, i);
+            MOSKS_LOG(logger, NORMAL, "Detached segment " << name << " from P" << pcb.process_id << ".");
+            return true;
+        }
+    }
+    if (error) *error = "P" + std::to_string(pcb.process_id) + " has no segment named " + name + " attached";
+    return false;
+}
+
+// Unmaps one of the process's segments and forgets the permissions it had
+// there. The pages the process was the last to map are given up as if they
+// were evicted, so a dirty one is written to the segment's swap slot; a write
+// to a page that other processes still map is handed on to them.
+void VirtualMemoryManager::detachSegment(ProcessControlBlock& pcb, size_t attachment)
+{
+    PageDirectory &pd = pcb.page_directory;
+    SegmentAttachment detached = pd.segments[attachment];
+    pd.segments.erase(pd.segments.begin() + attachment);
+    segments[detached.segment].attachments--;
+    for (int vpn = detached.base; vpn < detached.base + detached.pages; ++vpn)
+    {
+        int pdi = vpn / PAGE_TABLE_SIZE;
+        PageTable *pt = pd.table(pdi);
+        if (pt == nullptr)
+        {
+            continue;
+        }
+        PageTableEntry &pte = (*pt)[vpn % PAGE_TABLE_SIZE];
+        dtlb.invalidate(pcb.process_id, vpn);
+        itlb.invalidate(pcb.process_id, vpn);
+        if (pte.valid)
+        {
+            int frame = pte.frameNumber;
+            FrameDescriptor &f = frameTable[frame];
+            if (f.mappers == 1)
+            {
+                evictFrame(frame, pt);
+                freeFrames.push_back(frame);
+            }
+            else
             {
-                newQueue.push(p);
+                removeMapping(findMapping(frame, &pte));
+                pt->resident--;
+                if (pte.dirty)
+                {
+                    mappings[f.first_mapping].pte->dirty = true;
+                }
             }
-            pageQueue.pop();
         }
-        pageQueue = move(newQueue);
+        if (pte.configured)
+        {
+            pt->configured--;
+        }
+        pte = PageTableEntry();
+        if (pt->unused())
+        {
+            releaseTable(pd, pdi);
+        }
+    }
+}
+
+bool VirtualMemoryManager::removeSegment(const std::string& name, std::string* error)
+{
+    int index = segmentIndex(name);
+    if (index == -1)
+    {
+        if (error) *error = "no segment named " + name;
+        return false;
+    }
+    SharedSegment &segment = segments[index];
+    if (segment.attachments > 0)
+    {
+        if (error) *error = "segment " + name + " is still attached to " + std::to_string(segment.attachments) + " processes";
+        return false;
+    }
+    // Detached by everyone, so nothing is resident; only swap slots remain.
+    for (int slot : segment.slots)
+    {
+        if (slot != -1)
+        {
+            swap.release(slot);
+        }
+    }
+    segment = SharedSegment();
+    MOSKS_LOG(logger, NORMAL, "Removed shared memory segment " << name << ".");
+    return true;
+}
+
+void VirtualMemoryManager::printSegments() const
+{
+    *out << "\n=== Shared Memory Segments ===\n";
+    *out << "Name\tPages\tResident\tIn swap\tAttached\n";
+    for (const SharedSegment &segment : segments)
+    {
+        if (segment.name.empty())
+        {
+            continue;
+        }
+        int resident = 0, swapped = 0;
+        for (size_t page = 0; page < segment.frames.size(); ++page)
+        {
+            resident += segment.frames[page] != -1;
+            swapped += segment.slots[page] != -1;
+        }
+        *out << segment.name << "\t" << segment.frames.size() << "\t" << resident << "\t\t" << swapped
+             << "\t" << segment.attachments << "\n";
     }
+}
+
+void VirtualMemoryManager::setResidentLimit(ProcessControlBlock& pcb, int pages)
+{
+    pcb.page_directory.resident_limit = std::max(0, pages);
+    int trimmed = pages > 0 ? trimResidentSet(pcb, pages) : 0;
+    MOSKS_LOG(logger, NORMAL, "Resident limit of P" << pcb.process_id << " set to "
+              << (pages > 0 ? std::to_string(pages) + " pages" : std::string("none"))
+              << (trimmed > 0 ? " (" + std::to_string(trimmed) + " pages evicted)" : std::string()) << ".");
+}
+
+int VirtualMemoryManager::trimResidentSet(ProcessControlBlock& pcb, int pages)
+{
+    PageDirectory &pd = pcb.page_directory;
+    std::vector<std::pair<uint64_t, int>> candidates;  // (last access, frame)
+    for (int m = pd.first_mapping; m != -1; m = mappings[m].owner_next)
+    {
+        if (frameTable[mappings[m].frame].mappers == 1)
+        {
+            candidates.push_back({mappings[m].pte->lastAccessTime, mappings[m].frame});
+        }
+    }
+    size_t excess = static_cast<size_t>(std::max(0, pd.resident_pages - std::max(0, pages)));
+    excess = std::min(excess, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + excess, candidates.end());
+    for (size_t i = 0; i < excess; ++i)
+    {
+        evictFrame(candidates[i].second);
+        freeFrames.push_back(candidates[i].second);
+    }
+    return static_cast<int>(excess);
+}
+
+// Denning's working set, measured on the resident pages: those used within the
+// last working_set_window accesses of all processes.
+int VirtualMemoryManager::workingSetSize(const ProcessControlBlock& pcb) const
+{
+    uint64_t window = static_cast<uint64_t>(std::max(1, residentConfig.working_set_window));
+    uint64_t since = accessCounter > window ? accessCounter - window : 0;
+    int size = 0;
+    for (int m = pcb.page_directory.first_mapping; m != -1; m = mappings[m].owner_next)
+    {
+        size += mappings[m].pte->lastAccessTime >= since;
+    }
+    return size;
+}
 
-    log(NORMAL, "Freed memory resources for process " + to_string(pcb.process_id) + ".");
+void VirtualMemoryManager::printResidentSets(const std::vector<const ProcessControlBlock*>& processes) const
+{
+    *out << "\n=== Resident Sets (" << (residentConfig.local_replacement ? "local" : "global")
+         << " replacement, working set window " << residentConfig.working_set_window << " accesses) ===\n";
+    *out << "PID\tRSS\tLimit\tWSS\tFaults\tFault rate\n";
+    for (const ProcessControlBlock* pcb : processes)
+    {
+        const PageDirectory &pd = pcb->page_directory;
+        *out << pcb->process_id << "\t" << pd.resident_pages << "\t"
+             << (pd.resident_limit > 0 ? std::to_string(pd.resident_limit) : std::string("-")) << "\t"
+             << workingSetSize(*pcb) << "\t" << pd.faults << "\t" << pd.fault_rate.rate << "\n";
+    }
+    *out << "System fault rate: " << faultRate.rate << " over the last " << residentConfig.fault_window << " accesses\n";
 }
 
 void VirtualMemoryManager::printPageTable(const ProcessControlBlock& pcb) const
 {
-    cout << "\n=== Page Table for Process " << pcb.process_id << " ===\n";
+    *out << "\n=== Page Table for Process " << pcb.process_id << " ===\n";
     const PageDirectory &pd = pcb.page_directory;
-    for (const auto &pde_pair : pd)
+    for (int pdi = 0; pdi < PAGE_TABLE_SIZE && pd.entries != nullptr; ++pdi)
     {
-        if (pde_pair.second.valid)
+        const PageTable *pt = pd.table(pdi);
+        if (pt == nullptr)
+        {
+            continue;
+        }
+        *out << "  PDI [" << pdi << "] -> Page Table:\n";
+        *out << "    PTI\tFrame\tValid\n";
+        for (int pti = 0; pti < PAGE_TABLE_SIZE; ++pti)
         {
-            int pdi = pde_pair.first;
-            const PageTable *pt = pde_pair.second.pageTable;
-            cout << "  PDI [" << pdi << "] -> Page Table:\n";
-            cout << "    PTI\tFrame\tValid\n";
-            for (const auto &pte_pair : *pt)
+            // Entries that were never faulted in or given permissions are not shown.
+            const PageTableEntry &pte = (*pt)[pti];
+            if (pte.valid || pte.swapped || pte.can_read || pte.can_write || pte.can_execute)
             {
-                int pti = pte_pair.first;
-                const PageTableEntry &pte = pte_pair.second;
-                cout << "    " << pti << "\t" << pte.frameNumber << "\t" << (pte.valid ? "Yes" : "No") << "\n";
+                *out << "    " << pti << "\t" << (pte.valid ? static_cast<int>(pte.frameNumber) : -1) << "\t"
+                     << (pte.valid ? (pte.dirty ? "Yes (dirty)" : "Yes") : "No");
+                if (pte.swapped)
+                {
+                    *out << " (swap slot " << pte.frameNumber << ")";
+                }
+                *out << "\n";
             }
         }
     }
-    cout << "\n";
+    *out << "\n";
 }
 
 void VirtualMemoryManager::printFrameTable() const
 {
-    cout << "\n=== Frame Table ===\n";
-    cout << "Frame\tProcess\tPage\n";
+    *out << "\n=== Frame Table ===\n";
+    *out << "Frame\tProcess\tPage\n";
     for (int i = 0; i < totalFrames; ++i)
     {
-        if (frameTable[i].first == NULL)
+        if (frameTable[i].owner == nullptr)
         {
-            cout << i << "\tFree\t-\n";
+            *out << i << "\tFree\t-\n";
         }
         else
         {
-            cout << i << "\t" << frameTable[i].first
-                 << "\t" << frameTable[i].second << "\n";
+            *out << i << "\tP" << frameTable[i].owner->process_id
+                 << "\t" << frameTable[i].vpn;
+            if (frameTable[i].mappers > 1)
+            {
+                *out << "\t(shared by " << frameTable[i].mappers << ")";
+            }
+            if (frameTable[i].segment != -1)
+            {
+                *out << "\tsegment " << segments[frameTable[i].segment].name << " page " << frameTable[i].segment_page;
+            }
+            *out << "\n";
         }
     }
 }
 
+void VirtualMemoryManager::printSwapStats() const
+{
+    *out << "Fault service time: " << faultTicks << " ticks (" << swapIns << " swap-ins, "
+         << cleanEvictions << " clean evictions, " << writebacks << " dirty write-backs)\n";
+    if (!swap.enabled())
+    {
+        *out << "Swap: off\n";
+        return;
+    }
+    *out << "Swap: " << swap.slotsInUse() << " of " << swap.slotCount() << " slots in use ("
+         << (swap.path().empty() ? std::string("anonymous memory") : swap.path()) << ")\n";
+}
+
+void VirtualMemoryManager::printReadaheadStats() const
+{
+    if (readaheadConfig.max_window <= 0)
+    {
+        *out << "Readahead: off\n";
+        return;
+    }
+    *out << "Readahead: windows of " << std::min(readaheadConfig.initial_window, maxReadahead()) << " to "
+         << maxReadahead() << " pages; " << prefetched << " prefetched, " << prefetchUseful << " used, "
+         << prefetchWasted << " evicted unused\n";
+}
+
+void VirtualMemoryManager::printTlbStats() const
+{
+    if (!dtlb.enabled())
+    {
+        *out << "TLB: disabled\n";
+        return;
+    }
+    long long hits = getTlbHits(), lookups = hits + getTlbMisses();
+    *out << "TLB: " << (tlbConfig.split ? "split I/D, " : "") << dtlb.size() << " entries"
+         << (tlbConfig.split ? " each" : "") << ", " << tlbConfig.ways << "-way "
+         << tlbReplacementToString(tlbConfig.replacement) << "\n";
+    *out << "TLB Hits: " << hits << ", Misses: " << getTlbMisses();
+    if (lookups > 0)
+    {
+        std::ostringstream rate;
+        rate << std::fixed << std::setprecision(1) << 100.0 * hits / lookups;
+        *out << " (" << rate.str() << "% hit rate)";
+    }
+    *out << "\n";
+}
+
 void VirtualMemoryManager::displayMemoryLayout() const {
     const int frames_per_row = 8;
-    std::cout << "\n--- Physical Memory Layout ---\n";
+    *out << "\n--- Physical Memory Layout ---\n";
 
     for (int i = 0; i < totalFrames; ++i) {
         // Top border of the box
-        std::cout << "+--------";
+        *out << "+--------";
     }
-    std::cout << "+\n";
+    *out << "+\n";
 
     for (int i = 0; i < totalFrames; ++i) {
         // Content of the box
-        if (frameTable[i].first != nullptr) {
+        if (frameTable[i].owner != nullptr) {
             // Occupied frame (print in red)
-            std::cout << "|\033[31m P" << std::setw(2) << frameTable[i].first->process_id
-                      << ":V" << std::setw(2) << frameTable[i].second << "\033[0m ";
+            *out << "|\033[31m P" << std::setw(2) << frameTable[i].owner->process_id
+                 << ":V" << std::setw(2) << frameTable[i].vpn << "\033[0m ";
         } else {
             // Free frame (print in green)
-            std::cout << "|\033[32m  Free  \033[0m ";
+            *out << "|\033[32m  Free  \033[0m ";
         }
     }
-    std::cout << "|\n";
+    *out << "|\n";
 
     for (int i = 0; i < totalFrames; ++i) {
         // Frame number
-        std::cout << "| Frame " << std::setw(2) << i << " ";
+        *out << "| Frame " << std::setw(2) << i << " ";
     }
-    std::cout << "|\n";
+    *out << "|\n";
 
     for (int i = 0; i < totalFrames; ++i) {
         // Bottom border of the box
-        std::cout << "+--------";
+        *out << "+--------";
     }
-    std::cout << "+\n";
+    *out << "+\n";
 }
 
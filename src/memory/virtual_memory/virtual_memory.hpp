@@ -4,33 +4,188 @@
 #include <vector>
 #include <string>
 #include <map>
-#include <queue>
+#include <set>
+#include <iostream>
 #include "scheduler/pcb.hpp"
 #include "memory/virtual_memory/memory_types.hpp"
+#include "memory/virtual_memory/tlb.hpp"
+#include "memory/virtual_memory/table_pool.hpp"
+#include "memory/virtual_memory/ghost_list.hpp"
+#include "memory/virtual_memory/memory_trace.hpp"
+#include "memory/virtual_memory/swap_device.hpp"
 #include "core/types.hpp"
+#include "core/logger.hpp"
 
 // --- Enums ---
-enum class ReplacementPolicy { FIFO, LRU, CLOCK };
+// OPT (Belady) evicts the page whose next use is furthest away. It needs the
+// whole access sequence in advance (see setFutureAccesses) and is the lower
+// bound the other policies are compared against. ARC and 2Q keep recently
+// evicted pages on ghost lists so that pages used only once, as in a
+// sequential scan, cannot push out pages that are used repeatedly.
+enum class ReplacementPolicy { FIFO, LRU, CLOCK, OPT, ARC, TWO_Q };
 
+std::string replacementPolicyToString(ReplacementPolicy policy);
+bool parseReplacementPolicy(const std::string& name, ReplacementPolicy& policy);
 
-const int PAGE_TABLE_SIZE = 1024;
+// Ticks a page fault costs, by the work it does. Every fault pays `fault`.
+// Making room adds `clean_eviction` when the victim is clean and is simply
+// dropped, or `writeback` when it is dirty and has to be written out. Reading
+// the page back from swap adds `swap_in`.
+struct FaultLatency {
+    int fault = 4;
+    int clean_eviction = 1;
+    int writeback = 20;
+    int swap_in = 16;
+};
+
+// Readahead: once two demand faults of a process are the same stride apart,
+// the following `initial_window` pages of the stride are prefaulted in one
+// batch. The first use of the first prefetched page fetches the next window,
+// twice as large up to `max_window` (and at most a quarter of memory), so a steady
+// stream stays a window ahead without faulting. A prefetched page evicted
+// before its first use halves the window. max_window 0 turns readahead off.
+struct ReadaheadConfig {
+    int max_window = 0;
+    int initial_window = 4;
+};
+
+// Resident set control. A process can be held to a number of resident pages
+// (setResidentLimit); at its limit, each of its faults replaces one of its own
+// pages. With local_replacement, every process does so once memory is full,
+// instead of taking the policy's victim from anyone. A process's working set
+// is its resident pages used in the last `working_set_window` accesses, and
+// fault rates are measured over windows of `fault_window` accesses.
+struct ResidentSetConfig {
+    bool local_replacement = false;
+    int working_set_window = 1000;
+    int fault_window = 100;
+};
+
+// One process's mapping of a resident page. The mappings of a frame are
+// chained through next_mapper, and those of a process through owner_prev and
+// owner_next, which is the reverse map from a process to its resident pages.
+// Mappings live in a pool and are linked by index (-1 ends a list).
+struct FrameMapping {
+    ProcessControlBlock* owner = nullptr;
+    int vpn = -1;
+    PageTableEntry* pte = nullptr;
+    int frame = -1;
+    int next_mapper = -1;
+    int owner_prev = -1;
+    int owner_next = -1;
+};
+
+// Descriptor of one physical frame. An occupied frame sits on one of the
+// replacement lists, linked by frame number, and has one mapping per process
+// that maps it: more than one after a fork, until copy-on-write separates them,
+// or for a page of a shared-memory segment. owner, vpn and pte repeat the
+// first mapping.
+//
+// Replacement list 0 is the load order (FIFO), the use order (LRU), ARC's T1
+// or 2Q's A1in; list 1 is ARC's T2 or 2Q's Am. Both are oldest first.
+struct FrameDescriptor {
+    ProcessControlBlock* owner = nullptr;   // nullptr: free
+    int vpn = -1;
+    PageTableEntry* pte = nullptr;          // owner's entry mapping this frame
+    int mappers = 0;                        // reference count
+    int first_mapping = -1;
+    int list = 0;                           // replacement list
+    int prev = -1;
+    int next = -1;
+    long long next_use = 0;                 // OPT: position of the page's next access
+    int swap_slot = -1;                     // copy of the page in swap, if any
+    bool prefetched = false;                // loaded by readahead and not used yet
+    int segment = -1;                       // shared-memory segment the page belongs to
+    int segment_page = -1;                  // and its page number there
+};
+
+// A named shared-memory segment. Processes attach it at a page range of their
+// choice, each with its own permissions. A page is loaded by the first access
+// of any of them and then mapped by the others from the same frame; while it
+// is not resident, the segment keeps it in its own swap slot.
+struct SharedSegment {
+    std::string name;           // empty: removed, the entry can be reused
+    std::vector<int> frames;    // frame holding each page, or -1
+    std::vector<int> slots;     // swap slot holding each page, or -1
+    int attachments = 0;
+};
 
 class VirtualMemoryManager {
 public:
-    VirtualMemoryManager(int memorySize, int pageSize, ReplacementPolicy policy);
+    VirtualMemoryManager(int memorySize, int pageSize, ReplacementPolicy policy, std::ostream& out = std::cout);
 
     void allocateProcess(ProcessControlBlock& pcb);
     void accessPage(ProcessControlBlock& pcb, int virtualPageNumber, AccessType type);
     void freeProcess(ProcessControlBlock& pcb);
+    // Give `child` a copy of `parent`'s address space. Resident frames and swap
+    // slots are shared, and writable pages of both become copy-on-write.
+    void forkProcess(ProcessControlBlock& parent, ProcessControlBlock& child);
+    // Permissions set here survive page faults and evictions.
     void setPagePermissions(ProcessControlBlock& pcb, int virtualPageNumber, bool read, bool write, bool execute);
+    // Shared memory. A segment lives until it is removed, which fails while
+    // processes still have it attached; freeProcess detaches them. Attaching
+    // fails if any page of the range is already in use.
+    bool createSegment(const std::string& name, int pages, std::string* error = nullptr);
+    bool attachSegment(ProcessControlBlock& pcb, const std::string& name, int virtualPageNumber,
+                       bool read, bool write, bool execute, std::string* error = nullptr);
+    bool detachSegment(ProcessControlBlock& pcb, const std::string& name, std::string* error = nullptr);
+    bool removeSegment(const std::string& name, std::string* error = nullptr);
+    const SharedSegment* findSegment(const std::string& name) const;
+    void printSegments() const;
+    // 0 removes the limit; a process above its new limit is trimmed at once.
+    void setResidentLimit(ProcessControlBlock& pcb, int pages);
+    // Evicts the process's least recently used pages that no other process
+    // maps until at most `pages` remain resident. Returns the number evicted.
+    int trimResidentSet(ProcessControlBlock& pcb, int pages);
+    void configureResidentSets(const ResidentSetConfig& config) { residentConfig = config; }
+    const ResidentSetConfig& getResidentSetConfig() const { return residentConfig; }
+    int workingSetSize(const ProcessControlBlock& pcb) const;
+    // Fault rate of all processes together (see FaultFrequency).
+    const FaultFrequency& getFaultRate() const { return faultRate; }
+    void printResidentSets(const std::vector<const ProcessControlBlock*>& processes) const;
     void printPageTable(const ProcessControlBlock& pcb) const;
     void printFrameTable() const;
     int getPageFaults() const { return pageFaults; }
+    long long getCowCopies() const { return cowCopies; }
+    // Faults on a segment page another process already had resident.
+    long long getMinorFaults() const { return minorFaults; }
+    long long getSwapIns() const { return swapIns; }
+    long long getCleanEvictions() const { return cleanEvictions; }
+    long long getWritebacks() const { return writebacks; }
+    // Ticks spent servicing page faults under the FaultLatency model.
+    long long getFaultTicks() const { return faultTicks; }
+    void setFaultLatency(const FaultLatency& latency) { faultLatency = latency; }
+    const FaultLatency& getFaultLatency() const { return faultLatency; }
+    // Write dirty victims to `slots` swap slots in `path` (anonymous memory if
+    // empty); 0 slots turns swap off. Fails while pages are still in swap.
+    bool configureSwap(int slots, const std::string& path, std::string* error = nullptr);
+    const SwapDevice& getSwap() const { return swap; }
+    void printSwapStats() const;
+    // Readahead does not apply to OPT, whose bound assumes demand paging.
+    void configureReadahead(const ReadaheadConfig& config) { readaheadConfig = config; }
+    const ReadaheadConfig& getReadaheadConfig() const { return readaheadConfig; }
+    long long getPrefetched() const { return prefetched; }
+    long long getPrefetchUseful() const { return prefetchUseful; }
+    long long getPrefetchWasted() const { return prefetchWasted; }
+    void printReadaheadStats() const;
+    // Give OPT the accesses that will follow, in order; each accessPage call
+    // consumes one. Accesses beyond the sequence count as never used again.
+    void setFutureAccesses(const std::vector<MemoryAccess>& accesses);
+    long long getTlbHits() const { return dtlb.hits() + itlb.hits(); }
+    long long getTlbMisses() const { return dtlb.misses() + itlb.misses(); }
+    // Rebuild the TLB(s) with a new shape; counters restart from zero.
+    void configureTlb(const TlbConfig& config);
+    const TlbConfig& getTlbConfig() const { return tlbConfig; }
+    void printTlbStats() const;
     void setLogLevel(LogLevel level);
+    void setOutput(std::ostream& stream);
+    // Send log messages to `sink` instead of the output stream (nullptr restores it).
+    void setLogSink(LogSink* sink);
     void displayMemoryLayout() const;
     
     // Helpers for testing
-    const std::vector<std::pair<ProcessControlBlock*, int>>& getFrameTable() const { return frameTable; }
+    const std::vector<FrameDescriptor>& getFrameTable() const { return frameTable; }
+    size_t getPageTableCount() const { return tablePool.inUse(); }
 
 private:
     int pageSize;
@@ -38,14 +193,90 @@ private:
     int pageFaults;
     int clockHand;
     unsigned long accessCounter;
+    long long cowCopies;
+    long long minorFaults;
+    long long swapIns;
+    long long cleanEvictions;
+    long long writebacks;
+    long long faultTicks;
+    FaultLatency faultLatency;
+    SwapDevice swap;
+    ReadaheadConfig readaheadConfig;
+    ResidentSetConfig residentConfig;
+    FaultFrequency faultRate;
+    long long prefetched;
+    long long prefetchUseful;
+    long long prefetchWasted;
+    std::vector<int> readaheadPages;    // scratch: the pages of one window to load
     ReplacementPolicy policy;
-    LogLevel current_log_level = NORMAL;
+    std::ostream* out;
+    StreamSink out_sink;    // default log destination: the output stream
+    Logger logger;
+
+    std::vector<FrameDescriptor> frameTable;
+    std::vector<FrameMapping> mappings;
+    std::vector<int> freeMappings;
+    std::vector<int> freeFrames;    // stack; the most recently freed frame is reused first
+    std::vector<SharedSegment> segments;
+
+    struct FrameList {
+        int head = -1;
+        int tail = -1;
+        int size = 0;
+    };
+    FrameList lists[2];
+
+    // OPT: the next use of every position of the future access sequence, the
+    // current position, and the resident frames ordered by next use.
+    std::vector<long long> nextUses;
+    size_t futurePosition;
+    long long currentNextUse;
+    std::set<std::pair<long long, int>> optOrder;
+
+    // ARC: the target size of T1 and the ghosts of T1 (B1) and T2 (B2).
+    double arcTarget;
+    GhostList arcB1;
+    GhostList arcB2;
+    // 2Q: the ghosts of A1in.
+    GhostList twoQOut;
+
+    TlbConfig tlbConfig;
+    Tlb dtlb;   // data TLB, or the only TLB when not split
+    Tlb itlb;   // instruction TLB (split mode only)
 
-    std::vector<std::pair<ProcessControlBlock*, int>> frameTable;
-    std::queue<std::pair<int, int>> pageQueue;
+    TablePool<PageTable> tablePool;
+    TablePool<PageDirectoryEntries> directoryPool;
 
-    void handlePageFault(ProcessControlBlock& pcb, int virtualPageNumber, PageTable& pt, int pti);
-    void log(LogLevel level, const std::string& message) const;
+    void completeAccess(ProcessControlBlock& pcb, int virtualPageNumber, PageTableEntry& pte, AccessType type);
+    void handlePageFault(ProcessControlBlock& pcb, int virtualPageNumber, PageTable& pt, int pti, AccessType type);
+    void countFault(ProcessControlBlock& pcb);
+    int obtainFrame(ProcessControlBlock& pcb, int virtualPageNumber, const PageTable& pt, int& list);
+    bool replacesLocally(const ProcessControlBlock& pcb) const;
+    int localVictim(const ProcessControlBlock& pcb) const;
+    void touchFrame(int frame);
+    int replacementMiss(uint64_t page, bool full, int& list);
+    int selectVictim();
+    int arcMiss(uint64_t page, bool full, int& list);
+    int twoQMiss(uint64_t page, bool full, int& list);
+    void evictFrame(int frame, const PageTable* faulting_table = nullptr);
+    void mapFrame(int frame, ProcessControlBlock& pcb, int virtualPageNumber, PageTable& pt, int pti, int list);
+    void mapPage(int frame, ProcessControlBlock& pcb, int virtualPageNumber, PageTable& pt, int pti);
+    void protectionFault(const ProcessControlBlock& pcb, AccessType type);
+    int segmentIndex(const std::string& name) const;
+    void detachSegment(ProcessControlBlock& pcb, size_t attachment);
+    void swapIn(int frame, PageTableEntry& pte, PageTable& pt, int slot);
+    void sequentialFault(ProcessControlBlock& pcb, int virtualPageNumber);
+    void prefetchedHit(ProcessControlBlock& pcb, int virtualPageNumber, int frame);
+    void readahead(ProcessControlBlock& pcb, int start, int stride, int count);
+    int maxReadahead() const;
+    void addMapping(int frame, ProcessControlBlock& pcb, int virtualPageNumber, PageTableEntry* pte);
+    void removeMapping(int mapping);
+    int findMapping(int frame, const PageTableEntry* pte) const;
+    bool copyOnWrite(ProcessControlBlock& pcb, int virtualPageNumber, PageTableEntry& pte);
+    void listUnlink(int frame);
+    void listPushBack(int frame, int list);
+    PageTable& tableFor(PageDirectory& pd, int pdi);
+    void releaseTable(PageDirectory& pd, int pdi);
 };
 
 #endif
\ No newline at end of file
@@ -3,12 +3,23 @@
 
 #include "core/types.hpp"
 #include "memory/virtual_memory/memory_types.hpp"
+#include "program.hpp"
+#include <cstddef>
 
+class Mutex;
 
-struct ProcessControlBlock {
+// ready_handle value for a PCB that is not in any ready queue
+const long long NOT_QUEUED = -1;
+
+// Fields are grouped by how often the scheduler touches them: the scheduling
+// state read or written on every dispatch, enqueue and tick fits in the first
+// 64-byte cache line. The program counter, stepped on the ticks a program
+// runs, opens the second line, and the page directory and accounting fields
+// follow.
+struct alignas(64) ProcessControlBlock {
+    // --- Hot: scheduling state ---
     int process_id;
     ProcessState state;
-    PageDirectory page_directory; 
     int remaining_burst_time;
     int priority;
 
@@ -16,25 +27,71 @@ struct ProcessControlBlock {
     int io_burst_time;
     int io_burst_frequency;
     int time_since_last_io;
+    int io_wake_time;       // absolute time the current I/O completes (while WAITING)
+
+    // Ready queue bookkeeping (owned by the ReadyQueue holding this PCB)
+    long long ready_handle;
+    long long ready_seq;
+    int last_cpu;           // CPU whose run queue this process belongs to (-1 before first placement)
+
+    // CFS bookkeeping (see CfsReadyQueue)
+    int load_weight;        // weight derived from priority when last enqueued
+    long long vruntime;     // weighted CPU time received, in VRUNTIME_SHIFT fixed point
+
+    // --- Warm: program being executed, if any (stepped every tick while running) ---
+    ProgramCounter program;
+
+    // --- Cold: memory and statistics ---
+    PageDirectory page_directory;
 
     // For stats tracking
     int total_burst_time;
     int creation_time;
     int completion_time;
+    int total_io_time;
+    int ready_since;        // time the process last became READY
+    int first_dispatch_time;
+    long long total_wait_time; // time spent READY so far
+    double max_lag;         // largest |service lag| observed, in ticks
+
+    // Synchronization bookkeeping (see core/sync.hpp)
+    int base_priority;      // priority before any inheritance boost
+    int blocked_since;      // time the process last went to sleep on a wait queue
+    ProcessControlBlock* wait_next; // next process on the same wait queue
+    Mutex* blocked_on;      // mutex this process is queued on, if any
+    Mutex* held_locks;      // mutexes owned, linked through Mutex::next_held
 
-    ProcessControlBlock(int id,int burst_time,int prio,int io_time = 0,int io_freq = 0) : 
-        process_id(id), 
+    ProcessControlBlock(int id,int burst_time,int prio,int io_time = 0,int io_freq = 0) :
+        process_id(id),
         state(ProcessState::NEW),
         remaining_burst_time(burst_time),
         priority(prio),
         io_burst_time(io_time),
         io_burst_frequency(io_freq),
         time_since_last_io(0),
+        io_wake_time(0),
+        ready_handle(NOT_QUEUED),
+        ready_seq(0),
+        last_cpu(-1),
+        load_weight(0),
+        vruntime(0),
         total_burst_time(burst_time),
         creation_time(0),
-        completion_time(-1)
+        completion_time(-1),
+        total_io_time(0),
+        ready_since(0),
+        first_dispatch_time(-1),
+        total_wait_time(0),
+        max_lag(0.0),
+        base_priority(prio),
+        blocked_since(0),
+        wait_next(nullptr),
+        blocked_on(nullptr),
+        held_locks(nullptr)
 
     {}
 };
+static_assert(offsetof(ProcessControlBlock, vruntime) + sizeof(long long) <= 64,
+              "the hot scheduling fields must stay in the first cache line");
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,97 @@
+#include "pcb_store.hpp"
+#include <new>
+
+PcbStore::PcbStore(size_t slab_size)
+    : slab_size(slab_size > 0 ? slab_size : 1), head(0), first_pid(0), live(0) {}
+
+PcbStore::~PcbStore() {
+    forEach([](ProcessControlBlock& pcb) { pcb.~ProcessControlBlock(); });
+}
+
+int* PcbStore::indexEntry(int pid) {
+    if (live == 0) return nullptr;
+    if (pid < first_pid || head == index.size()) {
+        auto it = sparse.find(pid);
+        return it != sparse.end() ? &it->second : nullptr;
+    }
+    size_t i = head + static_cast<size_t>(pid - first_pid);
+    return i < index.size() ? &index[i] : nullptr;
+}
+
+int PcbStore::allocateSlot() {
+    if (free_slots.empty()) {
+        int base = static_cast<int>(capacity());
+        slabs.emplace_back(new Storage[slab_size]);
+        // Pushed in reverse so slots are handed out in address order.
+        for (int s = base + static_cast<int>(slab_size) - 1; s >= base; --s) free_slots.push_back(s);
+    }
+    int s = free_slots.back();
+    free_slots.pop_back();
+    return s;
+}
+
+ProcessControlBlock& PcbStore::create(int pid, int burst, int priority, int io_time, int io_freq) {
+    int s = allocateSlot();
+    if (head == index.size() && (sparse.empty() || pid > sparse.rbegin()->first)) {
+        index.clear();
+        head = 0;
+        first_pid = pid;
+    }
+    if (head == index.size() || pid < first_pid) {
+        // Pids normally only grow; an older one goes with the other old ones.
+        sparse.emplace(pid, s);
+    } else {
+        size_t i = head + static_cast<size_t>(pid - first_pid);
+        if (i >= index.size()) index.resize(i + 1, FREE);
+        index[i] = s;
+    }
+    live++;
+    return *new (slot(s)) ProcessControlBlock(pid, burst, priority, io_time, io_freq);
+}
+
+ProcessControlBlock* PcbStore::find(int pid) {
+    int* entry = indexEntry(pid);
+    return (entry != nullptr && *entry != FREE) ? slot(*entry) : nullptr;
+}
+
+const ProcessControlBlock* PcbStore::find(int pid) const {
+    return const_cast<PcbStore*>(this)->find(pid);
+}
+
+bool PcbStore::release(int pid) {
+    int* entry = indexEntry(pid);
+    if (entry == nullptr || *entry == FREE) return false;
+    slot(*entry)->~ProcessControlBlock();
+    free_slots.push_back(*entry);
+    live--;
+    if (pid < first_pid || head == index.size()) {
+        sparse.erase(pid);
+    } else {
+        *entry = FREE;
+        trimIndex();
+    }
+    return true;
+}
+
+// Drop released pids from both ends of the index so it only spans live ones.
+// While the span is mostly holes, the oldest live PCB moves to `sparse`.
+void PcbStore::trimIndex() {
+    while (!index.empty() && index.back() == FREE) index.pop_back();
+    while (head < index.size()) {
+        if (index[head] != FREE) {
+            size_t dense = live - sparse.size();
+            if (index.size() - head <= 2 * dense + MIN_INDEX_SPAN) break;
+            sparse.emplace(first_pid, index[head]);
+            index[head] = FREE;
+        }
+        head++;
+        first_pid++;
+    }
+    if (head >= index.size()) {
+        index.clear();
+        head = 0;
+    } else if (head > index.size() / 2) {
+        index.erase(index.begin(), index.begin() + head);
+        head = 0;
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef PCB_STORE_HPP
+#define PCB_STORE_HPP
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <vector>
+#include "pcb.hpp"
+
+// Owns every process control block of a System. PCBs are constructed in place in
+// fixed-size slabs that are never moved or freed, so the pointers held by ready
+// queues, the timer wheel, the mutex and the MMU stay valid until the PCB is
+// released; released slots are reused by later PCBs. Lookup by pid goes through
+// a dense array covering the range of recent pids that still have a live PCB,
+// which shrinks from the front as the oldest processes are reaped. Old PCBs
+// that outlive their neighbours (a terminated process that is never reaped)
+// are moved to an ordered map once the array is mostly holes, so it does not
+// keep growing with the number of pids created.
+class PcbStore {
+public:
+    explicit PcbStore(size_t slab_size = 256);
+    ~PcbStore();
+    PcbStore(const PcbStore&) = delete;
+    PcbStore& operator=(const PcbStore&) = delete;
+
+    // Construct a PCB for `pid`, which must not already be live.
+    ProcessControlBlock& create(int pid, int burst, int priority, int io_time = 0, int io_freq = 0);
+    ProcessControlBlock* find(int pid);
+    const ProcessControlBlock* find(int pid) const;
+    bool contains(int pid) const { return find(pid) != nullptr; }
+    // Destroy the PCB and recycle its slot. Returns false if `pid` is not live.
+    bool release(int pid);
+
+    size_t size() const { return live; }
+    bool empty() const { return live == 0; }
+    // Slots allocated so far; memory only grows when every slot is in use.
+    size_t capacity() const { return slabs.size() * slab_size; }
+    // Pids spanned by the dense index, live or not.
+    size_t indexSpan() const { return index.size() - head; }
+
+    // Visit every live PCB in pid order.
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (const auto& entry : sparse) visit(static_cast<const ProcessControlBlock&>(*slot(entry.second)));
+        for (size_t i = head; i < index.size(); ++i) {
+            if (index[i] != FREE) visit(static_cast<const ProcessControlBlock&>(*slot(index[i])));
+        }
+    }
+    template <typename Visitor>
+    void forEach(Visitor visit) {
+        for (const auto& entry : sparse) visit(*slot(entry.second));
+        for (size_t i = head; i < index.size(); ++i) {
+            if (index[i] != FREE) visit(*slot(index[i]));
+        }
+    }
+
+private:
+    static constexpr int FREE = -1;
+    static constexpr size_t MIN_INDEX_SPAN = 64;   // never made sparser than this
+
+    struct Storage {
+        alignas(ProcessControlBlock) unsigned char bytes[sizeof(ProcessControlBlock)];
+    };
+
+    size_t slab_size;
+    std::vector<std::unique_ptr<Storage[]>> slabs;
+    std::vector<int> free_slots;    // LIFO, so the most recently released (warmest) slot is reused first
+    std::vector<int> index;         // index[head + k] is the slot of pid first_pid + k, or FREE
+    size_t head;
+    int first_pid;
+    size_t live;
+    std::map<int, int> sparse;      // pid -> slot of old live PCBs, all below first_pid
+
+    ProcessControlBlock* slot(int s) const {
+        return reinterpret_cast<ProcessControlBlock*>(slabs[s / slab_size][s % slab_size].bytes);
+    }
+    int* indexEntry(int pid);
+    int allocateSlot();
+    void trimIndex();
+};
+
+#endif
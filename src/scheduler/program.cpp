@@ -0,0 +1,119 @@
+#include "program.hpp"
+#include <climits>
+#include <sstream>
+#include "core/types.hpp"
+
+static const char* accessName(uint8_t access) {
+    switch (static_cast<AccessType>(access)) {
+        case AccessType::READ: return "READ";
+        case AccessType::WRITE: return "WRITE";
+        case AccessType::EXECUTE: return "EXECUTE";
+    }
+    return "READ";
+}
+
+static int internMutex(Program& program, const std::string& name) {
+    for (size_t i = 0; i < program.mutex_names.size(); ++i) {
+        if (program.mutex_names[i] == name) return static_cast<int>(i);
+    }
+    program.mutex_names.push_back(name);
+    return static_cast<int>(program.mutex_names.size() - 1);
+}
+
+bool parseProgram(const std::string& name, const std::string& source, Program& program, std::string* error) {
+    program = Program();
+    program.name = name;
+
+    struct OpenLoop {
+        int body;           // first instruction of the body
+        long long count;
+        long long cpu_time; // COMPUTE ticks of one iteration of the body so far
+    };
+    std::vector<OpenLoop> loops;
+    long long cpu_time = 0;
+    auto fail = [&](const std::string& statement, const std::string& why) {
+        if (error) *error = "'" + statement + "': " + why;
+        return false;
+    };
+
+    std::string statement;
+    std::istringstream statements(source);
+    while (std::getline(statements, statement, ';')) {
+        std::istringstream lines(statement);
+        std::string line;
+        while (std::getline(lines, line)) {
+            std::istringstream words(line);
+            std::string op, operand;
+            if (!(words >> op)) continue;
+
+            Instruction instr = {OpCode::COMPUTE, 0, 0};
+            long long value = 0;
+            if (op == "compute" || op == "read" || op == "sleep" || op == "repeat") {
+                if (!(words >> value) || value < 1 || value > INT_MAX) return fail(line, "expected a positive count");
+                instr.arg = static_cast<int32_t>(value);
+                instr.op = op == "compute" ? OpCode::COMPUTE : op == "read" ? OpCode::READ
+                         : op == "sleep" ? OpCode::SLEEP : OpCode::REPEAT;
+            } else if (op == "touch") {
+                if (!(words >> value) || value < 0 || value > INT_MAX) return fail(line, "expected a page number");
+                instr.op = OpCode::TOUCH;
+                instr.arg = static_cast<int32_t>(value);
+                AccessType type = AccessType::READ;
+                if (words >> operand) {
+                    if (operand == "WRITE") type = AccessType::WRITE;
+                    else if (operand == "EXECUTE") type = AccessType::EXECUTE;
+                    else if (operand != "READ") return fail(line, "access must be READ, WRITE or EXECUTE");
+                }
+                instr.access = static_cast<uint8_t>(type);
+            } else if (op == "lock" || op == "unlock") {
+                if (!(words >> operand)) return fail(line, "expected a mutex name");
+                instr.op = op == "lock" ? OpCode::LOCK : OpCode::UNLOCK;
+                instr.arg = internMutex(program, operand);
+            } else if (op == "end") {
+                if (loops.empty()) return fail(line, "no repeat to end");
+                instr.op = OpCode::END;
+                instr.arg = loops.back().body;
+            } else {
+                return fail(line, "unknown instruction");
+            }
+            if (words >> operand) return fail(line, "unexpected '" + operand + "'");
+
+            long long& total = loops.empty() ? cpu_time : loops.back().cpu_time;
+            if (instr.op == OpCode::COMPUTE) {
+                total += instr.arg;
+            } else if (instr.op == OpCode::REPEAT) {
+                if (loops.size() == static_cast<size_t>(MAX_LOOP_DEPTH)) return fail(line, "repeat nested too deeply");
+                loops.push_back({static_cast<int>(program.code.size()) + 1, instr.arg, 0});
+            } else if (instr.op == OpCode::END) {
+                OpenLoop loop = loops.back();
+                loops.pop_back();
+                long long& outer = loops.empty() ? cpu_time : loops.back().cpu_time;
+                outer += loop.count * loop.cpu_time;
+            }
+            if (cpu_time > INT_MAX || (!loops.empty() && loops.back().cpu_time > INT_MAX)) {
+                return fail(line, "program computes for too long");
+            }
+            program.code.push_back(instr);
+        }
+    }
+    if (!loops.empty()) return fail("repeat", "missing end");
+    if (cpu_time < 1) return fail(source, "a program must compute for at least one tick");
+    program.cpu_time = cpu_time;
+    program.mutexes.assign(program.mutex_names.size(), nullptr);
+    return true;
+}
+
+std::string describeInstruction(const Program& program, int pc) {
+    const Instruction& instr = program.code[pc];
+    std::string arg = std::to_string(instr.arg);
+    switch (instr.op) {
+        case OpCode::COMPUTE: return "compute " + arg;
+        case OpCode::TOUCH: return "touch " + arg + " " + accessName(instr.access);
+        case OpCode::LOCK: return "lock " + program.mutex_names[instr.arg];
+        case OpCode::UNLOCK: return "unlock " + program.mutex_names[instr.arg];
+        case OpCode::READ: return "read " + arg;
+        case OpCode::SLEEP: return "sleep " + arg;
+        case OpCode::REPEAT: return "repeat " + arg;
+        case OpCode::END: return "end";
+    }
+    return "?";
+}
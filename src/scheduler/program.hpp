@@ -0,0 +1,58 @@
+#ifndef PROGRAM_HPP
+#define PROGRAM_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Mutex;
+
+// Bytecode a process can run instead of a single CPU burst. Only COMPUTE uses
+// CPU time; every other instruction executes instantly when reached, and may
+// put the process to sleep.
+enum class OpCode : uint8_t {
+    COMPUTE,    // arg: ticks of CPU
+    TOUCH,      // arg: virtual page, access: AccessType
+    LOCK,       // arg: index into Program::mutex_names
+    UNLOCK,     // arg: index into Program::mutex_names
+    READ,       // arg: ticks of disk I/O
+    SLEEP,      // arg: ticks
+    REPEAT,     // arg: iterations of the body that follows (>= 1)
+    END         // arg: first instruction of the body to repeat
+};
+
+struct Instruction {
+    OpCode op;
+    uint8_t access;
+    int32_t arg;
+};
+
+const int MAX_LOOP_DEPTH = 4;
+
+struct Program {
+    std::string name;
+    std::vector<Instruction> code;
+    std::vector<std::string> mutex_names;
+    std::vector<Mutex*> mutexes;    // resolved by whoever loads the program, parallel to mutex_names
+    long long cpu_time = 0;         // COMPUTE ticks of one complete run
+};
+
+// Where a process is in its program. `code` is nullptr for a plain CPU burst.
+struct ProgramCounter {
+    const Program* code = nullptr;
+    int pc = 0;
+    int op_left = 0;                // ticks left of the COMPUTE at pc, 0 before it starts
+    int depth = 0;                  // open REPEAT blocks
+    int loop_left[MAX_LOOP_DEPTH] = {};
+};
+
+// Compile statements separated by ';' or newlines:
+//   compute <ticks> | touch <vpn> [READ|WRITE|EXECUTE] | lock <mutex> | unlock <mutex>
+//   read <ticks> | sleep <ticks> | repeat <n> ... end
+// The program must compute for at least one tick in total.
+bool parseProgram(const std::string& name, const std::string& source, Program& program, std::string* error = nullptr);
+
+// Source text of one instruction, for listings.
+std::string describeInstruction(const Program& program, int pc);
+
+#endif
@@ -0,0 +1,298 @@
+#include "ready_queue.hpp"
+#include <algorithm>
+
+// Positions start far from zero so pushFront() never drives them negative.
+static const long long RING_ORIGIN = 1LL << 40;
+static const size_t RING_INITIAL_CAPACITY = 16;
+
+// --- FifoReadyQueue ---
+
+FifoReadyQueue::FifoReadyQueue()
+    : slots(RING_INITIAL_CAPACITY, nullptr), head(RING_ORIGIN), tail(RING_ORIGIN), live(0) {}
+
+void FifoReadyQueue::grow() {
+    // Tombstones are dropped while copying, which also frees up room.
+    if (live * 2 <= slots.size()) {
+        compact();
+        return;
+    }
+    std::vector<ProcessControlBlock*> bigger(slots.size() * 2, nullptr);
+    size_t mask = bigger.size() - 1;
+    for (long long pos = head; pos < tail; ++pos) {
+        bigger[pos & mask] = at(pos);
+    }
+    slots.swap(bigger);
+}
+
+void FifoReadyQueue::compact() {
+    std::vector<ProcessControlBlock*> packed(slots.size(), nullptr);
+    size_t mask = packed.size() - 1;
+    long long out = head;
+    for (long long pos = head; pos < tail; ++pos) {
+        ProcessControlBlock* pcb = at(pos);
+        if (pcb != nullptr) {
+            pcb->ready_handle = out;
+            packed[out & mask] = pcb;
+            out++;
+        }
+    }
+    tail = out;
+    slots.swap(packed);
+}
+
+void FifoReadyQueue::push(ProcessControlBlock* pcb) {
+    if (static_cast<size_t>(tail - head) == slots.size()) grow();
+    pcb->ready_handle = tail;
+    at(tail) = pcb;
+    tail++;
+    live++;
+}
+
+void FifoReadyQueue::pushFront(ProcessControlBlock* pcb) {
+    if (static_cast<size_t>(tail - head) == slots.size()) grow();
+    head--;
+    pcb->ready_handle = head;
+    at(head) = pcb;
+    live++;
+}
+
+ProcessControlBlock* FifoReadyQueue::pop() {
+    while (head < tail) {
+        ProcessControlBlock* pcb = at(head);
+        at(head) = nullptr;
+        head++;
+        if (pcb != nullptr) {
+            pcb->ready_handle = NOT_QUEUED;
+            live--;
+            return pcb;
+        }
+    }
+    return nullptr;
+}
+
+bool FifoReadyQueue::remove(ProcessControlBlock* pcb) {
+    long long pos = pcb->ready_handle;
+    if (pos < head || pos >= tail || at(pos) != pcb) {
+        return false;
+    }
+    at(pos) = nullptr;
+    pcb->ready_handle = NOT_QUEUED;
+    live--;
+    // Trim tombstones at either end so they never accumulate past the live range.
+    while (head < tail && at(head) == nullptr) head++;
+    while (tail > head && at(tail - 1) == nullptr) tail--;
+    return true;
+}
+
+// The tail is the process that would wait longest here.
+ProcessControlBlock* FifoReadyQueue::steal() {
+    if (live == 0) return nullptr;
+    ProcessControlBlock* pcb = at(tail - 1);
+    remove(pcb);
+    return pcb;
+}
+
+std::vector<ProcessControlBlock*> FifoReadyQueue::snapshot() const {
+    std::vector<ProcessControlBlock*> out;
+    out.reserve(live);
+    for (long long pos = head; pos < tail; ++pos) {
+        if (at(pos) != nullptr) out.push_back(at(pos));
+    }
+    return out;
+}
+
+// --- HeapReadyQueue ---
+
+HeapReadyQueue::HeapReadyQueue(KeyFn key) : key(key), next_seq(0), front_seq(-1) {}
+
+bool HeapReadyQueue::less(const ProcessControlBlock* a, const ProcessControlBlock* b) const {
+    int ka = key(a), kb = key(b);
+    if (ka != kb) return ka < kb;
+    return a->ready_seq < b->ready_seq;
+}
+
+void HeapReadyQueue::place(size_t i, ProcessControlBlock* pcb) {
+    heap[i] = pcb;
+    pcb->ready_handle = static_cast<long long>(i);
+}
+
+void HeapReadyQueue::siftUp(size_t i) {
+    ProcessControlBlock* pcb = heap[i];
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!less(pcb, heap[parent])) break;
+        place(i, heap[parent]);
+        i = parent;
+    }
+    place(i, pcb);
+}
+
+void HeapReadyQueue::siftDown(size_t i) {
+    ProcessControlBlock* pcb = heap[i];
+    size_t n = heap.size();
+    while (true) {
+        size_t child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && less(heap[child + 1], heap[child])) child++;
+        if (!less(heap[child], pcb)) break;
+        place(i, heap[child]);
+        i = child;
+    }
+    place(i, pcb);
+}
+
+void HeapReadyQueue::insert(ProcessControlBlock* pcb) {
+    heap.push_back(pcb);
+    siftUp(heap.size() - 1);
+}
+
+void HeapReadyQueue::push(ProcessControlBlock* pcb) {
+    pcb->ready_seq = next_seq++;
+    insert(pcb);
+}
+
+void HeapReadyQueue::pushFront(ProcessControlBlock* pcb) {
+    pcb->ready_seq = front_seq--;
+    insert(pcb);
+}
+
+ProcessControlBlock* HeapReadyQueue::pop() {
+    if (heap.empty()) return nullptr;
+    ProcessControlBlock* top = heap.front();
+    remove(top);
+    return top;
+}
+
+bool HeapReadyQueue::remove(ProcessControlBlock* pcb) {
+    long long idx = pcb->ready_handle;
+    if (idx < 0 || idx >= static_cast<long long>(heap.size()) || heap[idx] != pcb) {
+        return false;
+    }
+    size_t i = static_cast<size_t>(idx);
+    ProcessControlBlock* last = heap.back();
+    heap.pop_back();
+    pcb->ready_handle = NOT_QUEUED;
+    if (i < heap.size()) {
+        place(i, last);
+        if (i > 0 && less(last, heap[(i - 1) / 2])) siftUp(i);
+        else siftDown(i);
+    }
+    return true;
+}
+
+// The last array slot is a leaf, i.e. ranked behind at least its ancestors,
+// and removing it needs no sifting.
+ProcessControlBlock* HeapReadyQueue::steal() {
+    if (heap.empty()) return nullptr;
+    ProcessControlBlock* pcb = heap.back();
+    remove(pcb);
+    return pcb;
+}
+
+std::vector<ProcessControlBlock*> HeapReadyQueue::snapshot() const {
+    std::vector<ProcessControlBlock*> out(heap);
+    std::sort(out.begin(), out.end(),
+        [this](const ProcessControlBlock* a, const ProcessControlBlock* b) { return less(a, b); });
+    return out;
+}
+
+// --- CfsReadyQueue ---
+
+// Linux's sched_prio_to_weight table, indexed by nice + 20.
+static const int NICE_TO_WEIGHT[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+     9548,  7620,  6100,  4904,  3906,
+     3121,  2501,  1991,  1586,  1277,
+     1024,   820,   655,   526,   423,
+      335,   272,   215,   172,   137,
+      110,    87,    70,    56,    45,
+       36,    29,    23,    18,    15,
+};
+
+int cfsWeight(int priority) {
+    int nice = std::max(-20, std::min(19, priority));
+    return NICE_TO_WEIGHT[nice + 20];
+}
+
+long long cfsVruntimeDelta(int ticks, int weight) {
+    long long per_tick = (static_cast<long long>(NICE_0_WEIGHT) << VRUNTIME_SHIFT) / weight;
+    return ticks * per_tick;
+}
+
+CfsReadyQueue::CfsReadyQueue()
+    : min_vruntime(0), total_weight(0), weighted_vruntime(0.0), next_seq(0), front_seq(-1) {}
+
+void CfsReadyQueue::advanceMin(long long vruntime) {
+    if (vruntime <= min_vruntime) return;
+    // weighted_vruntime is kept relative to min_vruntime.
+    weighted_vruntime -= static_cast<double>(total_weight) * (vruntime - min_vruntime);
+    min_vruntime = vruntime;
+}
+
+void CfsReadyQueue::insert(ProcessControlBlock* pcb) {
+    pcb->load_weight = cfsWeight(pcb->priority);
+    pcb->vruntime = std::max(pcb->vruntime, min_vruntime);
+    pcb->ready_handle = 0; // the tree is searched by (vruntime, ready_seq); any non-NOT_QUEUED value will do
+    tree.insert(pcb);
+    total_weight += pcb->load_weight;
+    weighted_vruntime += static_cast<double>(pcb->load_weight) * (pcb->vruntime - min_vruntime);
+}
+
+void CfsReadyQueue::erase(std::set<ProcessControlBlock*, VruntimeLess>::iterator it) {
+    ProcessControlBlock* pcb = *it;
+    tree.erase(it);
+    total_weight -= pcb->load_weight;
+    weighted_vruntime -= static_cast<double>(pcb->load_weight) * (pcb->vruntime - min_vruntime);
+    pcb->ready_handle = NOT_QUEUED;
+}
+
+void CfsReadyQueue::push(ProcessControlBlock* pcb) {
+    pcb->ready_seq = next_seq++;
+    insert(pcb);
+}
+
+void CfsReadyQueue::pushFront(ProcessControlBlock* pcb) {
+    pcb->ready_seq = front_seq--;
+    insert(pcb);
+}
+
+ProcessControlBlock* CfsReadyQueue::pop() {
+    if (tree.empty()) return nullptr;
+    ProcessControlBlock* pcb = *tree.begin();
+    erase(tree.begin());
+    // The leftmost process had the smallest vruntime, so the floor can rise to it.
+    advanceMin(pcb->vruntime);
+    return pcb;
+}
+
+bool CfsReadyQueue::remove(ProcessControlBlock* pcb) {
+    if (pcb->ready_handle == NOT_QUEUED) return false;
+    auto it = tree.find(pcb);
+    if (it == tree.end() || *it != pcb) return false;
+    erase(it);
+    return true;
+}
+
+// The rightmost process has had the most CPU and is the last one due to run here.
+ProcessControlBlock* CfsReadyQueue::steal() {
+    if (tree.empty()) return nullptr;
+    auto it = std::prev(tree.end());
+    ProcessControlBlock* pcb = *it;
+    erase(it);
+    return pcb;
+}
+
+std::vector<ProcessControlBlock*> CfsReadyQueue::snapshot() const {
+    return std::vector<ProcessControlBlock*>(tree.begin(), tree.end());
+}
+
+double CfsReadyQueue::lag(const ProcessControlBlock* pcb) const {
+    int weight = cfsWeight(pcb->priority);
+    double load = static_cast<double>(total_weight + weight);
+    double sum = weighted_vruntime + static_cast<double>(weight) * (pcb->vruntime - min_vruntime);
+    double avg = sum / load;
+    double own = static_cast<double>(pcb->vruntime - min_vruntime);
+    // Convert weighted vruntime back into CPU ticks for this process.
+    return (avg - own) * weight / (static_cast<double>(NICE_0_WEIGHT) * (1LL << VRUNTIME_SHIFT));
+}
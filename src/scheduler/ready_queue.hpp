@@ -0,0 +1,148 @@
+#ifndef READY_QUEUE_HPP
+#define READY_QUEUE_HPP
+
+#include <cstddef>
+#include <set>
+#include <vector>
+#include "pcb.hpp"
+
+// Abstract ready queue. Every queued PCB carries a handle (ready_handle) into the
+// structure holding it, so a process can be removed without a linear search.
+class ReadyQueue {
+public:
+    virtual ~ReadyQueue() = default;
+
+    // Enqueue behind every process of equal rank.
+    virtual void push(ProcessControlBlock* pcb) = 0;
+    // Enqueue ahead of every process of equal rank (used when a paused run is resumed).
+    virtual void pushFront(ProcessControlBlock* pcb) = 0;
+    // Dequeue the next process to dispatch, or nullptr if empty.
+    virtual ProcessControlBlock* pop() = 0;
+    // Remove a specific process. Returns false if it was not queued here.
+    virtual bool remove(ProcessControlBlock* pcb) = 0;
+    // Dequeue a process that is far from being dispatched, for migration to
+    // another CPU. Returns nullptr if empty.
+    virtual ProcessControlBlock* steal() = 0;
+
+    virtual size_t size() const = 0;
+    bool empty() const { return size() == 0; }
+    bool contains(const ProcessControlBlock* pcb) const { return pcb->ready_handle != NOT_QUEUED; }
+
+    // Queued processes in dispatch order (for display only).
+    virtual std::vector<ProcessControlBlock*> snapshot() const = 0;
+};
+
+// Round Robin: a ring-buffer deque. Removed entries leave a tombstone that pop()
+// skips, so removal by handle is O(1); tombstones are compacted when they dominate.
+class FifoReadyQueue : public ReadyQueue {
+public:
+    FifoReadyQueue();
+
+    void push(ProcessControlBlock* pcb) override;
+    void pushFront(ProcessControlBlock* pcb) override;
+    ProcessControlBlock* pop() override;
+    bool remove(ProcessControlBlock* pcb) override;
+    ProcessControlBlock* steal() override;
+    size_t size() const override { return live; }
+    std::vector<ProcessControlBlock*> snapshot() const override;
+
+private:
+    std::vector<ProcessControlBlock*> slots;
+    long long head; // absolute position of the first slot in use
+    long long tail; // absolute position one past the last slot in use
+    size_t live;
+
+    ProcessControlBlock*& at(long long pos) { return slots[pos & (slots.size() - 1)]; }
+    ProcessControlBlock* at(long long pos) const { return slots[pos & (slots.size() - 1)]; }
+    void grow();
+    void compact();
+};
+
+// PRIORITY / SJF: an indexed binary min-heap. Each PCB's ready_handle is its slot in
+// the heap array, so removal is a sift from a known position in O(log n).
+// Ties are broken by enqueue order to match first-come-first-served among equals.
+class HeapReadyQueue : public ReadyQueue {
+public:
+    using KeyFn = int (*)(const ProcessControlBlock*);
+
+    explicit HeapReadyQueue(KeyFn key);
+
+    void push(ProcessControlBlock* pcb) override;
+    void pushFront(ProcessControlBlock* pcb) override;
+    ProcessControlBlock* pop() override;
+    bool remove(ProcessControlBlock* pcb) override;
+    ProcessControlBlock* steal() override;
+    size_t size() const override { return heap.size(); }
+    std::vector<ProcessControlBlock*> snapshot() const override;
+
+private:
+    KeyFn key;
+    std::vector<ProcessControlBlock*> heap;
+    long long next_seq;
+    long long front_seq;
+
+    bool less(const ProcessControlBlock* a, const ProcessControlBlock* b) const;
+    void place(size_t i, ProcessControlBlock* pcb);
+    void siftUp(size_t i);
+    void siftDown(size_t i);
+    void insert(ProcessControlBlock* pcb);
+};
+
+// CFS weights. A nice-0 process has weight NICE_0_WEIGHT; vruntime is kept in
+// fixed point with VRUNTIME_SHIFT fractional bits of a nice-0 tick.
+const int NICE_0_WEIGHT = 1024;
+const int VRUNTIME_SHIFT = 16;
+
+// Load weight of a process, reading its priority as a nice value clamped to
+// -20..19 (lower is more important). Adjacent levels differ by about 1.25x.
+int cfsWeight(int priority);
+// vruntime charged for `ticks` of CPU at `weight`. Linear in `ticks`, so charging
+// a span in one go equals charging it tick by tick.
+long long cfsVruntimeDelta(int ticks, int weight);
+
+// CFS: a red-black tree (std::set) ordered by vruntime, ties by enqueue order.
+// The leftmost process has received the least weighted CPU time and runs next.
+// Enqueued processes are placed no earlier than min_vruntime, so time spent
+// sleeping or newly created does not turn into a burst of catch-up CPU.
+class CfsReadyQueue : public ReadyQueue {
+public:
+    CfsReadyQueue();
+
+    void push(ProcessControlBlock* pcb) override;
+    void pushFront(ProcessControlBlock* pcb) override;
+    ProcessControlBlock* pop() override;
+    bool remove(ProcessControlBlock* pcb) override;
+    ProcessControlBlock* steal() override;
+    size_t size() const override { return tree.size(); }
+    std::vector<ProcessControlBlock*> snapshot() const override;
+
+    // Monotonic floor of the vruntimes in this queue.
+    long long minVruntime() const { return min_vruntime; }
+    // Sum of the weights of the queued processes.
+    long long load() const { return total_weight; }
+    // Service lag in ticks of a process not queued here (e.g. the one running): the
+    // weighted-average vruntime of the queue plus `pcb`, minus pcb's own, scaled back
+    // to CPU time. Positive means it is owed CPU.
+    double lag(const ProcessControlBlock* pcb) const;
+
+private:
+    struct VruntimeLess {
+        bool operator()(const ProcessControlBlock* a, const ProcessControlBlock* b) const {
+            if (a->vruntime != b->vruntime) return a->vruntime < b->vruntime;
+            return a->ready_seq < b->ready_seq;
+        }
+    };
+
+    std::set<ProcessControlBlock*, VruntimeLess> tree;
+    long long min_vruntime;
+    long long total_weight;
+    double weighted_vruntime; // sum of weight * (vruntime - min_vruntime) over the tree
+    long long next_seq;
+    long long front_seq;
+
+    void insert(ProcessControlBlock* pcb);
+    void erase(std::set<ProcessControlBlock*, VruntimeLess>::iterator it);
+    void advanceMin(long long vruntime);
+};
+
+#endif
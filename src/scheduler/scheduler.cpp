@@ -4,173 +4,762 @@
 #include <algorithm>
 #include <limits>
 #include <iomanip>
+#include <cmath>
 #include "../memory/virtual_memory/virtual_memory.hpp"
 using namespace std;
 
-Scheduler::Scheduler(SchedulingPolicy policy, int time_quantum) 
-    : policy(policy), time_quantum(time_quantum), current_log_level(NORMAL) 
+Scheduler::Scheduler(SchedulingPolicy policy, int time_quantum, std::ostream& out) 
+    : policy(policy), time_quantum(time_quantum),
+      cfs_target_latency(DEFAULT_CFS_TARGET_LATENCY), cfs_min_granularity(DEFAULT_CFS_MIN_GRANULARITY),
+      execution_mode(ExecutionMode::TICK),
+      balance_interval(DEFAULT_BALANCE_INTERVAL), out(&out), out_sink(out), logger(out_sink),
+      tracer(nullptr), trace_clock(0), program_host(nullptr), load_controller(nullptr)
 {
-    std::string policy_name;
+    resetCpus(1);
+    MOSKS_LOG(logger, NORMAL, "Scheduler initialized for policy: " << schedulingPolicyToString(policy));
+}
+
+std::string schedulingPolicyToString(SchedulingPolicy policy) {
     switch (policy) {
-        case SchedulingPolicy::ROUND_ROBIN: policy_name = "Round Robin"; break;
-        case SchedulingPolicy::PRIORITY: policy_name = "Priority"; break;
-        case SchedulingPolicy::SJF: policy_name = "SJF"; break;
+        case SchedulingPolicy::ROUND_ROBIN: return "RR";
+        case SchedulingPolicy::PRIORITY: return "PRIORITY";
+        case SchedulingPolicy::SJF: return "SJF";
+        case SchedulingPolicy::CFS: return "CFS";
     }
-    log(NORMAL, "Scheduler initialized for policy: " + policy_name);
+    return "UNKNOWN";
+}
+
+bool parseSchedulingPolicy(const std::string& name, SchedulingPolicy& policy) {
+    if (name == "RR" || name == "ROUND_ROBIN") policy = SchedulingPolicy::ROUND_ROBIN;
+    else if (name == "PRIORITY") policy = SchedulingPolicy::PRIORITY;
+    else if (name == "SJF") policy = SchedulingPolicy::SJF;
+    else if (name == "CFS") policy = SchedulingPolicy::CFS;
+    else return false;
+    return true;
+}
+
+bool parseExecutionMode(const std::string& name, ExecutionMode& mode) {
+    if (name == "tick") mode = ExecutionMode::TICK;
+    else if (name == "event") mode = ExecutionMode::EVENT;
+    else return false;
+    return true;
+}
+
+void Scheduler::setExecutionMode(ExecutionMode mode) {
+    execution_mode = mode;
 }
 
 void Scheduler::setLogLevel(LogLevel level) {
-    current_log_level = level;
+    logger.setLevel(level);
+}
+
+void Scheduler::setOutput(std::ostream& stream) {
+    out = &stream;
+    out_sink.setStream(stream);
+}
+
+void Scheduler::setLogSink(LogSink* sink) {
+    logger.setSink(sink != nullptr ? *sink : out_sink);
+}
+
+
+static std::string wakeReasonToString(WakeReason reason) {
+    switch (reason) {
+        case WakeReason::IO: return "I/O";
+        case WakeReason::PAGE_FAULT: return "page-fault service";
+        case WakeReason::DISK: return "disk I/O";
+        case WakeReason::SLEEP: return "sleep";
+    }
+    return "wait";
+}
+
+static int priorityKey(const ProcessControlBlock* pcb) { return pcb->priority; }
+static int burstKey(const ProcessControlBlock* pcb) { return pcb->remaining_burst_time; }
+
+std::unique_ptr<ReadyQueue> Scheduler::makeReadyQueue() const {
+    switch (policy) {
+        case SchedulingPolicy::PRIORITY: return std::unique_ptr<ReadyQueue>(new HeapReadyQueue(priorityKey));
+        case SchedulingPolicy::SJF: return std::unique_ptr<ReadyQueue>(new HeapReadyQueue(burstKey));
+        case SchedulingPolicy::CFS: return std::unique_ptr<ReadyQueue>(new CfsReadyQueue());
+        case SchedulingPolicy::ROUND_ROBIN: break;
+    }
+    return std::unique_ptr<ReadyQueue>(new FifoReadyQueue());
+}
+
+
+// --- CPU CONFIGURATION ---
+void Scheduler::resetCpus(int count) {
+    cpus.clear();
+    cpus.resize(count);
+    for (int i = 0; i < count; ++i) {
+        CpuCore& cpu = cpus[i];
+        cpu.id = i;
+        if (count > 1) {
+            cpu.owned_queue = makeReadyQueue();
+            cpu.run_queue = cpu.owned_queue.get();
+        }
+        cpu.queue_length_ticks.assign(RUNQ_HISTOGRAM_BUCKETS, 0);
+    }
+}
+
+// Hand anything still queued on a per-CPU run queue back to the shared queue.
+void Scheduler::drainRunQueues(ReadyQueue& ready_queue) {
+    for (auto& cpu : cpus) {
+        if (cpu.owned_queue) {
+            while (ProcessControlBlock* pcb = cpu.owned_queue->pop()) {
+                ready_queue.push(pcb);
+                trace(TraceEvent::MIGRATE, pcb, trace_clock, -1, cpu.id);
+            }
+        }
+    }
+}
+
+void Scheduler::setCpuCount(int count, int interval, ReadyQueue& ready_queue) {
+    if (count < 1) count = 1;
+    if (interval < 1) interval = 1;
+
+    drainRunQueues(ready_queue);
+    resetCpus(count);
+    balance_interval = interval;
+    MOSKS_LOG(logger, NORMAL, "Scheduler configured for " << count << " CPU(s), load balancing every " << interval << " units.");
 }
 
-void Scheduler::log(LogLevel level, const std::string& message) {
-    if (current_log_level >= level) {
-        std::cout << message << std::endl;
+void Scheduler::setPolicy(SchedulingPolicy new_policy, ReadyQueue& ready_queue) {
+    drainRunQueues(ready_queue);
+    policy = new_policy;
+    resetCpus(static_cast<int>(cpus.size()));
+    MOSKS_LOG(logger, NORMAL, "Scheduling policy set to " << schedulingPolicyToString(policy) << ".");
+}
+
+void Scheduler::setCfsTunables(int target_latency, int min_granularity) {
+    cfs_min_granularity = std::max(1, min_granularity);
+    cfs_target_latency = std::max(cfs_min_granularity, target_latency);
+}
+
+int Scheduler::runQueueBucket(size_t length) {
+    if (length < 4) return static_cast<int>(length);
+    int bucket = 2;
+    while (length >= 4 && bucket < RUNQ_HISTOGRAM_BUCKETS - 1) {
+        length >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static int cpuLoad(const CpuCore& cpu) {
+    return static_cast<int>(cpu.run_queue->size()) + (cpu.current != nullptr ? 1 : 0);
+}
+
+CpuCore& Scheduler::leastLoadedCpu() {
+    CpuCore* best = &cpus[0];
+    for (auto& cpu : cpus) {
+        if (cpuLoad(cpu) < cpuLoad(*best)) best = &cpu;
+    }
+    return *best;
+}
+
+// Queue a process on a specific core, counting a migration if it last belonged elsewhere.
+void Scheduler::enqueueOn(CpuCore& cpu, ProcessControlBlock* pcb) {
+    if (pcb->last_cpu != -1 && pcb->last_cpu != cpu.id) {
+        cpu.migrations_in++;
+        if (pcb->last_cpu < static_cast<int>(cpus.size())) cpus[pcb->last_cpu].migrations_out++;
+        // vruntime only means something relative to the queue it was earned on.
+        if (policy == SchedulingPolicy::CFS && pcb->last_cpu < static_cast<int>(cpus.size())) {
+            const auto* from = static_cast<const CfsReadyQueue*>(cpus[pcb->last_cpu].run_queue);
+            const auto* to = static_cast<const CfsReadyQueue*>(cpu.run_queue);
+            pcb->vruntime += to->minVruntime() - from->minVruntime();
+        }
+    }
+    pcb->last_cpu = cpu.id;
+    cpu.run_queue->push(pcb);
+}
+
+// Periodic balancing: move queued processes from the busiest core to the least
+// busy one until their loads differ by at most one.
+void Scheduler::balanceLoad(int system_time) {
+    while (true) {
+        CpuCore* busiest = &cpus[0];
+        CpuCore* idlest = &cpus[0];
+        for (auto& cpu : cpus) {
+            if (cpuLoad(cpu) > cpuLoad(*busiest)) busiest = &cpu;
+            if (cpuLoad(cpu) < cpuLoad(*idlest)) idlest = &cpu;
+        }
+        if (cpuLoad(*busiest) - cpuLoad(*idlest) <= 1) break;
+        ProcessControlBlock* pcb = busiest->run_queue->steal();
+        if (pcb == nullptr) break;
+        enqueueOn(*idlest, pcb);
+        trace(TraceEvent::MIGRATE, pcb, system_time, idlest->id, busiest->id);
+        MOSKS_LOG(logger, VERBOSE, "Time " << system_time << ": Load balancer moved P" << pcb->process_id << " from CPU" << busiest->id << " to CPU" << idlest->id << ".");
     }
 }
 
+// An idle core with an empty run queue takes work from the longest queue.
+bool Scheduler::stealWork(CpuCore& thief, int system_time) {
+    CpuCore* victim = nullptr;
+    for (auto& cpu : cpus) {
+        if (&cpu == &thief || cpu.run_queue->empty()) continue;
+        if (victim == nullptr || cpu.run_queue->size() > victim->run_queue->size()) victim = &cpu;
+    }
+    if (victim == nullptr) return false;
+    ProcessControlBlock* pcb = victim->run_queue->steal();
+    enqueueOn(thief, pcb);
+    trace(TraceEvent::MIGRATE, pcb, system_time, thief.id, victim->id);
+    MOSKS_LOG(logger, VERBOSE, "Time " << system_time << ": CPU" << thief.id << " stole P" << pcb->process_id << " from CPU" << victim->id << ".");
+    return true;
+}
+
+long long Scheduler::getMigrations() const {
+    long long total = 0;
+    for (const auto& cpu : cpus) total += cpu.migrations_in;
+    return total;
+}
+
+long long Scheduler::getContextSwitches() const {
+    long long total = 0;
+    for (const auto& cpu : cpus) total += cpu.dispatches;
+    return total;
+}
+
+size_t Scheduler::readyCount(const ReadyQueue& ready_queue) const {
+    size_t total = ready_queue.size();
+    for (const auto& cpu : cpus) {
+        if (cpu.owned_queue) total += cpu.owned_queue->size();
+    }
+    return total;
+}
+
+bool Scheduler::dequeue(ProcessControlBlock* pcb, ReadyQueue& ready_queue) {
+    if (ready_queue.remove(pcb)) return true;
+    for (auto& cpu : cpus) {
+        if (cpu.owned_queue && cpu.owned_queue->remove(pcb)) return true;
+    }
+    return false;
+}
+
+std::string Scheduler::cpuTag(const CpuCore& cpu) const {
+    return cpus.size() > 1 ? " on CPU" + std::to_string(cpu.id) : "";
+}
+
+bool Scheduler::isPreemptive() const {
+    return policy == SchedulingPolicy::ROUND_ROBIN || policy == SchedulingPolicy::CFS;
+}
 
+// RR runs every process for the fixed quantum. CFS divides the scheduling period
+// among the runnable processes of the core in proportion to their weight.
+int Scheduler::timeSlice(const CpuCore& cpu, const ProcessControlBlock* pcb) const {
+    if (policy != SchedulingPolicy::CFS) return time_quantum;
+    const auto* cfs = static_cast<const CfsReadyQueue*>(cpu.run_queue);
+    long long weight = cfsWeight(pcb->priority);
+    long long load = weight + cfs->load();
+    long long runnable = static_cast<long long>(cpu.run_queue->size()) + 1;
+    long long period = std::max<long long>(cfs_target_latency, runnable * cfs_min_granularity);
+    return static_cast<int>(std::max<long long>(cfs_min_granularity, period * weight / load));
+}
 
+// A process's lag is most extreme right when it is dispatched (after waiting) and
+// right when it stops running, so sampling only there captures its maximum.
+void Scheduler::recordLag(const CpuCore& cpu, ProcessControlBlock* pcb) const {
+    if (policy != SchedulingPolicy::CFS) return;
+    const auto* cfs = static_cast<const CfsReadyQueue*>(cpu.run_queue);
+    pcb->max_lag = std::max(pcb->max_lag, std::fabs(cfs->lag(pcb)));
+}
 
 
 // --- RUN METHOD --
-void Scheduler::run(std::vector<ProcessControlBlock*>& ready_queue, 
-    std::vector<ProcessControlBlock*>& waiting_queue,int& system_time, 
+void Scheduler::run(ReadyQueue& ready_queue, 
+    TimerWheel& waiting_queue,int& system_time, 
     int num_steps) {
-    log(NORMAL, "\n--- Starting Scheduler ---");
+    MOSKS_LOG(logger, NORMAL, "\n--- Starting Scheduler ---");
     
-    ProcessControlBlock* current_process = nullptr;
-    int time_in_quantum = 0;
-    int steps_taken =0;
-
-    if (!ready_queue.empty() && ready_queue.front()->state == ProcessState::RUNNING) {
-        current_process = ready_queue.front();
-        ready_queue.erase(ready_queue.begin());
+    // With one CPU the caller's queue is the run queue. With several, it only
+    // holds arrivals, which are spread over the per-CPU run queues each tick.
+    const bool smp = cpus.size() > 1;
+    if (!smp) cpus[0].run_queue = &ready_queue;
+    for (auto& cpu : cpus) {
+        cpu.current = nullptr;
+        cpu.time_in_quantum = 0;
     }
+    int steps_taken =0;
+    std::vector<WakeEvent> woken;
+    trace_clock = system_time;
 
     // Main simulation loop: runs as long as there are processes to manage
     while (true) {
         if(num_steps != -1 && steps_taken >= num_steps){
-            log(NORMAL, "--- Scheduler paused after " + std::to_string(steps_taken) + " steps. ---");
-            if (current_process) { 
-                current_process->state = ProcessState::READY;
-                ready_queue.insert(ready_queue.begin(), current_process); 
+            MOSKS_LOG(logger, NORMAL, "--- Scheduler paused after " << steps_taken << " steps. ---");
+            for (auto& cpu : cpus) {
+                if (cpu.current) { 
+                    cpu.current->state = ProcessState::READY;
+                    cpu.run_queue->pushFront(cpu.current); 
+                    cpu.current->ready_since = system_time;
+                    trace(TraceEvent::PAUSE, cpu.current, system_time, smp ? cpu.id : -1, cpu.current->remaining_burst_time);
+                    cpu.current = nullptr;
+                }
             }
             break;
         }
         
-        // 1. Check waiting queue and move any finished I/O processes to the ready queue
-        for (size_t i = 0; i < waiting_queue.size(); ) {
-            ProcessControlBlock* pcb = waiting_queue[i];
-            pcb->io_burst_time--;
-            if (pcb->io_burst_time <= 0) {
-                pcb->state = ProcessState::READY;
-                ready_queue.push_back(pcb);
-                waiting_queue.erase(waiting_queue.begin() + i);
-                log(VERBOSE, "Time " + std::to_string(system_time) + ": P" + std::to_string(pcb->process_id) + " finished I/O, moved to ready.");
+        // 1. Advance the waiting queue's clock and move any processes whose wake-up
+        // time has arrived to the ready queue (on SMP, the queue of the CPU they ran on)
+        woken.clear();
+        waiting_queue.advance(system_time, woken);
+        for (const WakeEvent& wake : woken) {
+            ProcessControlBlock* pcb = wake.pcb;
+            if (wake.reason == WakeReason::PAGE_FAULT && load_controller != nullptr && load_controller->shouldSuspend(pcb)) {
+                pcb->state = ProcessState::SUSPENDED;
+                suspended.push_back(pcb);
+                stats.suspensions++;
+                trace(TraceEvent::SUSPEND, pcb, system_time, -1);
+                MOSKS_LOG(logger, VERBOSE, "Time " << system_time << ": P" << pcb->process_id << " suspended by load control.");
+                continue;
+            }
+            pcb->state = ProcessState::READY;
+            pcb->ready_since = system_time;
+            int queue_id = -1;
+            if (smp) {
+                bool has_home = pcb->last_cpu != -1 && pcb->last_cpu < static_cast<int>(cpus.size());
+                CpuCore& home = has_home ? cpus[pcb->last_cpu] : leastLoadedCpu();
+                enqueueOn(home, pcb);
+                queue_id = home.id;
             } else {
-                i++;
+                ready_queue.push(pcb);
+            }
+            trace(TraceEvent::WAKE, pcb, system_time, queue_id, wake.time, static_cast<uint8_t>(wake.reason));
+            MOSKS_LOG(logger, VERBOSE, "Time " << system_time << ": P" << pcb->process_id << " finished " << wakeReasonToString(wake.reason) << ", moved to ready.");
+        }
+
+        // Load control: with nothing else running, ready or waiting, the
+        // CPUs would idle, so a suspended process comes back regardless.
+        if (!suspended.empty()) {
+            bool idle = readyCount(ready_queue) == 0 && waiting_queue.empty();
+            for (const auto& cpu : cpus) {
+                idle = idle && cpu.current == nullptr;
+            }
+            if (idle || load_controller == nullptr || load_controller->shouldResume()) {
+                ProcessControlBlock* pcb = suspended.front();
+                suspended.pop_front();
+                pcb->state = ProcessState::READY;
+                pcb->ready_since = system_time;
+                ready_queue.push(pcb);
+                trace(TraceEvent::RESUME, pcb, system_time, -1);
+                MOSKS_LOG(logger, VERBOSE, "Time " << system_time << ": P" << pcb->process_id << " resumed by load control.");
+            }
+        }
+
+        if (smp) {
+            while (ProcessControlBlock* pcb = ready_queue.pop()) {
+                CpuCore& target = leastLoadedCpu();
+                enqueueOn(target, pcb);
+                trace(TraceEvent::MIGRATE, pcb, system_time, target.id, -1);
+            }
+            if (system_time % balance_interval == 0) {
+                balanceLoad(system_time);
             }
         }
 
         // 2. If a process is running, check if it needs to stop
-        if (current_process != nullptr) {
+        for (auto& cpu : cpus) {
+            ProcessControlBlock* current_process = cpu.current;
+            if (current_process == nullptr) continue;
             bool should_stop = false;
-            if (current_process->remaining_burst_time <= 0) { // Process finished
-                current_process->state = ProcessState::TERMINATED;
-                current_process->completion_time = system_time;
-                log(VERBOSE, "Time " + std::to_string(system_time) + ": P" + std::to_string(current_process->process_id) + " finished.");
+            if (current_process->program.code != nullptr &&
+                runProgram(cpu, current_process, system_time, waiting_queue) == ProgramStatus::BLOCKED) {
+                should_stop = true;
+            } else if (current_process->remaining_burst_time <= 0) { // Process finished
+                terminate(cpu, current_process, system_time);
                 should_stop = true;
             } else if (current_process->io_burst_frequency > 0 && current_process->time_since_last_io >= current_process->io_burst_frequency) { // Process needs I/O
-                current_process->state = ProcessState::WAITING;
                 current_process->time_since_last_io = 0;
-                waiting_queue.push_back(current_process);
-                log(VERBOSE, "Time " + std::to_string(system_time) + ": P" + std::to_string(current_process->process_id) + " moved to waiting for I/O.");
+                sleepFor(cpu, current_process, system_time, current_process->io_burst_time, WakeReason::IO, waiting_queue);
                 should_stop = true;
-            } else if (policy == SchedulingPolicy::ROUND_ROBIN && time_in_quantum >= time_quantum) { // Quantum expired for RR
+            } else if (isPreemptive() && cpu.time_in_quantum >= cpu.slice) { // RR quantum or CFS slice used up
+                recordLag(cpu, current_process);
                 current_process->state = ProcessState::READY;
-                ready_queue.push_back(current_process);
-                log(VERBOSE, "Time " + std::to_string(system_time) + ": P" + std::to_string(current_process->process_id) + " preempted (quantum expired).");
+                current_process->ready_since = system_time;
+                cpu.run_queue->push(current_process);
+                trace(TraceEvent::PREEMPT, current_process, system_time, smp ? cpu.id : -1, current_process->remaining_burst_time);
+                MOSKS_LOG(logger, VERBOSE, "Time " << system_time << ": P" << current_process->process_id << " preempted (" << (policy == SchedulingPolicy::CFS ? "slice" : "quantum") << " expired)" << cpuTag(cpu) << ".");
                 should_stop = true;
             }
 
             if (should_stop) {
-                current_process = nullptr;
-                time_in_quantum = 0;
+                cpu.current = nullptr;
+                cpu.time_in_quantum = 0;
             }
         }
 
-        // 3. If no process is running, select a new one from the ready queue based on policy
-        if (current_process == nullptr && !ready_queue.empty()) {
-            if (policy == SchedulingPolicy::ROUND_ROBIN) {
-                current_process = ready_queue.front();
-                ready_queue.erase(ready_queue.begin());
-            } else if (policy == SchedulingPolicy::PRIORITY) {
-                auto it = min_element(ready_queue.begin(), ready_queue.end(),
-                    [](const auto* a, const auto* b){ return a->priority < b->priority; });
-                current_process = *it;
-                ready_queue.erase(it);
-            } else if (policy == SchedulingPolicy::SJF) {
-                auto it = min_element(ready_queue.begin(), ready_queue.end(),
-                    [](const auto* a, const auto* b){ return a->remaining_burst_time < b->remaining_burst_time; });
-                current_process = *it;
-                ready_queue.erase(it);
+        // 3. If no process is running, select a new one from the ready queue.
+        // The queue structure already orders processes by policy (see makeReadyQueue).
+        // A program may sleep before using any CPU, in which case the next process is tried.
+        for (auto& cpu : cpus) {
+            while (cpu.current == nullptr) {
+                if (smp && cpu.run_queue->empty()) stealWork(cpu, system_time);
+                if (cpu.run_queue->empty()) break;
+                cpu.current = cpu.run_queue->pop();
+                cpu.current->state = ProcessState::RUNNING;
+                cpu.current->last_cpu = cpu.id;
+                cpu.slice = timeSlice(cpu, cpu.current);
+                recordLag(cpu, cpu.current);
+                cpu.dispatches++;
+                ProcessControlBlock* pcb = cpu.current;
+                pcb->total_wait_time += system_time - pcb->ready_since;
+                if (pcb->first_dispatch_time == -1) {
+                    pcb->first_dispatch_time = system_time;
+                    stats.response.record(system_time - pcb->creation_time);
+                }
+                stats.dispatches++;
+                trace(TraceEvent::DISPATCH, cpu.current, system_time, cpu.id, cpu.current->remaining_burst_time);
+                if (pcb->program.code == nullptr) break;
+                ProgramStatus status = runProgram(cpu, pcb, system_time, waiting_queue);
+                if (status == ProgramStatus::DONE) terminate(cpu, pcb, system_time);
+                if (status != ProgramStatus::RUNNING) cpu.current = nullptr;
             }
-            current_process->state = ProcessState::RUNNING;
         }
 
-        // 4. If a process is running, simulate one time unit of work
-        if (current_process != nullptr) {
-            std::stringstream ss;
-            ss << "Time " << system_time << ": Running P" << current_process->process_id << ". "
-               << "(CPU Burst left: " << current_process->remaining_burst_time << ")";
-            log(DEBUG, ss.str());
+        // In TICK mode every iteration covers one time unit. In EVENT mode it covers
+        // every unit up to the next instant at which steps 1-3 would change something.
+        int span = 1;
+        if (execution_mode == ExecutionMode::EVENT) {
+            int steps_left = (num_steps == -1) ? std::numeric_limits<int>::max() : num_steps - steps_taken;
+            span = ticksUntilNextEvent(waiting_queue, system_time, steps_left);
+        }
+
+        // 4. If a process is running, simulate `span` time units of work
+        bool all_idle = true;
+        for (auto& cpu : cpus) {
+            ProcessControlBlock* current_process = cpu.current;
+            cpu.queue_length_ticks[runQueueBucket(cpu.run_queue->size())] += span;
+            if (current_process != nullptr) {
+                MOSKS_LOG(logger, DEBUG, "Time " << system_time << ": Running P" << current_process->process_id << cpuTag(cpu) << ". "
+                                         << "(CPU Burst left: " << current_process->remaining_burst_time << ")"
+                                         << (span > 1 ? " for " + std::to_string(span) + " units" : ""));
 
-            current_process->remaining_burst_time--;
-            current_process->time_since_last_io++;
-            time_in_quantum++;
-        } else {
-            log(DEBUG, "Time " + std::to_string(system_time) + ": CPU is idle.");
+                current_process->remaining_burst_time -= span;
+                if (current_process->program.code != nullptr && (current_process->program.op_left -= span) == 0) {
+                    current_process->program.pc++;    // COMPUTE finished
+                }
+                if (policy == SchedulingPolicy::CFS) {
+                    current_process->vruntime += cfsVruntimeDelta(span, cfsWeight(current_process->priority));
+                }
+                current_process->time_since_last_io += span;
+                cpu.time_in_quantum += span;
+                cpu.busy_ticks += span;
+                all_idle = false;
+            } else {
+                MOSKS_LOG(logger, DEBUG, "Time " << system_time << ": CPU" << (smp ? std::to_string(cpu.id) : std::string()) << " is idle."
+                                         << (span > 1 ? " Skipping " + std::to_string(span) + " units." : ""));
+                cpu.idle_ticks += span;
+            }
         }
 
         // 5. Check if the simulation is complete
-        if (ready_queue.empty() && waiting_queue.empty() && current_process == nullptr) {
-            log(NORMAL, "--- Scheduler finished. All processes complete. ---");
+        bool queues_empty = ready_queue.empty() && waiting_queue.empty() && suspended.empty();
+        for (const auto& cpu : cpus) {
+            queues_empty = queues_empty && cpu.run_queue->empty();
+        }
+        if (queues_empty && all_idle) {
+            MOSKS_LOG(logger, NORMAL, "--- Scheduler finished. All processes complete. ---");
             break; // Exit the main loop
         }
         
         // 6. Advance the simulation time and step count
-        system_time++;
-        steps_taken++;
+        system_time += span;
+        steps_taken += span;
+        trace_clock = system_time;
+    }
+}
+
+void Scheduler::terminate(CpuCore& cpu, ProcessControlBlock* pcb, int system_time) {
+    recordLag(cpu, pcb);
+    pcb->state = ProcessState::TERMINATED;
+    pcb->completion_time = system_time;
+    stats.completed++;
+    stats.turnaround.record(system_time - pcb->creation_time);
+    stats.waiting.record(pcb->total_wait_time);
+    stats.worst_lag = std::max(stats.worst_lag, pcb->max_lag);
+    trace(TraceEvent::TERMINATE, pcb, system_time, cpu.id);
+    MOSKS_LOG(logger, VERBOSE, "Time " << system_time << ": P" << pcb->process_id << " finished" << cpuTag(cpu) << ".");
+}
+
+// Take the running process off the CPU until `ticks` (at least 1) have passed.
+void Scheduler::sleepFor(CpuCore& cpu, ProcessControlBlock* pcb, int system_time, int ticks, WakeReason reason,
+                         TimerWheel& waiting_queue) {
+    recordLag(cpu, pcb);
+    pcb->state = ProcessState::WAITING;
+    pcb->io_wake_time = system_time + std::max(1, ticks);
+    pcb->total_io_time += pcb->io_wake_time - system_time;
+    stats.io_waits++;
+    stats.io_ticks += pcb->io_wake_time - system_time;
+    waiting_queue.schedule(pcb, pcb->io_wake_time, reason);
+    trace(TraceEvent::IO_BLOCK, pcb, system_time, cpu.id, pcb->io_wake_time, static_cast<uint8_t>(reason));
+    MOSKS_LOG(logger, VERBOSE, "Time " << system_time << ": P" << pcb->process_id << " moved to waiting for " << wakeReasonToString(reason) << ".");
+}
+
+// Execute the running process's program up to its next tick of COMPUTE. Every
+// other instruction takes no time, so any number of them may run here; the
+// process leaves the CPU if one of them puts it to sleep.
+Scheduler::ProgramStatus Scheduler::runProgram(CpuCore& cpu, ProcessControlBlock* pcb, int system_time,
+                                               TimerWheel& waiting_queue) {
+    ProgramCounter& pc = pcb->program;
+    const Instruction* code = pc.code->code.data();
+    const int length = static_cast<int>(pc.code->code.size());
+    long long executed = 0;
+    int wait = 0;
+    WakeReason reason = WakeReason::SLEEP;
+
+    while (pc.pc < length && wait == 0) {
+        const Instruction& instr = code[pc.pc];
+        switch (instr.op) {
+            case OpCode::COMPUTE:
+                if (pc.op_left == 0) {
+                    pc.op_left = instr.arg;
+                    executed++;
+                }
+                stats.instructions += executed;
+                return ProgramStatus::RUNNING;
+            case OpCode::TOUCH:
+                pc.pc++;
+                executed++;
+                if (program_host != nullptr) {
+                    wait = program_host->touch(pcb, instr.arg, static_cast<AccessType>(instr.access));
+                    reason = WakeReason::PAGE_FAULT;
+                }
+                break;
+            case OpCode::LOCK:
+                pc.pc++;
+                executed++;
+                if (program_host != nullptr && !program_host->lock(pcb, instr.arg)) {
+                    recordLag(cpu, pcb);
+                    stats.instructions += executed;
+                    return ProgramStatus::BLOCKED;
+                }
+                break;
+            case OpCode::UNLOCK:
+                pc.pc++;
+                executed++;
+                if (program_host != nullptr) program_host->unlock(pcb, instr.arg);
+                break;
+            case OpCode::READ:
+            case OpCode::SLEEP:
+                pc.pc++;
+                executed++;
+                wait = instr.arg;
+                reason = instr.op == OpCode::READ ? WakeReason::DISK : WakeReason::SLEEP;
+                break;
+            case OpCode::REPEAT:
+                pc.loop_left[pc.depth++] = instr.arg;
+                pc.pc++;
+                executed++;
+                break;
+            case OpCode::END:
+                executed++;
+                if (--pc.loop_left[pc.depth - 1] > 0) {
+                    pc.pc = instr.arg;
+                } else {
+                    pc.depth--;
+                    pc.pc++;
+                }
+                break;
+        }
+    }
+    stats.instructions += executed;
+    if (wait > 0) {
+        sleepFor(cpu, pcb, system_time, wait, reason, waiting_queue);
+        return ProgramStatus::BLOCKED;
+    }
+    pcb->remaining_burst_time = 0;
+    return ProgramStatus::DONE;
+}
+
+// Number of time units that can be simulated in one go without skipping over a
+// state change: burst completion, an I/O request, quantum or slice expiry, an I/O
+// completion in the waiting queue, a load-balancing tick, or the end of a bounded
+// run. Each of those is observed by steps 1-3 of the tick at which it happens, so
+// stopping exactly there reproduces the tick-by-tick schedule.
+int Scheduler::ticksUntilNextEvent(const TimerWheel& waiting_queue, int system_time, int steps_left) const {
+    int span = steps_left;
+
+    int next_wake = waiting_queue.nextExpiry();
+    if (next_wake != -1) {
+        span = std::min(span, next_wake - system_time);
+    }
+    if (cpus.size() > 1) {
+        span = std::min(span, balance_interval - system_time % balance_interval);
+    }
+
+    bool all_idle = true;
+    for (const auto& cpu : cpus) {
+        const ProcessControlBlock* current = cpu.current;
+        if (current == nullptr) continue;
+        all_idle = false;
+        span = std::min(span, current->remaining_burst_time);
+        if (current->program.code != nullptr) {
+            span = std::min(span, current->program.op_left);
+        }
+        if (current->io_burst_frequency > 0) {
+            span = std::min(span, current->io_burst_frequency - current->time_since_last_io);
+        }
+        if (isPreemptive()) {
+            span = std::min(span, cpu.slice - cpu.time_in_quantum);
+        }
     }
+    if (all_idle && waiting_queue.empty()) {
+        // Idle with nothing pending: the run ends on this tick anyway.
+        return 1;
+    }
+
+    return std::max(1, span);
 }
 
 
 
-void Scheduler::displayQueues(const std::vector<ProcessControlBlock*>& ready_queue, 
-                              const std::vector<ProcessControlBlock*>& waiting_queue) const {
+void Scheduler::displayQueues(const ReadyQueue& ready_queue, 
+                              const TimerWheel& waiting_queue) const {
     
-    std::cout << "\n--- Scheduler Queues ---\n";
+    *out << "\n--- Scheduler Queues ---\n";
 
     // --- Print Ready Queue ---
-    std::cout << std::setw(12) << std::left << "Ready Queue:" << "[ ";
+    *out << std::setw(12) << std::left << "Ready Queue:" << "[ ";
     if (ready_queue.empty()) {
-        std::cout << "(empty) ";
+        *out << "(empty) ";
     } else {
-        for (const auto* pcb : ready_queue) {
-            std::cout << "P" << pcb->process_id << " ";
+        for (const auto* pcb : ready_queue.snapshot()) {
+            *out << "P" << pcb->process_id << " ";
+        }
+    }
+    *out << "]\n";
+
+    // --- Print Per-CPU Run Queues ---
+    if (cpus.size() > 1) {
+        for (const auto& cpu : cpus) {
+            std::string label = "CPU" + std::to_string(cpu.id) + ":";
+            *out << std::setw(12) << std::left << label << "[ ";
+            if (cpu.run_queue->empty()) {
+                *out << "(empty) ";
+            } else {
+                for (const auto* pcb : cpu.run_queue->snapshot()) {
+                    *out << "P" << pcb->process_id << " ";
+                }
+            }
+            *out << "]\n";
         }
     }
-    std::cout << "]\n";
 
     // --- Print Waiting Queue ---
-    std::cout << std::setw(12) << std::left << "Waiting Queue:" << "[ ";
+    *out << std::setw(12) << std::left << "Waiting Queue:" << "[ ";
     if (waiting_queue.empty()) {
-        std::cout << "(empty) ";
+        *out << "(empty) ";
     } else {
-        for (const auto* pcb : waiting_queue) {
-            std::cout << "P" << pcb->process_id << " ";
+        for (const WakeEvent& wake : waiting_queue.snapshot()) {
+            *out << "P" << wake.pcb->process_id << "@" << wake.time << " ";
+        }
+    }
+    *out << "]\n";
+}
+void Scheduler::displayCpuStats() const {
+    static const char* bucket_labels[RUNQ_HISTOGRAM_BUCKETS] = {"0", "1", "2", "3", "4-7", "8-15", "16-31", "32+"};
+
+    *out << "\n--- CPU Statistics ---\n";
+    *out << std::left << std::setw(6) << "CPU"
+         << std::setw(10) << "Util"
+         << std::setw(10) << "Busy"
+         << std::setw(10) << "Idle"
+         << std::setw(12) << "Dispatches"
+         << std::setw(9) << "Mig In"
+         << std::setw(9) << "Mig Out" << "\n";
+    for (const auto& cpu : cpus) {
+        long long total = cpu.busy_ticks + cpu.idle_ticks;
+        double util = total > 0 ? 100.0 * cpu.busy_ticks / total : 0.0;
+        std::ostringstream util_str;
+        util_str << std::fixed << std::setprecision(1) << util << "%";
+        *out << std::left << std::setw(6) << cpu.id
+             << std::setw(10) << util_str.str()
+             << std::setw(10) << cpu.busy_ticks
+             << std::setw(10) << cpu.idle_ticks
+             << std::setw(12) << cpu.dispatches
+             << std::setw(9) << cpu.migrations_in
+             << std::setw(9) << cpu.migrations_out << "\n";
+    }
+    if (cpus.size() > 1) {
+        *out << "Migrations: " << getMigrations() << " (load balancing every " << balance_interval << " units)\n";
+    }
+
+    *out << "Run-queue length histogram (% of ticks):\n";
+    *out << std::left << std::setw(6) << "CPU";
+    for (const char* label : bucket_labels) *out << std::setw(7) << label;
+    *out << "\n";
+    for (const auto& cpu : cpus) {
+        long long total = cpu.busy_ticks + cpu.idle_ticks;
+        *out << std::left << std::setw(6) << cpu.id;
+        for (long long ticks : cpu.queue_length_ticks) {
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(1) << (total > 0 ? 100.0 * ticks / total : 0.0);
+            *out << std::setw(7) << cell.str();
         }
+        *out << "\n";
+    }
+}
+
+void Scheduler::displayLatencyStats() const {
+    *out << "\n--- Latency Statistics ---\n";
+    *out << "Context switches: " << stats.dispatches << ", I/O waits: " << stats.io_waits
+         << " (" << stats.io_ticks << " units)\n";
+    if (stats.instructions > 0) {
+        *out << "Program instructions executed: " << stats.instructions << "\n";
     }
-    std::cout << "]\n";
-}
\ No newline at end of file
+    *out << std::left << std::setw(12) << "Metric"
+         << std::setw(8) << "Count"
+         << std::setw(10) << "Mean"
+         << std::setw(8) << "p50"
+         << std::setw(8) << "p95"
+         << std::setw(8) << "p99"
+         << std::setw(8) << "Max" << "\n";
+    const std::pair<const char*, const LatencyHistogram*> rows[] = {
+        {"Response", &stats.response}, {"Waiting", &stats.waiting}, {"Turnaround", &stats.turnaround}};
+    for (const auto& row : rows) {
+        const LatencyHistogram& h = *row.second;
+        std::ostringstream mean;
+        mean << std::fixed << std::setprecision(1) << h.mean();
+        *out << std::left << std::setw(12) << row.first
+             << std::setw(8) << h.count()
+             << std::setw(10) << mean.str()
+             << std::setw(8) << h.percentile(50)
+             << std::setw(8) << h.percentile(95)
+             << std::setw(8) << h.percentile(99)
+             << std::setw(8) << h.max() << "\n";
+    }
+}
+
+void Scheduler::displayFairness(const std::vector<const ProcessControlBlock*>& processes) const {
+    const double vruntime_unit = static_cast<double>(1LL << VRUNTIME_SHIFT);
+
+    *out << "\n--- CFS Fairness ---\n";
+    *out << "Target latency: " << cfs_target_latency << " units, minimum granularity: " << cfs_min_granularity << " units\n";
+    *out << std::left << std::setw(6) << "PID"
+         << std::setw(10) << "Priority"
+         << std::setw(8) << "Weight"
+         << std::setw(10) << "CPU Time"
+         << std::setw(12) << "vruntime"
+         << std::setw(10) << "Max Lag" << "\n";
+
+    double total_lag = 0.0, worst_lag = 0.0;
+    for (const ProcessControlBlock* pcb : processes) {
+        std::ostringstream vruntime_str, lag_str;
+        vruntime_str << std::fixed << std::setprecision(2) << pcb->vruntime / vruntime_unit;
+        lag_str << std::fixed << std::setprecision(2) << pcb->max_lag;
+        *out << std::left << std::setw(6) << pcb->process_id
+             << std::setw(10) << pcb->priority
+             << std::setw(8) << cfsWeight(pcb->priority)
+             << std::setw(10) << pcb->total_burst_time - std::max(0, pcb->remaining_burst_time)
+             << std::setw(12) << vruntime_str.str()
+             << std::setw(10) << lag_str.str() << "\n";
+        total_lag += pcb->max_lag;
+        worst_lag = std::max(worst_lag, pcb->max_lag);
+    }
+    if (!processes.empty()) {
+        std::ostringstream deviation;
+        deviation << std::fixed << std::setprecision(2) << "mean " << total_lag / processes.size()
+                  << ", worst " << worst_lag;
+        *out << "Fairness deviation (max lag per process): " << deviation.str() << " units\n";
+    }
+}
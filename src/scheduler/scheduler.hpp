@@ -4,37 +4,206 @@
 
 #include <string>
 #include <vector>
+#include <deque>
+#include <memory>
+#include <iostream>
 #include "pcb.hpp"
+#include "ready_queue.hpp"
+#include "core/timer_wheel.hpp"
 #include "core/types.hpp" 
+#include "core/logger.hpp"
+#include "core/trace.hpp"
+#include "core/histogram.hpp"
 enum LogLevel;
 
 enum class SchedulingPolicy {
     ROUND_ROBIN,
     PRIORITY,
-    SJF
+    SJF,
+    CFS     // completely fair: weighted virtual runtime, see CfsReadyQueue
 };
 
+std::string schedulingPolicyToString(SchedulingPolicy policy);
+bool parseSchedulingPolicy(const std::string& name, SchedulingPolicy& policy);
+
+// TICK advances system_time one unit per loop iteration. EVENT jumps straight to
+// the next instant where something happens; both produce identical schedules.
+enum class ExecutionMode {
+    TICK,
+    EVENT
+};
+
+// "tick" or "event"
+bool parseExecutionMode(const std::string& name, ExecutionMode& mode);
+
+const int DEFAULT_BALANCE_INTERVAL = 10;
+const int RUNQ_HISTOGRAM_BUCKETS = 8; // lengths 0, 1, 2, 3, 4-7, 8-15, 16-31, 32+
+
+// CFS replaces the fixed quantum with a scheduling period: every runnable process
+// should get a turn within the target latency, in slices of at least the minimum
+// granularity (the period stretches when there are too many processes for that).
+const int DEFAULT_CFS_TARGET_LATENCY = 24;
+const int DEFAULT_CFS_MIN_GRANULARITY = 3;
+
+// One simulated processor. With a single CPU the run queue is the caller's ready
+// queue; with several, each core owns one and the caller's queue only collects
+// new arrivals.
+struct CpuCore {
+    int id = 0;
+    ReadyQueue* run_queue = nullptr;
+    std::unique_ptr<ReadyQueue> owned_queue;
+    ProcessControlBlock* current = nullptr;
+    int time_in_quantum = 0;
+    int slice = 0;          // ticks the current process may run before preemption (RR/CFS)
+
+    // Statistics
+    long long busy_ticks = 0;
+    long long idle_ticks = 0;
+    long long dispatches = 0;
+    long long migrations_in = 0;    // processes moved here from another core's run queue
+    long long migrations_out = 0;   // processes moved from here to another core
+    std::vector<long long> queue_length_ticks; // ticks spent at each run-queue length bucket
+};
+
+// Latency accounting updated as processes change state, so reading it never
+// requires a scan of the process table. Survives CPU count and policy changes.
+struct SchedulerStats {
+    long long dispatches = 0;
+    long long completed = 0;
+    long long io_waits = 0;
+    long long io_ticks = 0;
+    long long instructions = 0;     // program instructions executed
+    long long suspensions = 0;      // processes suspended by load control
+    double worst_lag = 0.0;         // largest CFS service lag of any completed process
+    LatencyHistogram response;      // creation -> first dispatch
+    LatencyHistogram waiting;       // total time spent READY, per completed process
+    LatencyHistogram turnaround;    // creation -> completion
+};
+
+// Kernel services used by process programs (see program.hpp). Without a host,
+// every page is resident and every lock is free.
+class ProgramHost {
+public:
+    virtual ~ProgramHost() = default;
+    // Access a page. Returns how long the process must wait for a page fault, 0 on a hit.
+    virtual int touch(ProcessControlBlock* pcb, int vpn, AccessType type) = 0;
+    // Lock mutex `index` of the process's program. Returns false if the process went to sleep.
+    virtual bool lock(ProcessControlBlock* pcb, int index) = 0;
+    virtual void unlock(ProcessControlBlock* pcb, int index) = 0;
+};
+
+// Medium-term scheduling for memory load control. When the page fault of a
+// process has been serviced, the scheduler asks whether to suspend it instead
+// of making it ready. Suspended processes come back one at a time, oldest
+// first, when the controller allows it or when nothing else is left to run.
+class LoadController {
+public:
+    virtual ~LoadController() = default;
+    virtual bool shouldSuspend(ProcessControlBlock* pcb) = 0;
+    virtual bool shouldResume() = 0;
+};
 
 class Scheduler {
 public:
-    Scheduler(SchedulingPolicy policy,int time_quantum = 4);
+    Scheduler(SchedulingPolicy policy,int time_quantum = 4, std::ostream& out = std::cout);
 
-    void run(std::vector<ProcessControlBlock*>& ready_queue, 
-             std::vector<ProcessControlBlock*>& waiting_queue,
+    // Builds the ready queue structure suited to this scheduler's policy. The
+    // queue passed to run() must come from here: under CFS the scheduler reads
+    // it as a CfsReadyQueue.
+    std::unique_ptr<ReadyQueue> makeReadyQueue() const;
+
+    void run(ReadyQueue& ready_queue, 
+             TimerWheel& waiting_queue,
              int& system_time, 
              int num_steps = -1);
 
+    // Switch between one and several CPUs. Processes queued on per-CPU run queues
+    // are handed back to `ready_queue`; per-CPU statistics restart from zero.
+    void setCpuCount(int count, int balance_interval, ReadyQueue& ready_queue);
+    int getCpuCount() const { return static_cast<int>(cpus.size()); }
+    const std::vector<CpuCore>& getCpus() const { return cpus; }
+    long long getMigrations() const;
+    long long getContextSwitches() const;
+    const SchedulerStats& getStats() const { return stats; }
+    // Processes queued on the shared ready queue and every per-CPU run queue.
+    size_t readyCount(const ReadyQueue& ready_queue) const;
+
+    // Switch scheduling policy. Per-CPU run queues are rebuilt for the new policy and
+    // their processes handed back to `ready_queue`, which the caller must then
+    // replace with makeReadyQueue().
+    void setPolicy(SchedulingPolicy policy, ReadyQueue& ready_queue);
+    SchedulingPolicy getPolicy() const { return policy; }
+    void setCfsTunables(int target_latency, int min_granularity);
+
+    // Remove a READY process from whichever run queue holds it.
+    bool dequeue(ProcessControlBlock* pcb, ReadyQueue& ready_queue);
+
     void setLogLevel(LogLevel level);
+    void setOutput(std::ostream& stream);
+    // Send log messages to `sink` instead of the output stream (nullptr restores it).
+    void setLogSink(LogSink* sink);
+    // Record every state transition made by run() (nullptr stops recording).
+    void setTraceRecorder(TraceRecorder* recorder) { tracer = recorder; }
+    void setProgramHost(ProgramHost* host) { program_host = host; }
+    // nullptr turns load control off; suspended processes then resume.
+    void setLoadController(LoadController* controller) { load_controller = controller; }
+    size_t suspendedCount() const { return suspended.size(); }
+    void setExecutionMode(ExecutionMode mode);
+    ExecutionMode getExecutionMode() const { return execution_mode; }
 
-    void displayQueues(const std::vector<ProcessControlBlock*>& ready_queue,const std::vector<ProcessControlBlock*>& waiting_queue) const;
+    void displayQueues(const ReadyQueue& ready_queue,const TimerWheel& waiting_queue) const;
+    void displayCpuStats() const;
+    // Mean and tail percentiles of response, waiting and turnaround time.
+    void displayLatencyStats() const;
+    // Per-process CFS accounting and the largest service lag each one saw.
+    void displayFairness(const std::vector<const ProcessControlBlock*>& processes) const;
 
 private:
     
     SchedulingPolicy policy;
     int time_quantum;
+    int cfs_target_latency;
+    int cfs_min_granularity;
+    ExecutionMode execution_mode;
+
+    std::vector<CpuCore> cpus;
+    int balance_interval;
+    SchedulerStats stats;
+
+    std::ostream* out;
+    StreamSink out_sink;    // default log destination: the output stream
+    Logger logger;
+
+    TraceRecorder* tracer;
+    int trace_clock;        // latest system_time seen by run(), for transitions made outside it
+    void trace(TraceEvent event, const ProcessControlBlock* pcb, int time, int cpu, int arg = 0, uint8_t reason = 0) {
+        if (tracer != nullptr) tracer->record(event, time, pcb->process_id, cpu, arg, reason);
+    }
+
+    ProgramHost* program_host;
+    LoadController* load_controller;
+    std::deque<ProcessControlBlock*> suspended;     // oldest first
+
+    enum class ProgramStatus { RUNNING, BLOCKED, DONE };
+    ProgramStatus runProgram(CpuCore& cpu, ProcessControlBlock* pcb, int system_time, TimerWheel& waiting_queue);
+    void sleepFor(CpuCore& cpu, ProcessControlBlock* pcb, int system_time, int ticks, WakeReason reason,
+                  TimerWheel& waiting_queue);
+    void terminate(CpuCore& cpu, ProcessControlBlock* pcb, int system_time);
+
+    int ticksUntilNextEvent(const TimerWheel& waiting_queue, int system_time, int steps_left) const;
+
+    void resetCpus(int count);
+    void drainRunQueues(ReadyQueue& ready_queue);
+    static int runQueueBucket(size_t length);
+    CpuCore& leastLoadedCpu();
+    void enqueueOn(CpuCore& cpu, ProcessControlBlock* pcb);
+    void balanceLoad(int system_time);
+    bool stealWork(CpuCore& thief, int system_time);
+    std::string cpuTag(const CpuCore& cpu) const;
 
-    LogLevel current_log_level;
-    void log(LogLevel level, const std::string& message);
+    bool isPreemptive() const;
+    int timeSlice(const CpuCore& cpu, const ProcessControlBlock* pcb) const;
+    void recordLag(const CpuCore& cpu, ProcessControlBlock* pcb) const;
 
 };
 
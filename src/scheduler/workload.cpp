@@ -0,0 +1,59 @@
+#include "workload.hpp"
+
+std::string workloadKindToString(WorkloadKind kind) {
+    switch (kind) {
+        case WorkloadKind::CPU_BOUND: return "cpu";
+        case WorkloadKind::IO_HEAVY: return "io";
+        case WorkloadKind::BIMODAL: return "bimodal";
+    }
+    return "unknown";
+}
+
+bool parseWorkloadKind(const std::string& name, WorkloadKind& kind) {
+    if (name == "cpu") kind = WorkloadKind::CPU_BOUND;
+    else if (name == "io") kind = WorkloadKind::IO_HEAVY;
+    else if (name == "bimodal") kind = WorkloadKind::BIMODAL;
+    else return false;
+    return true;
+}
+
+uint64_t WorkloadRng::next() {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int WorkloadRng::range(int low, int high) {
+    uint64_t span = static_cast<uint64_t>(high - low) + 1;
+    return low + static_cast<int>(next() % span);
+}
+
+std::vector<ProcessControlBlock> generateWorkload(WorkloadKind kind, int count, uint64_t seed) {
+    static const int IO_FREQUENCIES[] = {1, 2, 4, 8};
+
+    WorkloadRng rng(seed);
+    std::vector<ProcessControlBlock> pcbs;
+    pcbs.reserve(count);
+    for (int pid = 1; pid <= count; ++pid) {
+        int priority = rng.range(0, 9);
+        switch (kind) {
+            case WorkloadKind::CPU_BOUND:
+                pcbs.emplace_back(pid, rng.range(5, 100), priority);
+                break;
+            case WorkloadKind::IO_HEAVY: {
+                int burst = rng.range(10, 60);
+                int io_time = rng.range(2, 20);
+                int io_freq = IO_FREQUENCIES[rng.range(0, 3)];
+                pcbs.emplace_back(pid, burst, priority, io_time, io_freq);
+                break;
+            }
+            case WorkloadKind::BIMODAL: {
+                bool batch = rng.range(0, 9) < 2;
+                pcbs.emplace_back(pid, batch ? rng.range(100, 400) : rng.range(1, 10), priority);
+                break;
+            }
+        }
+    }
+    return pcbs;
+}
@@ -0,0 +1,36 @@
+#ifndef WORKLOAD_HPP
+#define WORKLOAD_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "pcb.hpp"
+
+// Shapes of synthetic process populations for benchmarks and tests.
+enum class WorkloadKind {
+    CPU_BOUND,  // 5-100 tick bursts, no I/O
+    IO_HEAVY,   // 10-60 tick bursts, 2-20 tick I/O every 1, 2, 4 or 8 ticks
+    BIMODAL     // 80% interactive 1-10 tick bursts, 20% batch 100-400 tick bursts
+};
+
+std::string workloadKindToString(WorkloadKind kind);
+bool parseWorkloadKind(const std::string& name, WorkloadKind& kind);
+
+// splitmix64. The standard distributions are implementation defined, so the
+// generators use this instead to produce the same workload on every toolchain.
+class WorkloadRng {
+public:
+    explicit WorkloadRng(uint64_t seed) : state(seed) {}
+    uint64_t next();
+    // Uniform in [low, high].
+    int range(int low, int high);
+
+private:
+    uint64_t state;
+};
+
+// `count` processes with pids 1..count and priorities 0-9. The same kind, count
+// and seed always give the same processes.
+std::vector<ProcessControlBlock> generateWorkload(WorkloadKind kind, int count, uint64_t seed);
+
+#endif
@@ -1,4 +1,9 @@
 #include "cli/system.hpp"
+#include "cli/batch.hpp"
+#include "cli/sweep.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -14,7 +19,7 @@ void ASSERT_TRUE(bool condition, const std::string& message) {
 }
 
 // Helper to get the master process table (add to System class for testing)
-const std::map<int, ProcessControlBlock>& getProcessTable(const System& sys);
+const PcbStore& getProcessTable(const System& sys);
 
 int main() {
     std::cout << "===== Running Full System Integration Test =====\n";
@@ -33,9 +38,227 @@ int main() {
 
     std::cout << "\n--- Verifying Final State ---\n";
     const auto& process_table = getProcessTable(mosks);
-    
-    // ... assertions are the same ...
-    
+    bool all_terminated = process_table.size() == 3;
+    process_table.forEach([&](const ProcessControlBlock& pcb) {
+        all_terminated = all_terminated && pcb.state == ProcessState::TERMINATED;
+    });
+    ASSERT_TRUE(all_terminated, "All three processes should have terminated.");
+
+    mosks.runCLICommand("reap");
+    mosks.runCLICommand("create 4 1 0 0");
+    mosks.runCLICommand("access 4 100 READ");
+    ASSERT_TRUE(process_table.size() == 1 && process_table.find(1) == nullptr && process_table.find(4) != nullptr,
+                "Reaping should release terminated processes and keep new ones reachable.");
+    SystemReport report = mosks.getReport();
+    ASSERT_TRUE(report.processes == 4 && report.finished == 3, "Reaped processes should still count in the report.");
+
+    std::cout << "\n--- Verifying Batch Mode ---\n";
+    const std::vector<std::string> workload = {
+        "# comment lines and blank lines are skipped", "",
+        "create 12 2 0 0", "create 6 1 7 3", "  create 8 3 0 0  ", "policy SJF",
+        "access 1 100 READ", "access 2 200 WRITE", "lock 1", "lock 2", "run 5", "unlock 1", "run"};
+    const std::string text_path = "/tmp/mosks_batch_test.txt", binary_path = "/tmp/mosks_batch_test.bin";
+    {
+        std::ofstream file(text_path);
+        for (const std::string& line : workload) file << line << "\n";
+    }
+    std::ostringstream discarded;
+    SystemConfig config;
+    config.out = &discarded;
+    System shell(config);
+    for (const std::string& line : workload) shell.runCLICommand(line);
+    SystemReport expected = shell.getReport();
+
+    BatchSummary text, binary;
+    ASSERT_TRUE(runBatch(text_path, SystemConfig(), text) && text.commands == 11 && !text.binary,
+                "A text batch file should run every command.");
+    ASSERT_TRUE(compileBatchFile(text_path, binary_path) && runBatch(binary_path, SystemConfig(), binary) &&
+                binary.binary && binary.commands == 11, "A compiled batch file should run every command.");
+    ASSERT_TRUE(text.report.system_time == expected.system_time && text.report.page_faults == expected.page_faults &&
+                text.report.avg_turnaround == expected.avg_turnaround &&
+                binary.report.avg_turnaround == expected.avg_turnaround &&
+                binary.report.context_switches == expected.context_switches,
+                "Batch mode should reproduce the interactive results.");
+    std::remove(text_path.c_str());
+    std::remove(binary_path.c_str());
+
+    std::cout << "\n--- Verifying Synchronization ---\n";
+    std::ostringstream console;
+    SystemConfig sync_config;
+    sync_config.policy = SchedulingPolicy::PRIORITY;
+    sync_config.out = &console;
+    System sync(sync_config);
+    const PcbStore& procs = getProcessTable(sync);
+    for (const char* line : {"create 10 9", "create 10 5", "create 10 1", "mutex m pi", "lock 1 m", "lock 3 m"}) {
+        sync.runCLICommand(line);
+    }
+    ASSERT_TRUE(procs.find(1)->priority == 1 && procs.find(1)->base_priority == 9,
+                "A priority-inheriting mutex owner should run at its best waiter's priority.");
+    sync.runCLICommand("run 3");
+    ASSERT_TRUE(procs.find(1)->remaining_burst_time == 7 && procs.find(2)->remaining_burst_time == 10,
+                "The boosted owner should run ahead of medium-priority processes.");
+    sync.runCLICommand("unlock 1 m");
+    ASSERT_TRUE(procs.find(1)->priority == 9 && procs.find(3)->state == ProcessState::READY,
+                "Unlocking should drop the boost and hand the mutex to the waiter.");
+    sync.runCLICommand("lock 1 m");
+    sync.runCLICommand("lock 2 m");
+    sync.runCLICommand("unlock 3 m");
+    ASSERT_TRUE(procs.find(1)->state == ProcessState::READY && procs.find(2)->state == ProcessState::BLOCKED_ON_MUTEX,
+                "Waiters should acquire the mutex in FIFO order.");
+    sync.runCLICommand("unlock 1 m");
+    sync.runCLICommand("unlock 2 m");
+
+    // P4 holds a and waits for b, held by P5; P6 waiting for a boosts both.
+    for (const char* line : {"create 10 8", "create 10 7", "create 10 2", "mutex a pi", "mutex b pi",
+                             "lock 4 a", "lock 5 b", "lock 4 b", "lock 6 a"}) {
+        sync.runCLICommand(line);
+    }
+    ASSERT_TRUE(procs.find(4)->priority == 2 && procs.find(5)->priority == 2,
+                "Priority inheritance should follow a chain of blocked owners.");
+    sync.runCLICommand("unlock 5 b");
+    ASSERT_TRUE(procs.find(5)->priority == 7 && procs.find(4)->priority == 2 && procs.find(4)->state == ProcessState::READY,
+                "The boost should stay with the owner the high-priority waiter is still behind.");
+    sync.runCLICommand("unlock 4 a");
+    sync.runCLICommand("unlock 4 b");
+    sync.runCLICommand("unlock 6 a");
+
+    for (const char* line : {"sem slots 1", "wait 1 slots", "wait 2 slots", "lock 3 c", "cvwait 3 ready c"}) {
+        sync.runCLICommand(line);
+    }
+    ASSERT_TRUE(procs.find(2)->state == ProcessState::BLOCKED_ON_MUTEX && procs.find(3)->state == ProcessState::BLOCKED_ON_MUTEX,
+                "Semaphore and condition variable waiters should be blocked.");
+    sync.runCLICommand("lock 1 c");
+    sync.runCLICommand("cvsignal ready");
+    ASSERT_TRUE(procs.find(3)->state == ProcessState::BLOCKED_ON_MUTEX,
+                "A signalled waiter should queue on the mutex while it is held.");
+    sync.runCLICommand("unlock 1 c");
+    sync.runCLICommand("signal slots");
+    ASSERT_TRUE(procs.find(2)->state == ProcessState::READY && procs.find(3)->state == ProcessState::READY,
+                "Signalling should wake the waiters.");
+    console.str("");
+    sync.runCLICommand("locks");
+    ASSERT_TRUE(console.str().find("m           mutex*      4      3        1        3        0        3") != std::string::npos,
+                "Lock statistics should count acquisitions and contended acquisitions.");
+    sync.runCLICommand("run");
+    ASSERT_TRUE(sync.getReport().finished == 6, "Every process should finish once the locks are released.");
+
+    std::cout << "\n--- Verifying Process Programs ---\n";
+    System programs(config);
+    for (const char* line : {"program db touch 40 WRITE; lock table; compute 3; touch 41; unlock table; read 2; compute 1",
+                             "spawn db 0 3", "run"}) {
+        programs.runCLICommand(line);
+    }
+    SystemReport run = programs.getReport();
+    ASSERT_TRUE(run.finished == 3 && run.page_faults == 6 && run.instructions == 3 * 7,
+                "Programs should fault pages in and run every instruction.");
+    discarded.str("");
+    programs.runCLICommand("locks");
+    ASSERT_TRUE(discarded.str().find("table       mutex       3      2") != std::string::npos,
+                "Programs holding a mutex across a compute should contend for it.");
+
+    std::cout << "\n--- Verifying TLB ---\n";
+    SystemConfig tlb_config = config;
+    tlb_config.memory_size = 8;     // two frames of 4
+    System tlb(tlb_config);
+    for (const char* line : {"create 10 1", "access 1 5 READ", "access 1 5 READ", "access 1 5 WRITE",
+                             "access 1 6 READ", "access 1 7 READ", "access 1 5 READ"}) {
+        tlb.runCLICommand(line);
+    }
+    SystemReport tlb_report = tlb.getReport();
+    ASSERT_TRUE(tlb_report.tlb_hits == 2 && tlb_report.tlb_misses == 4 && tlb_report.page_faults == 4,
+                "Repeated accesses should hit the TLB, and evicted pages should miss again.");
+    tlb.runCLICommand("tlb off");
+    tlb.runCLICommand("access 1 5 READ");
+    ASSERT_TRUE(tlb.getReport().tlb_hits == 0 && tlb.getReport().tlb_misses == 0 && tlb.getReport().page_faults == 4,
+                "With the TLB off every access should walk the page table.");
+
+    std::cout << "\n--- Verifying Swap ---\n";
+    System swapping(tlb_config);
+    for (const char* line : {"swap 4", "faultcost 2 1 10 5", "create 10 1", "access 1 5 WRITE",
+                             "access 1 6 READ", "access 1 7 READ", "access 1 5 READ"}) {
+        swapping.runCLICommand(line);
+    }
+    const VirtualMemoryManager& swap_mmu = swapping.getMMU();
+    ASSERT_TRUE(swap_mmu.getWritebacks() == 1 && swap_mmu.getCleanEvictions() == 1 && swap_mmu.getSwapIns() == 1 &&
+                swap_mmu.getSwap().slotsInUse() == 1 && swap_mmu.getFaultTicks() == 4 * 2 + 10 + 1 + 5,
+                "A dirty page should be written to swap on eviction and read back on the next fault.");
+
+    std::cout << "\n--- Verifying Copy-on-Write Fork ---\n";
+    System forking(config);
+    for (const char* line : {"create 10 1", "access 1 1 WRITE", "access 1 2 READ", "fork 1", "fork 1",
+                             "access 2 2 READ", "access 3 1 WRITE"}) {
+        forking.runCLICommand(line);
+    }
+    const VirtualMemoryManager& fork_mmu = forking.getMMU();
+    const ProcessControlBlock* worker = getProcessTable(forking).find(2);
+    ASSERT_TRUE(fork_mmu.getPageFaults() == 3 && fork_mmu.getCowCopies() == 1 && worker != nullptr &&
+                worker->page_directory.resident_pages == 2 &&
+                fork_mmu.getFrameTable()[worker->page_directory.find(2)->frameNumber].mappers == 3,
+                "Forked workers should share their parent's frames until they write.");
+
+    std::cout << "\n--- Verifying Shared Memory ---\n";
+    System sharing(config);
+    for (const char* line : {"create 10 1", "create 10 1", "shm create ring 2", "shm attach 1 ring 50",
+                             "shm attach 2 ring 200 r", "access 1 50 WRITE", "access 2 200 READ", "access 2 201 WRITE",
+                             "shm"}) {
+        sharing.runCLICommand(line);
+    }
+    const VirtualMemoryManager& shm_mmu = sharing.getMMU();
+    int occupied = 0;
+    for (const FrameDescriptor& frame : shm_mmu.getFrameTable()) occupied += frame.owner != nullptr;
+    ASSERT_TRUE(shm_mmu.getPageFaults() == 2 && shm_mmu.getMinorFaults() == 1 && occupied == 1 &&
+                shm_mmu.findSegment("ring")->attachments == 2,
+                "Processes sharing a segment should use one frame for it.");
+
+    std::cout << "\n--- Verifying Parameter Sweeps ---\n";
+    SweepGrid grid;
+    grid.policies = {SchedulingPolicy::ROUND_ROBIN, SchedulingPolicy::CFS};
+    grid.frame_counts = {4, 32};
+    std::vector<SystemConfig> configs = expandGrid(grid);
+    ASSERT_TRUE(configs.size() == 4 && configs[0].policy == SchedulingPolicy::ROUND_ROBIN &&
+                configs[0].memory_size == 4 * grid.page_size && configs[3].policy == SchedulingPolicy::CFS &&
+                configs[3].memory_size == 32 * grid.page_size,
+                "A grid should expand to every combination of its axes, in order.");
+    const std::vector<std::string> sweep_workload = {
+        "program scan repeat 3; touch 0; touch 1; touch 2; touch 3; touch 4; touch 5; compute 2; end",
+        "spawn scan 0 4", "create 12 2 4 2", "create 6 1", "run"};
+    std::vector<SweepResult> serial = runSweep(sweep_workload, configs, 1);
+    std::vector<SweepResult> parallel = runSweep(sweep_workload, configs, 4);
+    bool identical = serial.size() == configs.size() && parallel.size() == configs.size();
+    for (size_t i = 0; identical && i < serial.size(); ++i) {
+        const SystemReport& a = serial[i].report;
+        const SystemReport& b = parallel[i].report;
+        identical = a.finished == 6 && a.finished == b.finished && a.page_faults == b.page_faults &&
+                    a.avg_turnaround == b.avg_turnaround && a.avg_waiting == b.avg_waiting &&
+                    a.context_switches == b.context_switches && a.instructions == b.instructions &&
+                    a.system_time == b.system_time && serial[i].config.policy == parallel[i].config.policy &&
+                    serial[i].config.memory_size == parallel[i].config.memory_size;
+    }
+    ASSERT_TRUE(identical, "A sweep should give the same results on one thread and on four.");
+    ASSERT_TRUE(serial[0].report.page_faults > serial[1].report.page_faults,
+                "Each configuration should run with its own memory size.");
+
+    std::cout << "\n--- Verifying Load Control ---\n";
+    // Four processes cycling over six pages each in sixteen frames thrash
+    // under global LRU; suspending some lets the others keep their pages.
+    SystemReport thrashing[2];
+    for (int controlled = 0; controlled < 2; ++controlled) {
+        SystemConfig thrash_config = config;
+        thrash_config.memory_size = 64;
+        thrash_config.load_control.enabled = controlled == 1;
+        thrash_config.load_control.suspend_rate = 0.3;
+        thrash_config.load_control.resume_rate = 0.05;
+        System thrash(thrash_config);
+        for (const char* line : {"program cycle repeat 20; touch 0; touch 1; touch 2; touch 3; touch 4; touch 5; compute 1; end",
+                                 "spawn cycle 0 4", "rss window 100 20", "run"}) {
+            thrash.runCLICommand(line);
+        }
+        thrashing[controlled] = thrash.getReport();
+    }
+    ASSERT_TRUE(thrashing[1].finished == 4 && thrashing[1].page_faults * 2 < thrashing[0].page_faults &&
+                thrashing[1].avg_turnaround < thrashing[0].avg_turnaround,
+                "Suspending thrashing processes should cut page faults and still finish every process.");
+
     std::cout << "\n===== Integration Test Passed! =====\n";
     return 0;
 }
\ No newline at end of file
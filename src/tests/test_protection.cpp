@@ -1,4 +1,9 @@
 #include "memory/virtual_memory/virtual_memory.hpp"
+#include "memory/virtual_memory/memory_trace.hpp"
+#include "memory/virtual_memory/stack_distance.hpp"
+#include "core/mapped_file.hpp"
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -20,7 +25,7 @@ void testProcessLifecycle(VirtualMemoryManager& vmm, std::map<int, ProcessContro
     std::cout << "\n--- Testing Process Lifecycle ---\n";
     
     // Create PCB and pass it to the VMM
-    process_list.emplace(1, 1);
+    process_list.emplace(1, ProcessControlBlock(1, 1, 0));
     ProcessControlBlock& pcb1 = process_list.at(1);
     vmm.allocateProcess(pcb1);
 
@@ -43,8 +48,8 @@ void testPcbIntegrationAndReplacement(VirtualMemoryManager& vmm, std::map<int, P
     std::cout << "\n--- Testing PCB Integration in Page Replacement ---\n";
     
     // Create and allocate processes
-    process_list.emplace(10, 10);
-    process_list.emplace(20, 20);
+    process_list.emplace(10, ProcessControlBlock(10, 10, 0));
+    process_list.emplace(20, ProcessControlBlock(20, 20, 0));
     ProcessControlBlock& pcb10 = process_list.at(10);
     ProcessControlBlock& pcb20 = process_list.at(20);
     vmm.allocateProcess(pcb10);
@@ -59,12 +64,593 @@ void testPcbIntegrationAndReplacement(VirtualMemoryManager& vmm, std::map<int, P
     // Trigger replacement (FIFO will evict P10, VP1)
     vmm.accessPage(pcb10, 5, AccessType::READ);
 
-    int victim_pdi = 1 / PAGE_TABLE_SIZE;
-    int victim_pti = 1 % PAGE_TABLE_SIZE;
-    bool is_victim_invalid = !pcb10.page_directory.at(victim_pdi).pageTable->at(victim_pti).valid;
+    bool is_victim_invalid = !pcb10.page_directory.find(1)->valid;
     ASSERT_TRUE(is_victim_invalid, "Victim page (P10, 1) should be marked invalid after eviction.");
 }
 
+void testRadixPageTables() {
+    std::cout << "\n--- Testing Radix Page Tables ---\n";
+    VirtualMemoryManager vmm(8, 4, ReplacementPolicy::FIFO);
+    ProcessControlBlock pcb(1, 10, 0);
+    vmm.allocateProcess(pcb);
+
+    // VPs 5, 1030 and 2053 live in different regions; with two frames 2053 evicts 5.
+    vmm.accessPage(pcb, 5, AccessType::READ);
+    vmm.accessPage(pcb, 1030, AccessType::READ);
+    ASSERT_TRUE(vmm.getPageTableCount() == 2 && pcb.page_directory.table(0) != nullptr,
+                "Each touched 1024-page region should get its own page table.");
+    vmm.accessPage(pcb, 2053, AccessType::READ);
+    ASSERT_TRUE(pcb.page_directory.table(0) == nullptr && vmm.getPageTableCount() == 2,
+                "A page table with no resident pages should go back to the pool.");
+
+    vmm.setPagePermissions(pcb, 1030, true, false, false);
+    vmm.accessPage(pcb, 1030, AccessType::WRITE);
+    ASSERT_TRUE(vmm.getPageFaults() == 3 && pcb.page_directory.find(1030)->valid && !pcb.page_directory.find(1030)->can_write,
+                "Permissions should be kept in the packed entry.");
+    vmm.accessPage(pcb, MAX_VIRTUAL_PAGES, AccessType::READ);
+    ASSERT_TRUE(vmm.getPageFaults() == 3, "Pages outside the address space should be rejected.");
+
+    vmm.freeProcess(pcb);
+    ASSERT_TRUE(pcb.page_directory.empty() && pcb.page_directory.entries == nullptr && vmm.getPageTableCount() == 0,
+                "Freeing a process should return all its page tables.");
+    vmm.allocateProcess(pcb);
+    vmm.accessPage(pcb, 7, AccessType::READ);
+    ASSERT_TRUE(vmm.getPageTableCount() == 1 && vmm.getFrameTable()[pcb.page_directory.find(7)->frameNumber].vpn == 7,
+                "Freed frames and page tables should be reused.");
+    vmm.freeProcess(pcb);
+}
+
+void testReplacementPolicies() {
+    std::cout << "\n--- Testing LRU and CLOCK Replacement ---\n";
+    VirtualMemoryManager lru(12, 4, ReplacementPolicy::LRU);
+    ProcessControlBlock a(1, 10, 0);
+    lru.allocateProcess(a);
+    lru.accessPage(a, 1, AccessType::READ);
+    lru.accessPage(a, 2, AccessType::READ);
+    lru.accessPage(a, 3, AccessType::READ);
+    lru.accessPage(a, 1, AccessType::READ);     // 2 is now the least recently used
+    lru.accessPage(a, 4, AccessType::READ);
+    ASSERT_TRUE(!a.page_directory.find(2)->valid && a.page_directory.find(1)->valid,
+                "LRU should evict the least recently used page.");
+    lru.setPagePermissions(a, 3, false, false, false);
+    lru.accessPage(a, 3, AccessType::READ);     // denied: does not count as a use
+    lru.accessPage(a, 5, AccessType::READ);
+    ASSERT_TRUE(!a.page_directory.find(3)->valid && lru.getPageFaults() == 5,
+                "A denied access should not refresh a page's LRU position.");
+    lru.freeProcess(a);
+    lru.allocateProcess(a);
+    lru.accessPage(a, 6, AccessType::READ);
+    ASSERT_TRUE(lru.getFrameTable()[0].vpn == 6, "Freed frames should leave the LRU list.");
+    lru.freeProcess(a);
+
+    VirtualMemoryManager clock(12, 4, ReplacementPolicy::CLOCK);
+    ProcessControlBlock b(2, 10, 0);
+    clock.allocateProcess(b);
+    clock.accessPage(b, 1, AccessType::READ);
+    clock.accessPage(b, 2, AccessType::READ);
+    clock.accessPage(b, 3, AccessType::READ);
+    clock.accessPage(b, 4, AccessType::READ);   // every page referenced: a full sweep, then frame 0
+    ASSERT_TRUE(!b.page_directory.find(1)->valid && clock.getFrameTable()[0].vpn == 4,
+                "CLOCK should clear referenced bits and evict at the hand when all pages were used.");
+    clock.accessPage(b, 2, AccessType::READ);   // second chance for page 2 in frame 1
+    clock.accessPage(b, 5, AccessType::READ);
+    ASSERT_TRUE(b.page_directory.find(2)->valid && !b.page_directory.find(3)->valid && clock.getFrameTable()[2].vpn == 5,
+                "CLOCK should skip a page referenced since the last sweep.");
+    clock.freeProcess(b);
+}
+// Faults of `policy` with `frames` frames on a single-process reference string.
+static int faultsOn(ReplacementPolicy policy, int frames, const std::vector<int>& pages,
+                    ProcessControlBlock& pcb) {
+    VirtualMemoryManager vmm(frames * 4, 4, policy, std::cout);
+    vmm.setLogLevel(NORMAL);
+    vmm.allocateProcess(pcb);
+    std::vector<MemoryAccess> future;
+    for (int vpn : pages) {
+        MemoryAccess a;
+        a.pid = pcb.process_id;
+        a.vpn = vpn;
+        future.push_back(a);
+    }
+    vmm.setFutureAccesses(future);
+    for (int vpn : pages) vmm.accessPage(pcb, vpn, AccessType::READ);
+    return vmm.getPageFaults();
+}
+
+void testOptimalAndAdaptivePolicies() {
+    std::cout << "\n--- Testing OPT, ARC and 2Q Replacement ---\n";
+    ProcessControlBlock a(1, 10, 0);
+    const std::vector<int> belady = {1, 2, 3, 4, 1, 2, 5, 1, 2, 3, 4, 5};
+    ASSERT_TRUE(faultsOn(ReplacementPolicy::OPT, 3, belady, a) == 7 &&
+                faultsOn(ReplacementPolicy::FIFO, 3, belady, a) == 9 &&
+                faultsOn(ReplacementPolicy::LRU, 3, belady, a) == 10,
+                "OPT should evict the page used furthest in the future.");
+
+    // A hot set used repeatedly, then a long one-off scan: recency alone flushes
+    // it. ARC keeps it from the back-to-back reuse, 2Q once it returns from A1out.
+    std::vector<int> scan = {1, 2, 3, 1, 2, 3, 10, 11, 12, 13, 14, 15, 1, 2, 3};
+    for (int vpn = 100; vpn < 140; ++vpn) scan.push_back(vpn);
+    scan.insert(scan.end(), {1, 2, 3});
+    int lru = faultsOn(ReplacementPolicy::LRU, 8, scan, a);
+    int arc = faultsOn(ReplacementPolicy::ARC, 8, scan, a);
+    int two_q = faultsOn(ReplacementPolicy::TWO_Q, 8, scan, a);
+    int opt = faultsOn(ReplacementPolicy::OPT, 8, scan, a);
+    ASSERT_TRUE(arc < lru && two_q < lru, "ARC and 2Q should keep a hot set through a sequential scan.");
+    ASSERT_TRUE(opt <= arc && opt <= two_q, "No policy should fault less than OPT.");
+
+    VirtualMemoryManager two_queue(32, 4, ReplacementPolicy::TWO_Q);
+    ProcessControlBlock b(2, 10, 0);
+    two_queue.allocateProcess(b);
+    for (int vpn : {1, 2, 3, 4, 5, 6, 7, 8, 9}) two_queue.accessPage(b, vpn, AccessType::READ);
+    ASSERT_TRUE(!b.page_directory.find(1)->valid, "2Q should evict the oldest page of A1in first.");
+    two_queue.accessPage(b, 1, AccessType::READ);
+    ASSERT_TRUE(two_queue.getFrameTable()[b.page_directory.find(1)->frameNumber].list == 1,
+                "A page remembered in A1out should come back into Am.");
+    two_queue.freeProcess(b);
+}
+
+void testDirtyPagesAndSwap() {
+    std::cout << "\n--- Testing Dirty Pages and Swap ---\n";
+    const std::string swap_path = "/tmp/mosks_swap_test.bin";
+    VirtualMemoryManager vmm(12, 4, ReplacementPolicy::LRU);
+    std::string error;
+    ASSERT_TRUE(!vmm.configureSwap(MAX_FRAME_NUMBER + 2, "", &error) && !error.empty() && vmm.getSwap().slotCount() == 0,
+                "Swap slots beyond what a page table entry can hold should be refused.");
+    ASSERT_TRUE(vmm.configureSwap(8, swap_path) && vmm.getSwap().slotCount() == 8,
+                "A swap file should be preallocated and mapped.");
+    ProcessControlBlock a(1, 10, 0);
+    vmm.allocateProcess(a);
+    vmm.accessPage(a, 1, AccessType::WRITE);
+    vmm.accessPage(a, 2, AccessType::READ);
+    vmm.accessPage(a, 3, AccessType::READ);
+    vmm.accessPage(a, 3, AccessType::WRITE);
+    ASSERT_TRUE(a.page_directory.find(1)->dirty && !a.page_directory.find(2)->dirty && a.page_directory.find(3)->dirty,
+                "Writes should set the dirty bit, whether they fault or hit.");
+
+    vmm.accessPage(a, 4, AccessType::READ);     // evicts dirty page 1
+    vmm.accessPage(a, 5, AccessType::READ);     // evicts clean page 2
+    const PageTableEntry* one = a.page_directory.find(1);
+    ASSERT_TRUE(one->swapped && !one->valid && !a.page_directory.find(2)->swapped &&
+                vmm.getWritebacks() == 1 && vmm.getCleanEvictions() == 1 && vmm.getSwap().slotsInUse() == 1,
+                "Only dirty victims should be written to swap; clean ones are dropped.");
+    {
+        std::ifstream file(swap_path, std::ios::binary);
+        int32_t record[2] = {0, 0};
+        file.read(reinterpret_cast<char*>(record), sizeof(record));
+        ASSERT_TRUE(file && record[0] == 1 && record[1] == 1, "The write-back should land in the swap file.");
+    }
+
+    vmm.accessPage(a, 1, AccessType::READ);     // swap-in, evicts dirty page 3
+    ASSERT_TRUE(vmm.getSwapIns() == 1 && one->valid && !one->swapped && vmm.getSwap().slotsInUse() == 2,
+                "A fault on a swapped page should read it back from its slot.");
+    vmm.accessPage(a, 6, AccessType::READ);     // evicts 4
+    vmm.accessPage(a, 7, AccessType::READ);     // evicts 5
+    vmm.accessPage(a, 8, AccessType::READ);     // evicts clean page 1, still in swap
+    ASSERT_TRUE(one->swapped && vmm.getWritebacks() == 2 && vmm.getSwap().slotsInUse() == 2,
+                "A clean page with a copy in swap should be dropped without another write.");
+    const FaultLatency cost;
+    ASSERT_TRUE(vmm.getFaultTicks() == 9 * cost.fault + 2 * cost.writeback + 4 * cost.clean_eviction + cost.swap_in,
+                "Fault service time should add up clean evictions, write-backs and swap-ins.");
+
+    ASSERT_TRUE(!vmm.configureSwap(0, ""), "Swap cannot be turned off while it holds pages.");
+    vmm.freeProcess(a);
+    ASSERT_TRUE(vmm.getSwap().slotsInUse() == 0 && vmm.getPageTableCount() == 0 && vmm.configureSwap(0, "") &&
+                !vmm.getSwap().enabled(),
+                "Freeing a process should release its swap slots.");
+    std::remove(swap_path.c_str());
+}
+
+void testReadahead() {
+    std::cout << "\n--- Testing Sequential Readahead ---\n";
+    VirtualMemoryManager vmm(64, 4, ReplacementPolicy::LRU, std::cout);
+    vmm.setLogLevel(NORMAL);
+    ReadaheadConfig config;
+    config.max_window = 8;
+    config.initial_window = 2;
+    vmm.configureReadahead(config);
+    ProcessControlBlock a(1, 10, 0);
+    vmm.allocateProcess(a);
+    for (int vpn = 1000; vpn < 1040; ++vpn) vmm.accessPage(a, vpn, AccessType::READ);   // crosses into PDI 1
+    ASSERT_TRUE(vmm.getPageFaults() == 3 && vmm.getPrefetchUseful() == 37 && vmm.getPrefetchWasted() == 0,
+                "A sequential stream should fault only until readahead stays ahead of it.");
+
+    ProcessControlBlock b(2, 10, 0);
+    vmm.allocateProcess(b);
+    for (int vpn : {5, 300, 42, 7, 9000}) vmm.accessPage(b, vpn, AccessType::READ);
+    long long before = vmm.getPrefetched();
+    ASSERT_TRUE(vmm.getPageFaults() == 8 && b.page_directory.readahead.window == 0,
+                "Random faults should not trigger readahead.");
+    for (int vpn : {100, 103, 106}) vmm.accessPage(b, vpn, AccessType::READ);
+    ASSERT_TRUE(vmm.getPrefetched() == before + 2 && b.page_directory.find(109)->valid &&
+                b.page_directory.find(112)->valid && !b.page_directory.find(110)->valid,
+                "A constant stride should be detected and followed.");
+    long long wasted = vmm.getPrefetchWasted();
+    vmm.freeProcess(b);
+    ASSERT_TRUE(vmm.getPrefetchWasted() == wasted + 2, "Prefetched pages freed before use should count as wasted.");
+    vmm.freeProcess(a);
+}
+
+void testCopyOnWriteFork() {
+    std::cout << "\n--- Testing Copy-on-Write Fork ---\n";
+    VirtualMemoryManager vmm(32, 4, ReplacementPolicy::LRU);
+    ProcessControlBlock a(1, 10, 0), b(2, 10, 0);
+    vmm.allocateProcess(a);
+    vmm.accessPage(a, 1, AccessType::WRITE);
+    vmm.accessPage(a, 2, AccessType::READ);
+    vmm.accessPage(a, 1500, AccessType::READ);
+    vmm.setPagePermissions(a, 1500, true, false, false);
+    vmm.forkProcess(a, b);
+    const FrameDescriptor& shared = vmm.getFrameTable()[a.page_directory.find(1)->frameNumber];
+    ASSERT_TRUE(b.page_directory.resident_pages == 3 && shared.mappers == 2 && shared.owner == &a &&
+                b.page_directory.find(1)->frameNumber == a.page_directory.find(1)->frameNumber &&
+                a.page_directory.find(1)->cow && !a.page_directory.find(1)->can_write &&
+                !b.page_directory.find(1500)->cow && vmm.getPageFaults() == 3,
+                "A fork should share every resident frame and write-protect the writable pages.");
+
+    vmm.accessPage(b, 2, AccessType::READ);
+    vmm.accessPage(b, 1, AccessType::WRITE);
+    ASSERT_TRUE(vmm.getCowCopies() == 1 && vmm.getPageFaults() == 4 && shared.mappers == 1 &&
+                b.page_directory.find(1)->frameNumber != a.page_directory.find(1)->frameNumber &&
+                b.page_directory.find(1)->can_write && b.page_directory.find(1)->dirty,
+                "Writing a shared page should give the writer a private copy.");
+    vmm.accessPage(a, 1, AccessType::WRITE);
+    vmm.accessPage(b, 1500, AccessType::WRITE);
+    ASSERT_TRUE(vmm.getCowCopies() == 1 && a.page_directory.find(1)->can_write && !a.page_directory.find(1)->cow &&
+                !b.page_directory.find(1500)->can_write,
+                "The last sharer should write in place, and read-only pages should stay read-only.");
+
+    vmm.freeProcess(b);
+    ASSERT_TRUE(a.page_directory.find(2)->valid && vmm.getFrameTable()[a.page_directory.find(2)->frameNumber].mappers == 1 &&
+                a.page_directory.resident_pages == 3,
+                "Freeing a child should only drop its references to shared frames.");
+
+    // A shared dirty page is evicted from both address spaces and swapped once.
+    ASSERT_TRUE(vmm.configureSwap(8, ""), "Anonymous swap should be available.");
+    ProcessControlBlock c(3, 10, 0), d(4, 10, 0);
+    vmm.forkProcess(a, c);
+    vmm.allocateProcess(d);
+    for (int vpn = 0; vpn < 8; ++vpn) vmm.accessPage(d, vpn, AccessType::READ);
+    ASSERT_TRUE(a.page_directory.find(1)->swapped && c.page_directory.find(1)->swapped &&
+                a.page_directory.find(1)->frameNumber == c.page_directory.find(1)->frameNumber &&
+                vmm.getSwap().slotsInUse() == 1 && vmm.getWritebacks() == 1 && c.page_directory.resident_pages == 0,
+                "Evicting a shared frame should unmap it from every process and write it once.");
+    vmm.accessPage(c, 1, AccessType::READ);
+    vmm.freeProcess(a);
+    ASSERT_TRUE(c.page_directory.find(1)->valid && vmm.getSwapIns() == 1 && vmm.getSwap().slotsInUse() == 1,
+                "A swapped page should stay in swap while any process still refers to it.");
+    vmm.freeProcess(c);
+    vmm.freeProcess(d);
+    ASSERT_TRUE(vmm.getSwap().slotsInUse() == 0 && vmm.getPageTableCount() == 0,
+                "Freeing every sharer should release the swap slot and the page tables.");
+}
+
+void testSharedMemorySegments() {
+    std::cout << "\n--- Testing Shared Memory Segments ---\n";
+    VirtualMemoryManager vmm(32, 4, ReplacementPolicy::LRU);
+    ProcessControlBlock a(1, 10, 0), b(2, 10, 0), c(3, 10, 0);
+    vmm.allocateProcess(a);
+    vmm.allocateProcess(b);
+    vmm.allocateProcess(c);
+    ASSERT_TRUE(vmm.createSegment("buf", 4) && !vmm.createSegment("buf", 2) &&
+                vmm.attachSegment(a, "buf", 100, true, true, false) &&
+                vmm.attachSegment(b, "buf", 1500, true, false, false) &&
+                !vmm.attachSegment(b, "buf", 1502, true, true, false) && !vmm.attachSegment(c, "nope", 0, true, true, false),
+                "Segments should have unique names and attach only over unused pages.");
+
+    vmm.accessPage(a, 100, AccessType::WRITE);
+    vmm.accessPage(a, 101, AccessType::WRITE);
+    vmm.accessPage(b, 1500, AccessType::READ);
+    vmm.accessPage(b, 1501, AccessType::WRITE);
+    const SharedSegment* buf = vmm.findSegment("buf");
+    ASSERT_TRUE(vmm.getPageFaults() == 3 && vmm.getMinorFaults() == 1 &&
+                b.page_directory.find(1500)->frameNumber == a.page_directory.find(100)->frameNumber &&
+                vmm.getFrameTable()[buf->frames[0]].mappers == 2 && !b.page_directory.find(1501)->valid,
+                "A segment page should be mapped from the same frame, and a refused write should load nothing.");
+
+    vmm.setPagePermissions(b, 1500, true, true, false);
+    vmm.accessPage(b, 1500, AccessType::WRITE);
+    vmm.accessPage(a, 102, AccessType::READ);
+    ASSERT_TRUE(b.page_directory.find(1500)->can_write && !b.page_directory.find(1501)->can_write &&
+                a.page_directory.find(102)->can_read && !a.page_directory.find(102)->can_execute &&
+                vmm.getCowCopies() == 0 && vmm.getPageFaults() == 4,
+                "Each mapper should keep its own permissions, and faults should not reset them.");
+
+    // Evicted segment pages go to the segment's own slots, written once.
+    ASSERT_TRUE(vmm.configureSwap(8, ""), "Anonymous swap should be available.");
+    for (int vpn = 0; vpn < 8; ++vpn) vmm.accessPage(c, vpn, AccessType::READ);
+    ASSERT_TRUE(buf->frames[0] == -1 && buf->slots[0] != -1 && buf->slots[2] == -1 && vmm.getWritebacks() == 2 &&
+                !a.page_directory.find(100)->swapped && !b.page_directory.find(1500)->valid &&
+                b.page_directory.find(1500)->can_write && vmm.getSwap().slotsInUse() == 2,
+                "Evicting a segment page should unmap it everywhere and keep it with the segment.");
+    vmm.accessPage(b, 1500, AccessType::READ);
+    vmm.accessPage(a, 100, AccessType::READ);
+    ASSERT_TRUE(vmm.getSwapIns() == 1 && vmm.getMinorFaults() == 2 &&
+                a.page_directory.find(100)->frameNumber == b.page_directory.find(1500)->frameNumber,
+                "A swapped segment page should be read back once for every mapper.");
+
+    // Private pages keep explicit permissions through faults too.
+    vmm.setPagePermissions(c, 20, true, false, false);
+    vmm.accessPage(c, 20, AccessType::READ);
+    ASSERT_TRUE(c.page_directory.find(20)->valid && !c.page_directory.find(20)->can_write,
+                "A page given permissions before its first fault should keep them.");
+
+    // A forked child attaches the segment too; its pages are not copy-on-write.
+    ProcessControlBlock d(4, 10, 0);
+    vmm.forkProcess(a, d);
+    vmm.accessPage(d, 100, AccessType::WRITE);
+    ASSERT_TRUE(vmm.getCowCopies() == 0 && buf->attachments == 3 &&
+                d.page_directory.find(100)->frameNumber == a.page_directory.find(100)->frameNumber,
+                "A fork should share segment pages instead of copying them.");
+
+    ASSERT_TRUE(vmm.detachSegment(a, "buf") && !vmm.detachSegment(a, "buf") && !vmm.removeSegment("buf") &&
+                a.page_directory.find(100) == nullptr && buf->frames[0] != -1,
+                "Detaching should unmap only the detaching process.");
+    long long writebacks = vmm.getWritebacks();
+    vmm.freeProcess(d);
+    vmm.freeProcess(b);
+    ASSERT_TRUE(buf->attachments == 0 && buf->frames[0] == -1 && vmm.getWritebacks() == writebacks + 1 &&
+                vmm.getSwap().slotsInUse() == 2,
+                "The last process to unmap a dirty segment page should write it to the segment.");
+    ASSERT_TRUE(vmm.removeSegment("buf") && vmm.findSegment("buf") == nullptr && vmm.getSwap().slotsInUse() == 0,
+                "Removing a segment should release its swap slots.");
+    vmm.freeProcess(a);
+    vmm.freeProcess(c);
+    ASSERT_TRUE(vmm.getPageTableCount() == 0, "Freeing every process should return all page tables.");
+}
+
+void testResidentSets() {
+    std::cout << "\n--- Testing Resident Set Limits ---\n";
+    VirtualMemoryManager vmm(8, 1, ReplacementPolicy::LRU);
+    ProcessControlBlock a(1, 10, 0), b(2, 10, 0);
+    vmm.allocateProcess(a);
+    vmm.allocateProcess(b);
+    vmm.setResidentLimit(a, 3);
+    for (int vpn = 0; vpn < 6; ++vpn) vmm.accessPage(a, vpn, AccessType::READ);
+    ASSERT_TRUE(a.page_directory.resident_pages == 3 && a.page_directory.find(5)->valid &&
+                !a.page_directory.find(0)->valid && vmm.getPageFaults() == 6,
+                "A process at its limit should replace its own least recently used page.");
+
+    for (int vpn = 0; vpn < 5; ++vpn) vmm.accessPage(b, vpn, AccessType::READ);
+    ASSERT_TRUE(b.page_directory.resident_pages == 5 && a.page_directory.resident_pages == 3,
+                "Other processes should use the frames left free.");
+
+    // With local replacement, a full memory makes each process replace its own pages.
+    ResidentSetConfig config;
+    config.local_replacement = true;
+    config.working_set_window = 4;
+    config.fault_window = 4;
+    vmm.configureResidentSets(config);
+    vmm.setResidentLimit(a, 0);
+    vmm.accessPage(b, 5, AccessType::READ);
+    ASSERT_TRUE(b.page_directory.resident_pages == 5 && a.page_directory.resident_pages == 3 &&
+                !b.page_directory.find(0)->valid,
+                "Local replacement should not take frames from other processes.");
+
+    // The working set counts pages used in the last four accesses.
+    vmm.accessPage(b, 5, AccessType::READ);
+    vmm.accessPage(b, 4, AccessType::READ);
+    vmm.accessPage(b, 5, AccessType::READ);
+    ASSERT_TRUE(vmm.workingSetSize(b) == 2 && vmm.workingSetSize(a) == 0,
+                "The working set should hold only recently used pages.");
+    vmm.accessPage(b, 5, AccessType::READ);
+    ASSERT_TRUE(b.page_directory.fault_rate.windows == 2 && b.page_directory.fault_rate.rate == 0.25 &&
+                vmm.getFaultRate().windows >= 1,
+                "Fault rates should be measured per window of accesses.");
+
+    ASSERT_TRUE(vmm.trimResidentSet(b, 2) == 3 && b.page_directory.resident_pages == 2 &&
+                b.page_directory.find(5)->valid && b.page_directory.find(4)->valid,
+                "Trimming should keep the most recently used pages.");
+    vmm.setResidentLimit(a, 1);
+    ASSERT_TRUE(a.page_directory.resident_pages == 1 && a.page_directory.resident_limit == 1,
+                "Lowering a limit below the resident set should trim it.");
+    vmm.freeProcess(a);
+    vmm.freeProcess(b);
+}
+
+void testFrameDescriptors() {
+    std::cout << "\n--- Testing Frame Descriptors and Reverse Map ---\n";
+    VirtualMemoryManager vmm(16, 4, ReplacementPolicy::FIFO);
+    ProcessControlBlock a(1, 10, 0), b(2, 10, 0);
+    vmm.allocateProcess(a);
+    vmm.allocateProcess(b);
+    vmm.accessPage(a, 1, AccessType::READ);
+    vmm.accessPage(b, 1, AccessType::READ);
+    vmm.accessPage(a, 2000, AccessType::READ);
+    vmm.accessPage(b, 2, AccessType::READ);
+    const FrameDescriptor& frame2 = vmm.getFrameTable()[2];
+    ASSERT_TRUE(frame2.owner == &a && frame2.vpn == 2000 && frame2.pte == a.page_directory.find(2000) &&
+                a.page_directory.resident_pages == 2 && b.page_directory.resident_pages == 2,
+                "Frame descriptors should record the owner, page and PTE of each frame.");
+
+    vmm.freeProcess(a);
+    ASSERT_TRUE(vmm.getFrameTable()[0].owner == nullptr && vmm.getFrameTable()[2].owner == nullptr &&
+                vmm.getFrameTable()[1].owner == &b && b.page_directory.find(2)->valid,
+                "Freeing a process should release only the frames it owns.");
+    vmm.accessPage(b, 3, AccessType::READ);
+    vmm.accessPage(b, 4, AccessType::READ);
+    ASSERT_TRUE(b.page_directory.find(1)->valid && b.page_directory.resident_pages == 4,
+                "Released frames should be reused before anything is evicted.");
+    vmm.accessPage(b, 5, AccessType::READ);
+    ASSERT_TRUE(!b.page_directory.find(1)->valid && b.page_directory.find(2)->valid,
+                "FIFO order should survive another process being freed.");
+    vmm.freeProcess(b);
+}
+
+void testTraceReplayAndMissRatioCurve() {
+    std::cout << "\n--- Testing Memory Traces and Miss-Ratio Curves ---\n";
+    const std::string lackey = "==42== Lackey, an example Valgrind tool\n"
+                               "I  04000ffe,4\n"           // straddles pages 0x4000 and 0x4001
+                               " L 04001000,8\n"
+                               " S 1ffefff000,8\n"
+                               "--42-- not an access\n"
+                               " M 04000010,4\n";
+    MemoryTraceReader reader(lackey.data(), lackey.size());
+    std::vector<MemoryAccess> accesses;
+    MemoryAccess access;
+    while (reader.next(access)) accesses.push_back(access);
+    ASSERT_TRUE(!reader.isBinary() && reader.error().empty() && accesses.size() == 5 && reader.pages() == 3 &&
+                accesses[0].vpn == 0 && accesses[1].vpn == 1 && accesses[2].vpn == 1 &&
+                accesses[3].vpn == 2 && accesses[3].type == AccessType::WRITE &&
+                accesses[4].vpn == 0 && accesses[4].type == AccessType::WRITE,
+                "Lackey traces should be split into pages and renumbered densely.");
+
+    const std::string text_path = "/tmp/mosks_memtrace_test.txt", binary_path = "/tmp/mosks_memtrace_test.bin";
+    {
+        std::ofstream file(text_path);
+        file << lackey;
+    }
+    MappedFile binary;
+    ASSERT_TRUE(compileMemoryTrace(text_path, binary_path) && binary.open(binary_path),
+                "A text trace should compile to the binary form.");
+    MemoryTraceReader binary_reader(binary.data(), binary.size());
+    size_t matching = 0;
+    while (binary_reader.next(access) && matching < accesses.size() && access.vpn == accesses[matching].vpn &&
+           access.type == accesses[matching].type && access.pid == 1) {
+        matching++;
+    }
+    ASSERT_TRUE(binary_reader.isBinary() && matching == accesses.size() && binary.size() == 8 + 5 * 8,
+                "The binary trace should replay the same accesses.");
+    std::remove(text_path.c_str());
+    std::remove(binary_path.c_str());
+
+    // A looping, skewed stream over 3 processes: the curve must predict the
+    // simulated LRU fault count at every memory size.
+    StackDistanceAnalyzer analyzer;
+    std::vector<MemoryAccess> stream;
+    unsigned state = 12345;
+    for (int i = 0; i < 150000; ++i) {   // enough to renumber time twice
+        state = state * 1103515245u + 12345u;
+        MemoryAccess a;
+        a.pid = 1 + static_cast<int>((state >> 8) % 3);
+        a.vpn = (i % 7 == 0) ? static_cast<int>((state >> 12) % 300) : static_cast<int>((state >> 12) % 40);
+        stream.push_back(a);
+        analyzer.access(a.pid, a.vpn);
+    }
+    MissRatioCurve curve = analyzer.curve();
+    bool exact = curve.accesses() == 150000;
+    for (int frames : {1, 8, 30, 64, 200, 1000}) {
+        VirtualMemoryManager vmm(frames, 1, ReplacementPolicy::LRU, std::cout);
+        vmm.setLogLevel(NORMAL);
+        ProcessControlBlock p1(1, 1, 0), p2(2, 1, 0), p3(3, 1, 0);
+        ProcessControlBlock* pcbs[] = {&p1, &p2, &p3};
+        for (const MemoryAccess& a : stream) vmm.accessPage(*pcbs[a.pid - 1], a.vpn, AccessType::READ);
+        exact = exact && curve.misses(frames) == vmm.getPageFaults();
+    }
+    ASSERT_TRUE(exact && curve.misses(curve.maxUsefulFrames()) == static_cast<long long>(analyzer.pages()),
+                "The stack distance curve should match simulated LRU at every memory size.");
+}
+
+static bool cached(Tlb& tlb, int pid, int vpn) {
+    return tlb.lookup(pid, vpn) != nullptr;
+}
+
+void testTlb() {
+    std::cout << "\n--- Testing the TLB ---\n";
+    PageTableEntry ptes[16];
+
+    // Four sets of one way: with a power-of-two set count only the low bits of
+    // the page number pick the set, so VP 0 and VP 4 fight over one entry.
+    Tlb direct(4, 1, TlbReplacement::LRU);
+    direct.insert(1, 0, &ptes[0]);
+    direct.insert(1, 1, &ptes[1]);
+    direct.insert(1, 4, &ptes[4]);
+    ASSERT_TRUE(!cached(direct, 1, 0) && cached(direct, 1, 1) && direct.lookup(1, 4) == &ptes[4],
+                "A direct-mapped TLB should evict on a set conflict and keep other sets.");
+    Tlb twoWay(8, 2, TlbReplacement::LRU);
+    twoWay.insert(1, 0, &ptes[0]);
+    twoWay.insert(1, 4, &ptes[4]);
+    ASSERT_TRUE(cached(twoWay, 1, 0) && cached(twoWay, 1, 4), "Two ways should hold two conflicting pages.");
+    twoWay.insert(1, 8, &ptes[8]);
+    ASSERT_TRUE(!cached(twoWay, 1, 0) && cached(twoWay, 1, 4) && cached(twoWay, 1, 8),
+                "A full set should evict its least recently used way under LRU.");
+
+    // One fully associative set: VP 0 is the oldest fill but the latest use.
+    Tlb lru(2, 2, TlbReplacement::LRU), fifo(2, 2, TlbReplacement::FIFO);
+    for (Tlb* tlb : {&lru, &fifo}) {
+        tlb->insert(1, 0, &ptes[0]);
+        tlb->insert(1, 1, &ptes[1]);
+        tlb->lookup(1, 0);
+        tlb->insert(1, 2, &ptes[2]);
+    }
+    ASSERT_TRUE(cached(lru, 1, 0) && !cached(lru, 1, 1) && !cached(fifo, 1, 0) && cached(fifo, 1, 1),
+                "FIFO should evict the oldest fill, ignoring later hits.");
+
+    Tlb random(4, 4, TlbReplacement::RANDOM), again(4, 4, TlbReplacement::RANDOM);
+    for (int vpn = 0; vpn < 4; ++vpn) {
+        random.insert(1, vpn, &ptes[vpn]);
+        again.insert(1, vpn, &ptes[vpn]);
+    }
+    bool reproducible = true, always_oldest = true;
+    for (int vpn = 4; vpn < 16; ++vpn) {
+        random.insert(1, vpn, &ptes[vpn]);
+        again.insert(1, vpn, &ptes[vpn]);
+        int resident = 0;
+        for (int old = 0; old <= vpn; ++old) {
+            bool hit = cached(random, 1, old);
+            reproducible = reproducible && hit == cached(again, 1, old);
+            resident += hit;
+        }
+        reproducible = reproducible && resident == 4;
+        always_oldest = always_oldest && !cached(random, 1, vpn - 4);
+    }
+    ASSERT_TRUE(reproducible && !always_oldest,
+                "RANDOM should replace some way of a full set, the same one on every run.");
+
+    Tlb tagged(8, 2, TlbReplacement::LRU);
+    tagged.insert(1, 3, &ptes[3]);
+    tagged.insert(2, 3, &ptes[4]);
+    tagged.invalidate(1, 3);
+    ASSERT_TRUE(!cached(tagged, 1, 3) && tagged.lookup(2, 3) == &ptes[4],
+                "Entries should be tagged by process; invalidating one leaves the other.");
+    tagged.insert(1, 5, &ptes[5]);
+    tagged.flush(2);
+    ASSERT_TRUE(!cached(tagged, 2, 3) && cached(tagged, 1, 5), "A flush should drop only that process.");
+
+    // Split I/D: an instruction fetch fills the instruction TLB only.
+    VirtualMemoryManager vmm(64, 4, ReplacementPolicy::LRU);
+    TlbConfig config;
+    config.entries = 8;
+    config.ways = 2;
+    config.split = true;
+    vmm.configureTlb(config);
+    ProcessControlBlock a(1, 10, 0);
+    vmm.allocateProcess(a);
+    vmm.setPagePermissions(a, 1, true, false, true);
+    vmm.accessPage(a, 1, AccessType::EXECUTE);
+    vmm.accessPage(a, 1, AccessType::EXECUTE);
+    vmm.accessPage(a, 1, AccessType::READ);
+    ASSERT_TRUE(vmm.getTlbHits() == 1 && vmm.getTlbMisses() == 2,
+                "A data access should miss on a page only the instruction TLB holds.");
+    vmm.freeProcess(a);
+    config.split = false;
+    vmm.configureTlb(config);
+    ProcessControlBlock b(2, 10, 0);
+    vmm.allocateProcess(b);
+    vmm.setPagePermissions(b, 1, true, false, true);
+    vmm.accessPage(b, 1, AccessType::EXECUTE);
+    vmm.accessPage(b, 1, AccessType::EXECUTE);
+    vmm.accessPage(b, 1, AccessType::READ);
+    ASSERT_TRUE(vmm.getTlbHits() == 2 && vmm.getTlbMisses() == 1,
+                "A unified TLB should serve fetches and data from one entry.");
+    vmm.freeProcess(b);
+
+    // Two frames: a stale entry for an evicted page would turn its next fault into a hit.
+    VirtualMemoryManager small(8, 4, ReplacementPolicy::FIFO);
+    ProcessControlBlock c(3, 10, 0);
+    small.allocateProcess(c);
+    for (int vpn : {1, 2, 1, 3}) small.accessPage(c, vpn, AccessType::READ);   // 3 evicts 1
+    small.accessPage(c, 1, AccessType::READ);
+    ASSERT_TRUE(small.getPageFaults() == 4 && small.getTlbHits() == 1 && small.getTlbMisses() == 4,
+                "Evicting a page should invalidate its TLB entry.");
+
+    // The page tables go with the process; a new process reusing the id must walk its own.
+    small.freeProcess(c);
+    ProcessControlBlock reused(3, 10, 0);
+    small.allocateProcess(reused);
+    small.accessPage(reused, 1, AccessType::READ);
+    ASSERT_TRUE(small.getPageFaults() == 5 && small.getTlbMisses() == 5 && reused.page_directory.find(1)->valid,
+                "Freeing a process should flush its TLB entries.");
+    small.freeProcess(reused);
+}
 
 // --- Test Runner Main Function ---
 
@@ -78,6 +664,17 @@ int main() {
     // Run tests
     testProcessLifecycle(vmm_fifo, process_list_fifo);
     testPcbIntegrationAndReplacement(vmm_fifo, process_list_fifo);
+    testRadixPageTables();
+    testReplacementPolicies();
+    testOptimalAndAdaptivePolicies();
+    testDirtyPagesAndSwap();
+    testReadahead();
+    testCopyOnWriteFork();
+    testSharedMemorySegments();
+    testResidentSets();
+    testFrameDescriptors();
+    testTraceReplayAndMissRatioCurve();
+    testTlb();
 
     std::cout << "\n===== All VMU tests passed! =====\n";
     return 0;
@@ -1,32 +1,512 @@
 #include "scheduler/scheduler.hpp"
+#include "scheduler/workload.hpp"
+#include "scheduler/pcb_store.hpp"
 #include <iostream>
+#include <string>
 #include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <set>
+
+// Helper for our test
+void ASSERT_TRUE(bool condition, const std::string& message) {
+    if (condition) {
+        std::cout << "[ \033[32mPASS\033[0m ] " << message << std::endl;
+    } else {
+        std::cout << "[ \033[31mFAIL\033[0m ] " << message << std::endl;
+        exit(1);
+    }
+}
 
 // This single test function can run a scenario with any policy
 void runSchedulerTest(SchedulingPolicy policy) {
     // --- Setup ---
     Scheduler scheduler(policy, 4); // Time quantum of 4 for RR
+    std::unique_ptr<ReadyQueue> ready_queue = scheduler.makeReadyQueue();
+    TimerWheel waiting_queue;
+    int system_time = 0;
 
     // --- Processes ---
     // A high-priority, short, I/O-bound process
-    ProcessControlBlock p1(1, 6, 1, 5, 2); 
+    ProcessControlBlock p1(1, 6, 1, 5, 2);
     // A medium-priority, long, CPU-bound process
     ProcessControlBlock p2(2, 12, 2, 0, 0);
     // A low-priority, medium-length process
     ProcessControlBlock p3(3, 8, 3, 0, 0);
 
-    scheduler.addProcess(&p1);
-    scheduler.addProcess(&p2);
-    scheduler.addProcess(&p3);
+    ready_queue->push(&p1);
+    ready_queue->push(&p2);
+    ready_queue->push(&p3);
 
     // --- Run Simulation ---
-    scheduler.run();
+    scheduler.run(*ready_queue, waiting_queue, system_time);
+
+    ASSERT_TRUE(p1.state == ProcessState::TERMINATED && p2.state == ProcessState::TERMINATED &&
+                p3.state == ProcessState::TERMINATED, "All processes should terminate.");
+    ASSERT_TRUE(ready_queue->empty() && waiting_queue.empty(), "Queues should be empty after the run.");
+}
+
+// Runs the same workload in TICK and EVENT mode and compares completion times.
+void testEventModeMatchesTickMode(SchedulingPolicy policy, int cpu_count = 1) {
+    std::vector<int> completion[2];
+    int end_time[2];
+    for (int m = 0; m < 2; ++m) {
+        Scheduler scheduler(policy, 3);
+        scheduler.setExecutionMode(m == 0 ? ExecutionMode::TICK : ExecutionMode::EVENT);
+        std::unique_ptr<ReadyQueue> ready_queue = scheduler.makeReadyQueue();
+        scheduler.setCpuCount(cpu_count, 7, *ready_queue);
+        TimerWheel waiting_queue;
+        std::vector<ProcessControlBlock> pcbs;
+        for (int i = 0; i < 12; ++i) {
+            pcbs.emplace_back(i + 1, 5 + (i * 37) % 90, i % 4, (i % 3) * 7, (i % 2) ? 4 + i : 0);
+        }
+        for (auto& pcb : pcbs) ready_queue->push(&pcb);
+
+        int system_time = 0;
+        scheduler.run(*ready_queue, waiting_queue, system_time, 50); // pause mid-way once
+        scheduler.run(*ready_queue, waiting_queue, system_time);
+        for (const auto& pcb : pcbs) completion[m].push_back(pcb.completion_time);
+        end_time[m] = system_time;
+    }
+    ASSERT_TRUE(completion[0] == completion[1] && end_time[0] == end_time[1],
+                "Event mode should reproduce tick mode completion times.");
+}
+
+void testSmpScheduling() {
+    std::cout << "\n--- Testing SMP Scheduling ---\n";
+    int makespan[2];
+    long long migrations = 0, migrations_out = 0;
+    for (int i = 0; i < 2; ++i) {
+        Scheduler scheduler(SchedulingPolicy::ROUND_ROBIN, 4);
+        std::unique_ptr<ReadyQueue> ready_queue = scheduler.makeReadyQueue();
+        scheduler.setCpuCount(i == 0 ? 1 : 4, 5, *ready_queue);
+        TimerWheel waiting_queue;
+        std::vector<ProcessControlBlock> pcbs;
+        // Uneven bursts so that some cores drain early and have to steal.
+        for (int p = 0; p < 10; ++p) pcbs.emplace_back(p + 1, (p % 3 == 0) ? 60 : 8, 0);
+        for (auto& pcb : pcbs) ready_queue->push(&pcb);
+
+        int system_time = 0;
+        scheduler.run(*ready_queue, waiting_queue, system_time);
+        makespan[i] = system_time;
+        migrations = scheduler.getMigrations();
+        migrations_out = 0;
+        for (const CpuCore& cpu : scheduler.getCpus()) migrations_out += cpu.migrations_out;
+    }
+    ASSERT_TRUE(makespan[1] * 2 < makespan[0], "Four CPUs should finish a CPU-bound batch well ahead of one.");
+    ASSERT_TRUE(migrations > 0, "Idle cores should steal work from busier run queues.");
+    ASSERT_TRUE(migrations_out == migrations, "Every migration should count out of one core and into another.");
+}
+
+void testTimerWheel() {
+    std::cout << "\n--- Testing Hierarchical Timer Wheel ---\n";
+    TimerWheel wheel;
+    std::vector<ProcessControlBlock> pcbs;
+    // Wake times spread across every level and the overflow list, with duplicates.
+    std::vector<int> wake_times = {3, 3, 64, 65, 4095, 4096, 70000, 70000, 262145, 16777300, 40000000, 7};
+    for (size_t i = 0; i < wake_times.size(); ++i) pcbs.emplace_back(static_cast<int>(i), 1, 0);
+    for (size_t i = 0; i < wake_times.size(); ++i) wheel.schedule(&pcbs[i], wake_times[i]);
+    int cancelled = wheel.schedule(&pcbs[0], 500);
+    ASSERT_TRUE(wheel.cancel(cancelled) && !wheel.cancel(cancelled), "A pending wake-up should be cancellable once.");
+
+    std::vector<WakeEvent> fired;
+    bool exact = true;
+    int now = 0;
+    while (!wheel.empty()) {
+        int next = wheel.nextExpiry();
+        size_t before = fired.size();
+        wheel.advance(next - 1, fired);
+        exact = exact && fired.size() == before;
+        wheel.advance(next, fired);
+        exact = exact && fired.size() > before && fired.back().time == next;
+        now = next;
+    }
+    std::vector<int> sorted = wake_times;
+    std::sort(sorted.begin(), sorted.end());
+    bool in_order = fired.size() == sorted.size();
+    for (size_t i = 0; in_order && i < sorted.size(); ++i) in_order = fired[i].time == sorted[i];
+    ASSERT_TRUE(exact && in_order && now == 40000000, "Timers should fire exactly at their wake time, in order.");
+    ASSERT_TRUE(fired[0].pcb == &pcbs[0] && fired[1].pcb == &pcbs[1], "Timers with equal wake times should fire in scheduling order.");
+}
+
+void testHeapReadyQueueOrdering() {
+    std::cout << "\n--- Testing Heap Ready Queue Ordering ---\n";
+    Scheduler scheduler(SchedulingPolicy::PRIORITY);
+    std::unique_ptr<ReadyQueue> rq = scheduler.makeReadyQueue();
+
+    ProcessControlBlock a(1, 5, 3), b(2, 5, 1), c(3, 5, 2), d(4, 5, 1), e(5, 5, 2);
+    rq->push(&a); rq->push(&b); rq->push(&c); rq->push(&d); rq->push(&e);
+
+    ASSERT_TRUE(rq->remove(&c), "A queued PCB should be removable by handle.");
+    ASSERT_TRUE(!rq->contains(&c) && !rq->remove(&c), "A removed PCB should no longer be queued.");
+
+    rq->pushFront(&c);
+    std::vector<int> order;
+    while (!rq->empty()) order.push_back(rq->pop()->process_id);
+    ASSERT_TRUE(order == std::vector<int>({2, 4, 3, 5, 1}), "Heap should pop by priority, FIFO among equals, pushFront first.");
+}
+
+void testFifoReadyQueueRemoval() {
+    std::cout << "\n--- Testing Ring Buffer Ready Queue ---\n";
+    FifoReadyQueue rq;
+    std::vector<ProcessControlBlock> pcbs;
+    for (int i = 0; i < 100; ++i) pcbs.emplace_back(i, 1, 0);
+
+    // Enough pushes to force the ring to grow, with removals punching holes in it.
+    for (auto& pcb : pcbs) rq.push(&pcb);
+    for (int i = 0; i < 100; i += 3) rq.remove(&pcbs[i]);
+    rq.pushFront(&pcbs[0]);
+
+    bool in_order = rq.pop() == &pcbs[0];
+    int last = 0;
+    while (!rq.empty()) {
+        ProcessControlBlock* pcb = rq.pop();
+        in_order = in_order && pcb->process_id > last && pcb->process_id % 3 != 0;
+        last = pcb->process_id;
+    }
+    ASSERT_TRUE(in_order, "Ring buffer should keep FIFO order across growth and removals.");
+}
+
+void testCfsFairness() {
+    std::cout << "\n--- Testing CFS Weighted Fairness ---\n";
+    Scheduler scheduler(SchedulingPolicy::CFS);
+    std::unique_ptr<ReadyQueue> ready_queue = scheduler.makeReadyQueue();
+    TimerWheel waiting_queue;
+
+    // Two CPU-bound processes at nice 0 and nice 5 (weights 1024 and 335).
+    ProcessControlBlock heavy(1, 10000, 0), light(2, 10000, 5);
+    ready_queue->push(&heavy);
+    ready_queue->push(&light);
+
+    int system_time = 0;
+    scheduler.run(*ready_queue, waiting_queue, system_time, 1200);
+    int heavy_cpu = heavy.total_burst_time - heavy.remaining_burst_time;
+    int light_cpu = light.total_burst_time - light.remaining_burst_time;
+    double ratio = static_cast<double>(heavy_cpu) / light_cpu;
+    ASSERT_TRUE(ratio > 2.8 && ratio < 3.4, "CPU time should be split in proportion to weight (~3.06:1).");
+    ASSERT_TRUE(heavy.max_lag <= DEFAULT_CFS_TARGET_LATENCY && light.max_lag <= DEFAULT_CFS_TARGET_LATENCY,
+                "No process should fall more than one scheduling period behind its fair share.");
+
+    // A process arriving late starts at the queue's min_vruntime instead of 0.
+    ProcessControlBlock late(3, 50, 0);
+    ready_queue->push(&late);
+    ASSERT_TRUE(late.vruntime > 0, "A newcomer should not be credited for time before it existed.");
+}
+
+static int formatted_arguments = 0;
+static int countFormatting() { return ++formatted_arguments; }
+
+void testLogSinks() {
+    std::cout << "\n--- Testing Log Sinks ---\n";
+    Logger logger(nullSink(), DEBUG);
+    MOSKS_LOG(logger, NORMAL, "never built " << countFormatting());
+    logger.setSink(stdoutSink());
+    logger.setLevel(NORMAL);
+    MOSKS_LOG(logger, VERBOSE, "never built " << countFormatting());
+    ASSERT_TRUE(formatted_arguments == 0, "Disabled messages should not evaluate their arguments.");
+
+    RingSink ring(4);
+    Scheduler scheduler(SchedulingPolicy::ROUND_ROBIN, 2);
+    scheduler.setLogSink(&ring);
+    scheduler.setLogLevel(VERBOSE);
+    std::unique_ptr<ReadyQueue> ready_queue = scheduler.makeReadyQueue();
+    TimerWheel waiting_queue;
+    ProcessControlBlock p1(1, 5, 0), p2(2, 3, 0);
+    ready_queue->push(&p1);
+    ready_queue->push(&p2);
+    int system_time = 0;
+    scheduler.run(*ready_queue, waiting_queue, system_time);
+
+    std::vector<std::string> lines = ring.lines();
+    ASSERT_TRUE(lines.size() == 4 && ring.dropped() > 0, "A full ring should keep only its most recent messages.");
+    ASSERT_TRUE(lines.back() == "--- Scheduler finished. All processes complete. ---" &&
+                lines[2] == "Time 8: P1 finished.", "Ring messages should be kept oldest first.");
+}
+
+// Records a run in two halves and checks that replaying the trace rebuilds the
+// scheduler's queues at the pause point and the final outcome.
+void testTraceReplay() {
+    std::cout << "\n--- Testing Trace Recording and Replay ---\n";
+    const std::string paths[2] = {"/tmp/mosks_trace_test_1.bin", "/tmp/mosks_trace_test_2.bin"};
+    Scheduler scheduler(SchedulingPolicy::ROUND_ROBIN, 3);
+    std::unique_ptr<ReadyQueue> ready_queue = scheduler.makeReadyQueue();
+    TimerWheel waiting_queue;
+    std::vector<ProcessControlBlock> pcbs;
+    for (int i = 0; i < 6; ++i) {
+        pcbs.emplace_back(i + 1, 6 + (i * 5) % 11, 0, (i % 2) ? 4 : 0, (i % 2) ? 2 : 0);
+    }
+
+    // A tiny ring without a writer thread forces the producer to drain it inline.
+    TraceRecorder first(paths[0], 8, false);
+    scheduler.setTraceRecorder(&first);
+    int system_time = 0;
+    for (auto& pcb : pcbs) {
+        ready_queue->push(&pcb);
+        first.record(TraceEvent::ADMIT, system_time, pcb.process_id, -1, pcb.remaining_burst_time);
+    }
+    scheduler.run(*ready_queue, waiting_queue, system_time, 11);
+    first.close();
+
+    TraceReplay replay;
+    ASSERT_TRUE(replay.load(paths[0]), "A closed trace file should load.");
+    ASSERT_TRUE(replay.records().size() == first.recorded(), "Every recorded event should reach the file.");
+    TraceSnapshot snap = replay.snapshotAt(system_time);
+    std::vector<int> expected_ready, expected_waiting;
+    for (const ProcessControlBlock* pcb : ready_queue->snapshot()) expected_ready.push_back(pcb->process_id);
+    for (const WakeEvent& wake : waiting_queue.snapshot()) expected_waiting.push_back(wake.pcb->process_id);
+    std::vector<int> replayed_waiting;
+    for (const auto& entry : snap.waiting) replayed_waiting.push_back(entry.first);
+    ASSERT_TRUE(snap.ready[-1] == expected_ready && snap.running.empty(),
+                "Replay should rebuild the ready queue in order at the pause point.");
+    ASSERT_TRUE(replayed_waiting == expected_waiting, "Replay should rebuild the waiting queue at the pause point.");
+
+    TraceRecorder second(paths[1]);
+    scheduler.setTraceRecorder(&second);
+    scheduler.run(*ready_queue, waiting_queue, system_time);
+    scheduler.setTraceRecorder(nullptr);
+    second.close();
+
+    TraceReplay rest;
+    ASSERT_TRUE(rest.load(paths[1]), "The trace of the second half should load.");
+    std::vector<TraceRecord> all = replay.records();
+    all.insert(all.end(), rest.records().begin(), rest.records().end());
+    replay.setRecords(all);
+    long long dispatches = 0;
+    for (const TraceRecord& rec : replay.records()) {
+        if (rec.event == static_cast<uint8_t>(TraceEvent::DISPATCH)) dispatches++;
+    }
+    TraceSnapshot end = replay.snapshotAt(replay.endTime());
+    ASSERT_TRUE(dispatches == scheduler.getContextSwitches(), "The trace should hold one DISPATCH per context switch.");
+    ASSERT_TRUE(end.terminated.size() == pcbs.size() && end.ready.empty() && end.waiting.empty(),
+                "Replaying the whole trace should end with every process terminated.");
+    std::remove(paths[0].c_str());
+    std::remove(paths[1].c_str());
+}
+
+void testWorkloadGenerators() {
+    std::cout << "\n--- Testing Synthetic Workload Generators ---\n";
+    std::vector<ProcessControlBlock> a = generateWorkload(WorkloadKind::IO_HEAVY, 500, 7);
+    std::vector<ProcessControlBlock> b = generateWorkload(WorkloadKind::IO_HEAVY, 500, 7);
+    std::vector<ProcessControlBlock> c = generateWorkload(WorkloadKind::IO_HEAVY, 500, 8);
+    bool same = true, differs = false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        same = same && a[i].total_burst_time == b[i].total_burst_time && a[i].io_burst_time == b[i].io_burst_time &&
+               a[i].io_burst_frequency == b[i].io_burst_frequency && a[i].priority == b[i].priority;
+        differs = differs || a[i].total_burst_time != c[i].total_burst_time;
+    }
+    ASSERT_TRUE(a.size() == 500 && same && differs, "A seed should always generate the same workload.");
+
+    int interactive = 0;
+    bool in_range = true;
+    for (const auto& pcb : generateWorkload(WorkloadKind::BIMODAL, 1000, 7)) {
+        if (pcb.total_burst_time <= 10) interactive++;
+        else in_range = in_range && pcb.total_burst_time >= 100 && pcb.total_burst_time <= 400;
+    }
+    ASSERT_TRUE(in_range && interactive > 700 && interactive < 900, "Bimodal bursts should be ~80% short, ~20% long.");
+}
+
+void testLatencyHistogram() {
+    std::cout << "\n--- Testing Latency Histograms ---\n";
+    LatencyHistogram h;
+    for (int v = 1; v <= 1000; ++v) h.record(v);
+    ASSERT_TRUE(h.count() == 1000 && h.min() == 1 && h.max() == 1000 && h.mean() == 500.5,
+                "Histogram should keep exact count, min, max and mean.");
+    long long p50 = h.percentile(50), p99 = h.percentile(99);
+    ASSERT_TRUE(p50 >= 500 && p50 <= 500 * 1.04 && p99 >= 990 && p99 <= 1000 && h.percentile(100) == 1000,
+                "Percentiles should be within the bucket precision of the true value.");
+    h.clear();
+    h.record(7);
+    ASSERT_TRUE(h.percentile(50) == 7 && h.percentile(0) == 7, "Small values should be recorded exactly.");
+
+    // Latency accounting: two CPU-bound processes under RR with quantum 2.
+    Scheduler scheduler(SchedulingPolicy::ROUND_ROBIN, 2);
+    std::unique_ptr<ReadyQueue> ready_queue = scheduler.makeReadyQueue();
+    TimerWheel waiting_queue;
+    ProcessControlBlock p1(1, 4, 0), p2(2, 3, 0);
+    ready_queue->push(&p1);
+    ready_queue->push(&p2);
+    int system_time = 0;
+    scheduler.run(*ready_queue, waiting_queue, system_time);
+    // P1 runs 0-2, P2 2-4, P1 4-6 (done), P2 6-7 (done).
+    const SchedulerStats& stats = scheduler.getStats();
+    ASSERT_TRUE(stats.completed == 2 && stats.response.max() == 2 && stats.response.min() == 0,
+                "Response time should be measured to the first dispatch.");
+    ASSERT_TRUE(p1.total_wait_time == 2 && p2.total_wait_time == 4 && stats.waiting.sum() == 6 &&
+                stats.turnaround.sum() == 6 + 7, "Waiting and turnaround time should be accumulated per process.");
+}
+
+void testPcbStore() {
+    std::cout << "\n--- Testing Slab PCB Store ---\n";
+    PcbStore store(4);
+    std::vector<ProcessControlBlock*> first;
+    for (int pid = 1; pid <= 10; ++pid) first.push_back(&store.create(pid, pid, 0));
+    bool stable = true;
+    for (int pid = 11; pid <= 40; ++pid) store.create(pid, pid, 0);
+    for (int pid = 1; pid <= 10; ++pid) stable = stable && store.find(pid) == first[pid - 1];
+    ASSERT_TRUE(stable && store.size() == 40, "PCB addresses should stay fixed as the store grows.");
+
+    size_t capacity = store.capacity();
+    for (int round = 0; round < 1000; ++round) {
+        int oldest = round + 1;
+        store.release(oldest);
+        store.create(oldest + 40, 1, 0);
+    }
+    ASSERT_TRUE(store.capacity() == capacity && store.size() == 40,
+                "Released slots should be reused instead of allocating more.");
+    ASSERT_TRUE(store.find(1000) == nullptr && store.find(1001)->process_id == 1001 &&
+                store.find(1040) != nullptr && !store.release(5), "Lookups should only find live pids.");
+    int expected = 1001;
+    bool in_order = true;
+    store.forEach([&](const ProcessControlBlock& pcb) { in_order = in_order && pcb.process_id == expected++; });
+    ASSERT_TRUE(in_order && expected == 1041, "Iteration should visit live PCBs in pid order.");
+
+    // One PCB that is never reaped must not pin the index to every later pid.
+    PcbStore pinned(16);
+    pinned.create(1, 1, 0);
+    for (int pid = 2; pid <= 100000; ++pid) {
+        pinned.create(pid, 1, 0);
+        if (pid > 10) pinned.release(pid - 8);
+    }
+    std::vector<int> visited;
+    pinned.forEach([&](const ProcessControlBlock& pcb) { visited.push_back(pcb.process_id); });
+    ASSERT_TRUE(pinned.indexSpan() < 256 && pinned.size() == 10 && pinned.find(1) != nullptr &&
+                pinned.find(99999) != nullptr && pinned.find(50000) == nullptr && visited.size() == 10 &&
+                visited.front() == 1 && std::is_sorted(visited.begin(), visited.end()),
+                "A long-lived old PCB should not keep the pid index growing.");
+    ASSERT_TRUE(pinned.release(1) && pinned.find(1) == nullptr && pinned.size() == 9,
+                "An old PCB should still be released normally.");
+    pinned.create(0, 1, 0);
+    ASSERT_TRUE(pinned.find(0) != nullptr && pinned.find(100000) != nullptr,
+                "An older pid should still be accepted.");
+}
+
+// Pages fault the first time each process touches them; locks are always free.
+class FirstTouchHost : public ProgramHost {
+public:
+    int touch(ProcessControlBlock* pcb, int vpn, AccessType) override {
+        return resident.insert({pcb->process_id, vpn}).second ? 3 : 0;
+    }
+    bool lock(ProcessControlBlock*, int) override { return true; }
+    void unlock(ProcessControlBlock*, int) override {}
+
+private:
+    std::set<std::pair<int, int>> resident;
+};
+
+void testProcessPrograms() {
+    std::cout << "\n--- Testing Process Programs ---\n";
+    Program program;
+    std::string error;
+    ASSERT_TRUE(!parseProgram("bad", "compute 2; jump 3", program, &error) && !parseProgram("bad", "repeat 2; compute 1", program) &&
+                !parseProgram("bad", "touch 4; sleep 2", program), "Malformed programs should be rejected.");
+    ASSERT_TRUE(parseProgram("p", "compute 2; touch 7 WRITE; lock m\nrepeat 3; compute 1; touch 8; end; unlock m; sleep 2", program) &&
+                program.code.size() == 9 && program.cpu_time == 5 && program.mutex_names.size() == 1,
+                "Programs should compile to bytecode with their total CPU time.");
+
+    int completion[2][3];
+    long long instructions[2];
+    for (int m = 0; m < 2; ++m) {
+        Scheduler scheduler(SchedulingPolicy::ROUND_ROBIN, 2);
+        scheduler.setExecutionMode(m == 0 ? ExecutionMode::TICK : ExecutionMode::EVENT);
+        FirstTouchHost host;
+        scheduler.setProgramHost(&host);
+        std::unique_ptr<ReadyQueue> ready_queue = scheduler.makeReadyQueue();
+        TimerWheel waiting_queue;
+        std::vector<ProcessControlBlock> pcbs;
+        for (int i = 0; i < 3; ++i) pcbs.emplace_back(i + 1, static_cast<int>(program.cpu_time), 0);
+        for (auto& pcb : pcbs) {
+            pcb.program.code = &program;
+            ready_queue->push(&pcb);
+        }
+        int system_time = 0;
+        scheduler.run(*ready_queue, waiting_queue, system_time, 7);
+        scheduler.run(*ready_queue, waiting_queue, system_time);
+        for (int i = 0; i < 3; ++i) completion[m][i] = pcbs[i].completion_time;
+        instructions[m] = scheduler.getStats().instructions;
+    }
+    ASSERT_TRUE(std::equal(completion[0], completion[0] + 3, completion[1]) && instructions[0] == instructions[1],
+                "Event mode should reproduce tick mode for programs.");
+    // 3 processes x (compute, touch, lock, repeat, 3 x (compute, touch, end), unlock, sleep)
+    ASSERT_TRUE(instructions[0] == 3 * 15, "Every instruction should execute once per loop iteration.");
+    // P1 needs its 5 CPU ticks, two 3-tick page faults and the final sleep.
+    ASSERT_TRUE(completion[0][0] >= 5 + 3 + 3 + 2, "Page faults and sleeps should take the process off the CPU.");
+}
+
+// Suspends P1 after its first page fault; resumes only when allowed to.
+class SuspendFirstController : public LoadController {
+public:
+    explicit SuspendFirstController(bool allow_resume) : allow_resume(allow_resume) {}
+    bool shouldSuspend(ProcessControlBlock* pcb) override { return pcb->process_id == 1 && suspensions++ == 0; }
+    bool shouldResume() override { return allow_resume; }
+
+private:
+    bool allow_resume;
+    int suspensions = 0;
+};
+
+void testLoadControl() {
+    std::cout << "\n--- Testing Load Control ---\n";
+    Program program;
+    parseProgram("p", "touch 1; compute 4", program);
+    const std::string path = "/tmp/mosks_trace_suspend.bin";
+    for (int allow_resume = 0; allow_resume < 2; ++allow_resume) {
+        Scheduler scheduler(SchedulingPolicy::ROUND_ROBIN, 2);
+        FirstTouchHost host;
+        SuspendFirstController controller(allow_resume == 1);
+        scheduler.setProgramHost(&host);
+        scheduler.setLoadController(&controller);
+        TraceRecorder recorder(path, 64, false);
+        scheduler.setTraceRecorder(&recorder);
+        std::unique_ptr<ReadyQueue> ready_queue = scheduler.makeReadyQueue();
+        TimerWheel waiting_queue;
+        std::vector<ProcessControlBlock> pcbs;
+        for (int i = 0; i < 2; ++i) pcbs.emplace_back(i + 1, static_cast<int>(program.cpu_time), 0);
+        for (auto& pcb : pcbs) {
+            pcb.program.code = &program;
+            ready_queue->push(&pcb);
+        }
+        int system_time = 0;
+        scheduler.run(*ready_queue, waiting_queue, system_time, 4);
+        if (allow_resume == 0) {
+            ASSERT_TRUE(pcbs[0].state == ProcessState::SUSPENDED && scheduler.suspendedCount() == 1 &&
+                        scheduler.getStats().suspensions == 1,
+                        "A process should be suspended when its page fault has been serviced.");
+        }
+        scheduler.run(*ready_queue, waiting_queue, system_time);
+        scheduler.setTraceRecorder(nullptr);
+        recorder.close();
+
+        TraceReplay replay;
+        ASSERT_TRUE(replay.load(path), "The load control trace should load.");
+        int suspended_at = -1, resumed_at = -1, other_done_at = -1;
+        for (const TraceRecord& rec : replay.records()) {
+            TraceEvent event = static_cast<TraceEvent>(rec.event);
+            if (event == TraceEvent::SUSPEND && rec.pid == 1) suspended_at = rec.time;
+            if (event == TraceEvent::RESUME && rec.pid == 1) resumed_at = rec.time;
+            if (event == TraceEvent::TERMINATE && rec.pid == 2) other_done_at = rec.time;
+        }
+        TraceSnapshot at_suspend = replay.snapshotAt(suspended_at);
+        TraceSnapshot end = replay.snapshotAt(replay.endTime());
+        ASSERT_TRUE(suspended_at >= 0 && end.terminated.size() == 2 && end.suspended.empty() &&
+                    scheduler.suspendedCount() == 0 && pcbs[0].state == ProcessState::TERMINATED,
+                    "A suspended process should come back and finish.");
+        if (allow_resume == 0) {
+            ASSERT_TRUE(at_suspend.suspended == std::vector<int>{1} && resumed_at >= other_done_at &&
+                        pcbs[0].completion_time > pcbs[1].completion_time,
+                        "Without the controller's consent a process should resume only once nothing else can run.");
+        } else {
+            ASSERT_TRUE(resumed_at == suspended_at && at_suspend.suspended.empty() &&
+                        at_suspend.ready[-1] == std::vector<int>{1},
+                        "Replay should put a resumed process back on the shared ready queue.");
+        }
+    }
+    std::remove(path.c_str());
 }
 
 // --- Test Runner Main Function ---
 int main() {
     std::cout << "===== Running Unified Scheduler Tests =====\n";
-    
+
     std::cout << "\n=============================================\n";
     std::cout << "  Testing Policy: Round Robin with I/O\n";
     std::cout << "=============================================\n";
@@ -42,6 +522,34 @@ int main() {
     std::cout << "=============================================\n";
     runSchedulerTest(SchedulingPolicy::SJF);
 
+    std::cout << "\n=============================================\n";
+    std::cout << "  Testing Policy: CFS with I/O\n";
+    std::cout << "=============================================\n";
+    runSchedulerTest(SchedulingPolicy::CFS);
+
+    std::cout << "\n--- Testing Event-Driven Execution Mode ---\n";
+    testEventModeMatchesTickMode(SchedulingPolicy::ROUND_ROBIN);
+    testEventModeMatchesTickMode(SchedulingPolicy::PRIORITY);
+    testEventModeMatchesTickMode(SchedulingPolicy::SJF);
+    testEventModeMatchesTickMode(SchedulingPolicy::CFS);
+
+    testEventModeMatchesTickMode(SchedulingPolicy::ROUND_ROBIN, 3);
+    testEventModeMatchesTickMode(SchedulingPolicy::SJF, 3);
+    testEventModeMatchesTickMode(SchedulingPolicy::CFS, 3);
+
+    testSmpScheduling();
+    testTimerWheel();
+    testHeapReadyQueueOrdering();
+    testFifoReadyQueueRemoval();
+    testCfsFairness();
+    testLogSinks();
+    testTraceReplay();
+    testWorkloadGenerators();
+    testLatencyHistogram();
+    testPcbStore();
+    testProcessPrograms();
+    testLoadControl();
+
     std::cout << "\n===== All Scheduler Tests Completed =====\n";
     return 0;
-}
\ No newline at end of file
+}
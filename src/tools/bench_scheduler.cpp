@@ -0,0 +1,170 @@
+#include "scheduler/scheduler.hpp"
+#include "scheduler/workload.hpp"
+#include "tools/cli_args.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+static void usage() {
+    std::cout << "Usage: bench_scheduler [options]\n"
+              << "  --workload <list>   Workload generators (cpu,io,bimodal; default all).\n"
+              << "  --sizes <list>      Process counts (default 1000,10000,100000,1000000).\n"
+              << "  --policy <list>     Scheduling policies (RR,PRIORITY,SJF,CFS; default all).\n"
+              << "  --cpus <list>       Simulated CPU counts (default 1).\n"
+              << "  --quantum <n>       Round Robin time quantum (default 4).\n"
+              << "  --mode <tick|event> Scheduler execution mode (default event).\n"
+              << "  --seed <n>          Workload seed (default 42).\n"
+              << "  --repeat <n>        Runs per configuration; the fastest is reported (default 1).\n"
+              << "  --out <path>        Write the CSV to a file instead of stdout.\n"
+              << "Lists are comma separated, e.g. --sizes 1000,1000000\n";
+}
+
+struct BenchResult {
+    int sim_ticks = 0;
+    long long dispatches = 0;
+    double host_seconds = 0.0;
+    double avg_turnaround = 0.0;
+    double avg_waiting = 0.0;
+    long long p99_response = 0;
+    long long p99_turnaround = 0;
+    double max_lag = 0.0;
+};
+
+// Runs one copy of `workload` to completion. Only Scheduler::run is timed.
+static BenchResult runOnce(const std::vector<ProcessControlBlock>& workload, SchedulingPolicy policy,
+                           int quantum, int cpus, ExecutionMode mode) {
+    std::ostream discard(nullptr);
+    Scheduler scheduler(policy, quantum, discard);
+    scheduler.setLogSink(&nullSink());
+    scheduler.setExecutionMode(mode);
+    std::unique_ptr<ReadyQueue> ready_queue = scheduler.makeReadyQueue();
+    scheduler.setCpuCount(cpus, DEFAULT_BALANCE_INTERVAL, *ready_queue);
+    TimerWheel waiting_queue;
+
+    std::vector<ProcessControlBlock> pcbs = workload;
+    for (auto& pcb : pcbs) {
+        pcb.state = ProcessState::READY;
+        ready_queue->push(&pcb);
+    }
+
+    int system_time = 0;
+    auto start = std::chrono::steady_clock::now();
+    scheduler.run(*ready_queue, waiting_queue, system_time);
+    BenchResult result;
+    result.host_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    result.sim_ticks = system_time;
+    result.dispatches = scheduler.getContextSwitches();
+    // The same running totals as System::getReport, so the CSV compares with sweep:
+    // waiting is time spent READY.
+    const SchedulerStats& stats = scheduler.getStats();
+    result.p99_response = stats.response.percentile(99);
+    result.p99_turnaround = stats.turnaround.percentile(99);
+    result.avg_turnaround = stats.turnaround.mean();
+    result.avg_waiting = stats.waiting.mean();
+    for (const auto& pcb : pcbs) result.max_lag = std::max(result.max_lag, pcb.max_lag);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    std::vector<WorkloadKind> kinds = {WorkloadKind::CPU_BOUND, WorkloadKind::IO_HEAVY, WorkloadKind::BIMODAL};
+    std::vector<int> sizes = {1000, 10000, 100000, 1000000};
+    std::vector<SchedulingPolicy> policies = {SchedulingPolicy::ROUND_ROBIN, SchedulingPolicy::PRIORITY,
+                                              SchedulingPolicy::SJF, SchedulingPolicy::CFS};
+    std::vector<int> cpu_counts = {1};
+    int quantum = 4, repeat = 1;
+    unsigned long long seed = 42;
+    ExecutionMode mode = ExecutionMode::EVENT;
+    std::string out_path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (flag == "--workload") {
+            kinds.clear();
+            for (const auto& name : splitList(value)) {
+                WorkloadKind kind;
+                if (!parseWorkloadKind(name, kind)) {
+                    std::cerr << "Unknown workload: " << name << "\n";
+                    return 1;
+                }
+                kinds.push_back(kind);
+            }
+        } else if (flag == "--sizes") {
+            if (!parseIntList(flag, value, sizes)) return 1;
+        } else if (flag == "--policy") {
+            policies.clear();
+            for (const auto& name : splitList(value)) {
+                SchedulingPolicy policy;
+                if (!parseSchedulingPolicy(name, policy)) {
+                    std::cerr << "Unknown scheduling policy: " << name << "\n";
+                    return 1;
+                }
+                policies.push_back(policy);
+            }
+        } else if (flag == "--cpus") {
+            if (!parseIntList(flag, value, cpu_counts)) return 1;
+        } else if (flag == "--quantum") {
+            if (!parseInt(flag, value, quantum)) return 1;
+        } else if (flag == "--mode") {
+            if (!parseExecutionMode(value, mode)) {
+                std::cerr << "Unknown execution mode: " << value << "\n";
+                return 1;
+            }
+        } else if (flag == "--seed") {
+            seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (flag == "--repeat") {
+            if (!parseInt(flag, value, repeat)) return 1;
+        } else if (flag == "--out") {
+            out_path = value;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::ofstream file;
+    if (!out_path.empty()) {
+        file.open(out_path);
+        if (!file) {
+            std::cerr << "Cannot open output file: " << out_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream& csv = out_path.empty() ? std::cout : file;
+
+    csv << "workload,processes,policy,cpus,mode,seed,sim_ticks,dispatches,host_ms,"
+        << "ticks_per_sec,dispatches_per_sec,avg_turnaround,avg_waiting,p99_response,p99_turnaround,max_lag\n";
+    for (WorkloadKind kind : kinds) {
+        for (int size : sizes) {
+            std::vector<ProcessControlBlock> workload = generateWorkload(kind, size, seed);
+            for (SchedulingPolicy policy : policies) {
+                for (int cpus : cpu_counts) {
+                    BenchResult best;
+                    for (int r = 0; r < repeat; ++r) {
+                        BenchResult result = runOnce(workload, policy, quantum, cpus, mode);
+                        if (r == 0 || result.host_seconds < best.host_seconds) best = result;
+                    }
+                    double seconds = std::max(best.host_seconds, 1e-9);
+                    csv << workloadKindToString(kind) << "," << size << ","
+                        << schedulingPolicyToString(policy) << "," << cpus << ","
+                        << (mode == ExecutionMode::TICK ? "tick" : "event") << "," << seed << ","
+                        << best.sim_ticks << "," << best.dispatches << ","
+                        << best.host_seconds * 1000.0 << ","
+                        << static_cast<long long>(best.sim_ticks / seconds) << ","
+                        << static_cast<long long>(best.dispatches / seconds) << ","
+                        << best.avg_turnaround << "," << best.avg_waiting << ","
+                        << best.p99_response << "," << best.p99_turnaround << "," << best.max_lag << "\n";
+                    csv.flush();
+                }
+            }
+        }
+    }
+    return 0;
+}
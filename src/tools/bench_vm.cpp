@@ -0,0 +1,180 @@
+#include "memory/virtual_memory/virtual_memory.hpp"
+#include "scheduler/workload.hpp"
+#include "tools/cli_args.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+static void usage() {
+    std::cout << "Usage: bench_vm [options]\n"
+              << "  --pattern <list>    Access patterns (hotcold,loop,uniform; default all).\n"
+              << "  --frames <list>     Physical frame counts (default 1024,65536,262144).\n"
+              << "  --policy <list>     Replacement policies (FIFO,LRU,CLOCK,OPT,ARC,2Q; default FIFO,LRU,CLOCK).\n"
+              << "  --accesses <n>      Memory accesses per run (default 2000000).\n"
+              << "  --processes <n>     Processes sharing the memory (default 4).\n"
+              << "  --seed <n>          Access stream seed (default 42).\n"
+              << "  --repeat <n>        Runs per configuration; the fastest is reported (default 1).\n"
+              << "  --readahead <n>     Largest readahead window in pages (default 0: off).\n"
+              << "  --out <path>        Write the CSV to a file instead of stdout.\n"
+              << "Lists are comma separated, e.g. --frames 4096,65536\n";
+}
+
+struct Access {
+    int process;
+    int vpn;
+    AccessType type;
+};
+
+// hotcold: 80% of accesses go to a hot set of half the frames, the rest anywhere
+//          in four times the frames.
+// loop:    sequential sweeps over 25% more pages than there are frames.
+// uniform: uniform over twice the frames.
+static std::vector<Access> generateAccesses(const std::string& pattern, int frames, int processes,
+                                            int count, uint64_t seed) {
+    WorkloadRng rng(seed);
+    std::vector<Access> accesses(count);
+    int span = pattern == "loop" ? frames + frames / 4 : (pattern == "uniform" ? 2 * frames : 4 * frames);
+    int per_process = std::max(1, span / processes);
+    int hot = std::max(1, frames / 2);
+    for (int i = 0; i < count; ++i) {
+        int page;
+        if (pattern == "loop") page = i % span;
+        else if (pattern == "hotcold" && rng.range(0, 99) < 80) page = rng.range(0, hot - 1);
+        else page = rng.range(0, span - 1);
+        accesses[i].process = (page / per_process) % processes;
+        accesses[i].vpn = page % per_process;
+        accesses[i].type = rng.range(0, 3) == 0 ? AccessType::WRITE : AccessType::READ;
+    }
+    return accesses;
+}
+
+struct BenchResult {
+    int faults = 0;
+    long long prefetched = 0;
+    long long prefetch_wasted = 0;
+    double host_seconds = 0.0;
+};
+
+// Replays `accesses` on a fresh VirtualMemoryManager. Only the accesses are timed;
+// OPT's next-use index is built beforehand.
+static BenchResult runOnce(const std::vector<Access>& accesses, int frames, int processes, ReplacementPolicy policy,
+                           int readahead) {
+    std::ostream discard(nullptr);
+    VirtualMemoryManager vmm(frames, 1, policy, discard);
+    vmm.setLogSink(&nullSink());
+    ReadaheadConfig readahead_config;
+    readahead_config.max_window = readahead;
+    vmm.configureReadahead(readahead_config);
+    std::vector<ProcessControlBlock> pcbs;
+    for (int p = 0; p < processes; ++p) pcbs.emplace_back(p + 1, 1, 0);
+    for (auto& pcb : pcbs) vmm.allocateProcess(pcb);
+    if (policy == ReplacementPolicy::OPT) {
+        std::vector<MemoryAccess> future(accesses.size());
+        for (size_t i = 0; i < accesses.size(); ++i) {
+            future[i].pid = accesses[i].process + 1;
+            future[i].vpn = accesses[i].vpn;
+        }
+        vmm.setFutureAccesses(future);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (const Access& access : accesses) vmm.accessPage(pcbs[access.process], access.vpn, access.type);
+    BenchResult result;
+    result.host_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.faults = vmm.getPageFaults();
+    result.prefetched = vmm.getPrefetched();
+    result.prefetch_wasted = vmm.getPrefetchWasted();
+    for (auto& pcb : pcbs) vmm.freeProcess(pcb);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> patterns = {"hotcold", "loop", "uniform"};
+    std::vector<int> frame_counts = {1024, 65536, 262144};
+    std::vector<ReplacementPolicy> policies = {ReplacementPolicy::FIFO, ReplacementPolicy::LRU,
+                                               ReplacementPolicy::CLOCK};
+    int count = 2000000, processes = 4, repeat = 1, readahead = 0;
+    unsigned long long seed = 42;
+    std::string out_path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (flag == "--pattern") {
+            patterns.clear();
+            for (const auto& name : splitList(value)) {
+                if (name != "hotcold" && name != "loop" && name != "uniform") {
+                    std::cerr << "Unknown access pattern: " << name << "\n";
+                    return 1;
+                }
+                patterns.push_back(name);
+            }
+        } else if (flag == "--frames") {
+            if (!parseIntList(flag, value, frame_counts, 1, MAX_FRAME_NUMBER + 1)) return 1;
+        } else if (flag == "--policy") {
+            policies.clear();
+            for (const auto& name : splitList(value)) {
+                ReplacementPolicy policy;
+                if (!parseReplacementPolicy(name, policy)) {
+                    std::cerr << "Unknown replacement policy: " << name << "\n";
+                    return 1;
+                }
+                policies.push_back(policy);
+            }
+        } else if (flag == "--accesses") {
+            if (!parseInt(flag, value, count)) return 1;
+        } else if (flag == "--processes") {
+            if (!parseInt(flag, value, processes)) return 1;
+        } else if (flag == "--seed") {
+            seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (flag == "--repeat") {
+            if (!parseInt(flag, value, repeat)) return 1;
+        } else if (flag == "--readahead") {
+            if (!parseInt(flag, value, readahead, 0)) return 1;
+        } else if (flag == "--out") {
+            out_path = value;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::ofstream file;
+    if (!out_path.empty()) {
+        file.open(out_path);
+        if (!file) {
+            std::cerr << "Cannot open output file: " << out_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream& csv = out_path.empty() ? std::cout : file;
+
+    csv << "pattern,frames,policy,processes,accesses,seed,faults,prefetched,prefetch_wasted,host_ms,accesses_per_sec,faults_per_sec\n";
+    for (const std::string& pattern : patterns) {
+        for (int frames : frame_counts) {
+            std::vector<Access> accesses = generateAccesses(pattern, frames, processes, count, seed);
+            for (ReplacementPolicy policy : policies) {
+                BenchResult best;
+                for (int r = 0; r < repeat; ++r) {
+                    BenchResult result = runOnce(accesses, frames, processes, policy, readahead);
+                    if (r == 0 || result.host_seconds < best.host_seconds) best = result;
+                }
+                double seconds = std::max(best.host_seconds, 1e-9);
+                csv << pattern << "," << frames << "," << replacementPolicyToString(policy) << ","
+                    << processes << "," << count << "," << seed << "," << best.faults << ","
+                    << best.prefetched << "," << best.prefetch_wasted << ","
+                    << best.host_seconds * 1000.0 << ","
+                    << static_cast<long long>(count / seconds) << ","
+                    << static_cast<long long>(best.faults / seconds) << "\n";
+                csv.flush();
+            }
+        }
+    }
+    return 0;
+}
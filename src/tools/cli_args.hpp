@@ -0,0 +1,57 @@
+#ifndef CLI_ARGS_HPP
+#define CLI_ARGS_HPP
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Option parsing shared by the command-line tools. The number parsers report
+// an invalid value on stderr, naming the option, and return false, so a tool
+// only has to exit.
+
+inline std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::istringstream iss(list);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// A whole number in [min, max].
+inline bool parseInt(const std::string& flag, const std::string& text, int& value, int min = 1, int max = INT_MAX) {
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || errno == ERANGE || parsed < min || parsed > max) {
+        std::cerr << "Invalid value for " << flag << ": " << text << " (expected a whole number from " << min
+                  << (max == INT_MAX ? std::string(" up") : " to " + std::to_string(max)) << ")\n";
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+// A non-empty comma separated list of whole numbers in [min, max].
+inline bool parseIntList(const std::string& flag, const std::string& list, std::vector<int>& values, int min = 1,
+                         int max = INT_MAX) {
+    std::vector<int> parsed;
+    for (const auto& item : splitList(list)) {
+        int value = 0;
+        if (!parseInt(flag, item, value, min, max)) return false;
+        parsed.push_back(value);
+    }
+    if (parsed.empty()) {
+        std::cerr << "Empty list for " << flag << "\n";
+        return false;
+    }
+    values = parsed;
+    return true;
+}
+
+#endif
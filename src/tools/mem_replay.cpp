@@ -0,0 +1,195 @@
+#include "memory/virtual_memory/virtual_memory.hpp"
+#include "memory/virtual_memory/memory_trace.hpp"
+#include "memory/virtual_memory/stack_distance.hpp"
+#include "core/mapped_file.hpp"
+#include "tools/cli_args.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+static void usage() {
+    std::cout << "Usage: mem_replay <trace> [options]\n"
+              << "       mem_replay <text trace> --compile <binary trace> [--page-size <bytes>]\n"
+              << "  --frames <list>     Physical frame counts to simulate (default 64,256,1024,4096).\n"
+              << "  --policy <list>     Replacement policies (FIFO,LRU,CLOCK,OPT,ARC,2Q or all; default LRU).\n"
+              << "                      OPT keeps the whole trace in memory to index next uses.\n"
+              << "  --page-size <bytes> Page size used to split text trace addresses (default 4096).\n"
+              << "  --sample <rate>     Fraction of pages tracked by the stack distance pass (default 1).\n"
+              << "  --mrc <path>        Write the LRU miss-ratio curve as CSV.\n"
+              << "  --mrc-points <n>    Log-spaced frame counts in the curve (default 64).\n"
+              << "Lists are comma separated, e.g. --frames 128,4096\n";
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::max(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 1e-9);
+}
+
+struct ReplayResult {
+    long long accesses = 0;
+    int faults = 0;
+    double host_seconds = 0.0;
+};
+
+// Replays the whole trace on a fresh VirtualMemoryManager, with one PCB per pid.
+// `future` is the same trace, loaded for OPT's next-use index.
+static bool replay(const MappedFile& trace, int page_size, int frames, ReplacementPolicy policy,
+                   const std::vector<MemoryAccess>& future, ReplayResult& result, std::string& error) {
+    std::ostream discard(nullptr);
+    VirtualMemoryManager vmm(frames, 1, policy, discard);
+    vmm.setLogSink(&nullSink());
+    if (policy == ReplacementPolicy::OPT) vmm.setFutureAccesses(future);
+    std::vector<std::unique_ptr<ProcessControlBlock>> pcbs;
+
+    MemoryTraceReader reader(trace.data(), trace.size(), page_size);
+    MemoryAccess access;
+    result = ReplayResult();
+    auto start = std::chrono::steady_clock::now();
+    while (reader.next(access)) {
+        if (access.pid >= static_cast<int>(pcbs.size())) pcbs.resize(access.pid + 1);
+        std::unique_ptr<ProcessControlBlock>& pcb = pcbs[access.pid];
+        if (!pcb) {
+            pcb.reset(new ProcessControlBlock(access.pid, 1, 0));
+            vmm.allocateProcess(*pcb);
+        }
+        vmm.accessPage(*pcb, access.vpn, access.type);
+        result.accesses++;
+    }
+    result.host_seconds = secondsSince(start);
+    result.faults = vmm.getPageFaults();
+    error = reader.error();
+    return error.empty();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argv[1][0] == '-') {
+        usage();
+        return 1;
+    }
+    std::string trace_path = argv[1], compile_path, mrc_path;
+    std::vector<int> frame_counts = {64, 256, 1024, 4096};
+    std::vector<ReplacementPolicy> policies = {ReplacementPolicy::LRU};
+    int page_size = 4096, mrc_points = 64;
+    double sample_rate = 1.0;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (flag == "--frames") {
+            if (!parseIntList(flag, value, frame_counts, 1, MAX_FRAME_NUMBER + 1)) return 1;
+        } else if (flag == "--policy") {
+            policies.clear();
+            if (value == "all") {
+                policies = {ReplacementPolicy::FIFO, ReplacementPolicy::LRU, ReplacementPolicy::CLOCK,
+                            ReplacementPolicy::OPT, ReplacementPolicy::ARC, ReplacementPolicy::TWO_Q};
+                continue;
+            }
+            for (const auto& name : splitList(value)) {
+                ReplacementPolicy policy;
+                if (!parseReplacementPolicy(name, policy)) {
+                    std::cerr << "Unknown replacement policy: " << name << "\n";
+                    return 1;
+                }
+                policies.push_back(policy);
+            }
+        } else if (flag == "--page-size") {
+            if (!parseInt(flag, value, page_size)) return 1;
+        } else if (flag == "--sample") {
+            sample_rate = std::atof(value.c_str());
+        } else if (flag == "--mrc") {
+            mrc_path = value;
+        } else if (flag == "--mrc-points") {
+            if (!parseInt(flag, value, mrc_points, 2)) return 1;
+        } else if (flag == "--compile") {
+            compile_path = value;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::string error;
+    if (!compile_path.empty()) {
+        if (!compileMemoryTrace(trace_path, compile_path, page_size, &error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    MappedFile trace;
+    if (!trace.open(trace_path, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    // Stack distance pass: the LRU fault count of every memory size at once.
+    // OPT also needs the accesses themselves, collected on the way.
+    bool keep = std::find(policies.begin(), policies.end(), ReplacementPolicy::OPT) != policies.end();
+    std::vector<MemoryAccess> future;
+    StackDistanceAnalyzer analyzer(sample_rate);
+    MemoryTraceReader reader(trace.data(), trace.size(), page_size);
+    MemoryAccess access;
+    auto start = std::chrono::steady_clock::now();
+    while (reader.next(access)) {
+        analyzer.access(access.pid, access.vpn);
+        if (keep) future.push_back(access);
+    }
+    double analysis_seconds = secondsSince(start);
+    if (!reader.error().empty()) {
+        std::cerr << trace_path << ": " << reader.error() << "\n";
+        return 1;
+    }
+    MissRatioCurve curve = analyzer.curve();
+    std::cout << "# " << trace_path << ": " << (reader.isBinary() ? "binary" : "text") << ", "
+              << curve.accesses() << " accesses; stack distance pass " << analysis_seconds * 1000.0 << " ms ("
+              << static_cast<long long>(curve.accesses() / analysis_seconds) << " accesses/s), "
+              << analyzer.pages() << " pages tracked at sample rate " << sample_rate << "\n";
+
+    // One row per memory size, the policies side by side.
+    std::cout << "frames,accesses,lru_curve_faults";
+    for (ReplacementPolicy policy : policies) {
+        std::string name = replacementPolicyToString(policy);
+        std::cout << "," << name << "_faults," << name << "_miss_ratio," << name << "_host_ms";
+    }
+    std::cout << "\n";
+    for (int frames : frame_counts) {
+        std::cout << frames << "," << curve.accesses() << "," << curve.misses(frames);
+        for (ReplacementPolicy policy : policies) {
+            ReplayResult result;
+            if (!replay(trace, page_size, frames, policy, future, result, error)) {
+                std::cerr << trace_path << ": " << error << "\n";
+                return 1;
+            }
+            std::cout << "," << result.faults << ","
+                      << (result.accesses > 0 ? static_cast<double>(result.faults) / result.accesses : 0.0) << ","
+                      << result.host_seconds * 1000.0;
+        }
+        std::cout << "\n";
+    }
+
+    if (!mrc_path.empty()) {
+        std::ofstream mrc(mrc_path);
+        if (!mrc) {
+            std::cerr << "Cannot open output file: " << mrc_path << "\n";
+            return 1;
+        }
+        mrc << "frames,misses,miss_ratio\n";
+        long long largest = std::max(1LL, curve.maxUsefulFrames());
+        long long previous = 0;
+        for (int k = 0; k < mrc_points; ++k) {
+            long long frames = std::llround(std::pow(static_cast<double>(largest), static_cast<double>(k) / (mrc_points - 1)));
+            if (frames <= previous) continue;
+            previous = frames;
+            mrc << frames << "," << curve.misses(frames) << "," << curve.missRatio(frames) << "\n";
+        }
+    }
+    return 0;
+}
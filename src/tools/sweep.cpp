@@ -0,0 +1,108 @@
+#include "cli/sweep.hpp"
+#include "tools/cli_args.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+static void usage() {
+    std::cout << "Usage: sweep <workload_file> [options]\n"
+              << "  --policy <list>       Scheduling policies (RR,PRIORITY,SJF,CFS).\n"
+              << "  --quantum <list>      Round Robin time quanta.\n"
+              << "  --frames <list>       Physical frame counts.\n"
+              << "  --replacement <list>  Page replacement policies (FIFO,LRU,CLOCK,ARC,2Q).\n"
+              << "  --cpus <list>         Simulated CPU counts.\n"
+              << "  --page-size <n>       Page size shared by every configuration (default 4).\n"
+              << "  --mode <tick|event>   Scheduler execution mode (default event).\n"
+              << "  --threads <n>         Worker threads (default: one per host core).\n"
+              << "Lists are comma separated, e.g. --quantum 2,4,8\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    SweepGrid grid;
+    unsigned threads = 0;
+    for (int i = 2; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (flag == "--policy") {
+            grid.policies.clear();
+            for (const auto& name : splitList(value)) {
+                SchedulingPolicy policy;
+                if (!parseSchedulingPolicy(name, policy)) {
+                    std::cerr << "Unknown scheduling policy: " << name << "\n";
+                    return 1;
+                }
+                grid.policies.push_back(policy);
+            }
+        } else if (flag == "--quantum") {
+            if (!parseIntList(flag, value, grid.quanta)) return 1;
+        } else if (flag == "--frames") {
+            if (!parseIntList(flag, value, grid.frame_counts, 1, MAX_FRAME_NUMBER + 1)) return 1;
+        } else if (flag == "--replacement") {
+            grid.replacements.clear();
+            for (const auto& name : splitList(value)) {
+                ReplacementPolicy policy;
+                if (!parseReplacementPolicy(name, policy)) {
+                    std::cerr << "Unknown replacement policy: " << name << "\n";
+                    return 1;
+                }
+                if (policy == ReplacementPolicy::OPT) {
+                    std::cerr << "OPT needs the whole access sequence in advance; use mem_replay or bench_vm\n";
+                    return 1;
+                }
+                grid.replacements.push_back(policy);
+            }
+        } else if (flag == "--cpus") {
+            if (!parseIntList(flag, value, grid.cpu_counts)) return 1;
+        } else if (flag == "--page-size") {
+            if (!parseInt(flag, value, grid.page_size)) return 1;
+        } else if (flag == "--mode") {
+            if (!parseExecutionMode(value, grid.mode)) {
+                std::cerr << "Unknown execution mode: " << value << "\n";
+                return 1;
+            }
+        } else if (flag == "--threads") {
+            int count = 0;
+            if (!parseInt(flag, value, count)) return 1;
+            threads = static_cast<unsigned>(count);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    for (int frames : grid.frame_counts) {
+        if (static_cast<long long>(frames) * grid.page_size > INT_MAX) {
+            std::cerr << frames << " frames of " << grid.page_size << " bytes exceed the simulated memory size limit\n";
+            return 1;
+        }
+    }
+
+    std::ifstream file(argv[1]);
+    if (!file) {
+        std::cerr << "Cannot open workload file: " << argv[1] << "\n";
+        return 1;
+    }
+    std::vector<std::string> workload;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line[0] != '#') workload.push_back(line);
+    }
+
+    std::vector<SystemConfig> configs = expandGrid(grid);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SweepResult> results = runSweep(workload, configs, threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printSweepTable(std::cout, results);
+    std::cout << "\n" << results.size() << " configurations in " << seconds << " s\n";
+    return 0;
+}
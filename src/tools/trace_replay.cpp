@@ -0,0 +1,126 @@
+#include "core/trace.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+static void usage() {
+    std::cout << "Usage: trace_replay <trace_file> [options]\n"
+              << "  --at <t>    Show the queue state at time t (default: end of trace).\n"
+              << "  --dump      Print every record.\n"
+              << "  --pid <n>   Only print records of process n (implies --dump).\n";
+}
+
+static const char* locationToString(TraceLocation location) {
+    switch (location) {
+        case TraceLocation::READY: return "READY";
+        case TraceLocation::RUNNING: return "RUNNING";
+        case TraceLocation::WAITING: return "WAITING";
+        case TraceLocation::BLOCKED: return "BLOCKED";
+        case TraceLocation::SUSPENDED: return "SUSPENDED";
+        case TraceLocation::TERMINATED: return "TERMINATED";
+    }
+    return "UNKNOWN";
+}
+
+static std::string queueName(int cpu) {
+    return cpu < 0 ? std::string("shared") : "CPU " + std::to_string(cpu);
+}
+
+static void printRecord(const TraceRecord& rec) {
+    std::cout << "Time " << rec.time << ": P" << rec.pid << " "
+              << traceEventToString(static_cast<TraceEvent>(rec.event))
+              << " cpu=" << rec.cpu << " arg=" << rec.arg << "\n";
+}
+
+static void printSummary(const TraceReplay& replay) {
+    unsigned long long counts[TRACE_EVENT_COUNT] = {};
+    for (const TraceRecord& rec : replay.records()) {
+        if (rec.event < TRACE_EVENT_COUNT) counts[rec.event]++;
+    }
+    std::cout << "--- Trace: " << replay.records().size() << " records, time "
+              << replay.startTime() << " to " << replay.endTime() << " ---\n";
+    for (int i = 0; i < TRACE_EVENT_COUNT; ++i) {
+        if (counts[i] == 0) continue;
+        std::cout << "  " << traceEventToString(static_cast<TraceEvent>(i)) << ": " << counts[i] << "\n";
+    }
+}
+
+static void printSnapshot(const TraceReplay& replay, int time) {
+    TraceSnapshot snap = replay.snapshotAt(time);
+    std::cout << "--- State at time " << snap.time << " ---\n";
+    for (const auto& entry : snap.running) {
+        std::cout << "CPU " << entry.first << " running: P" << entry.second << "\n";
+    }
+    for (const auto& queue : snap.ready) {
+        std::cout << "Ready (" << queueName(queue.first) << "): [ ";
+        for (int pid : queue.second) std::cout << "P" << pid << " ";
+        std::cout << "]\n";
+    }
+    std::cout << "Waiting: [ ";
+    for (const auto& entry : snap.waiting) std::cout << "P" << entry.first << "(wakes " << entry.second << ") ";
+    std::cout << "]\n";
+    std::cout << "Blocked: [ ";
+    for (int pid : snap.blocked) std::cout << "P" << pid << " ";
+    std::cout << "]\n";
+    std::cout << "Suspended: [ ";
+    for (int pid : snap.suspended) std::cout << "P" << pid << " ";
+    std::cout << "]\n";
+    std::cout << "Terminated: [ ";
+    for (int pid : snap.terminated) std::cout << "P" << pid << " ";
+    std::cout << "]\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    bool has_time = false, dump = false;
+    int at = 0, pid_filter = -1;
+    for (int i = 2; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--dump") {
+            dump = true;
+        } else if ((flag == "--at" || flag == "--pid") && i + 1 < argc) {
+            int value = std::atoi(argv[++i]);
+            if (flag == "--at") {
+                at = value;
+                has_time = true;
+            } else {
+                pid_filter = value;
+                dump = true;
+            }
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    TraceReplay replay;
+    std::string error;
+    if (!replay.load(argv[1], &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    if (!has_time) at = replay.endTime();
+
+    printSummary(replay);
+    if (dump) {
+        for (const TraceRecord& rec : replay.records()) {
+            if (pid_filter == -1 || rec.pid == pid_filter) printRecord(rec);
+        }
+    }
+    printSnapshot(replay, at);
+    if (pid_filter != -1) {
+        auto states = replay.statesAt(at);
+        auto it = states.find(pid_filter);
+        if (it == states.end()) {
+            std::cout << "P" << pid_filter << " does not exist at time " << at << ".\n";
+        } else {
+            std::cout << "P" << pid_filter << " is " << locationToString(it->second.location)
+                      << " (" << queueName(it->second.cpu) << ")\n";
+        }
+    }
+    return 0;
+}